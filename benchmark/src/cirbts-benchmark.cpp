@@ -0,0 +1,306 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+ * This file benchmarks circuit bootstrapping: key generation, every stage of the pipeline in
+ * isolation, the whole circuit bootstrap and the circuit computation gates for every parameter
+ * set, and the batched circuit bootstrap over the number of threads and the batch size
+ */
+
+#include "benchmark/benchmark.h"
+#include "cirbtscontext.h"
+#include "rlwe-ske.h"
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <vector>
+
+using namespace lbcrypto;
+
+/*
+ * Context setup utility methods
+ */
+
+CirBTSContext GenerateCirBTSContext(CirBTS_PARAMSET set) {
+    auto cc = CirBTSContext();
+    cc.GenerateCirBTSContext(set, set == STD128_CircuitBootstrap_AUTO ? LMKCDEY : GINX);
+    return cc;
+}
+
+struct CirBTSBenchmarkContext {
+    CirBTSContext cc;
+    LWEPrivateKey sk;
+    RLWEPrivateKey sk2;
+};
+
+// the keys take seconds to generate, so the benchmarks of a parameter set share one context
+CirBTSBenchmarkContext& GetCirBTSContext(CirBTS_PARAMSET set) {
+    static std::map<CirBTS_PARAMSET, std::unique_ptr<CirBTSBenchmarkContext>> contexts;
+    auto& ctx = contexts[set];
+    if (!ctx) {
+        ctx      = std::make_unique<CirBTSBenchmarkContext>();
+        ctx->cc  = GenerateCirBTSContext(set);
+        ctx->sk  = ctx->cc.KeyGen();
+        ctx->sk2 = ctx->cc.RLWEKeyGen();
+        ctx->cc.CirBTKeyGen(ctx->sk, ctx->sk2);
+    }
+    return *ctx;
+}
+
+// an RLWE encryption of a random binary polynomial under the level 2 secret key
+RLWECiphertext EncryptRLWE(CirBTSBenchmarkContext& ctx) {
+    auto& rlweParams = ctx.cc.GetParams()->GetRLWEParams();
+    auto polyParams  = rlweParams->GetPolyParams();
+    BinaryUniformGeneratorImpl<NativeVector> bug;
+    NativePoly m(bug, polyParams, COEFFICIENT);
+    return RLWEEncryptionScheme().Encrypt(rlweParams, ctx.sk2, m, 2, polyParams->GetModulus());
+}
+
+// the bits of the MV-FBS modulus switching
+uint32_t GetBitwidth(CirBTSContext& cc) {
+    return static_cast<uint32_t>(std::ceil(std::log2(cc.GetParams()->GetDigitsCC())));
+}
+
+/*
+ * Key generation
+ */
+
+template <class ParamSet>
+void CIRBTS_KEYGEN(benchmark::State& state, ParamSet param_set) {
+    CirBTS_PARAMSET param(param_set);
+    CirBTSContext cc = GenerateCirBTSContext(param);
+
+    LWEPrivateKey sk   = cc.KeyGen();
+    RLWEPrivateKey sk2 = cc.RLWEKeyGen();
+    for (auto _ : state) {
+        cc.CirBTKeyGen(sk, sk2);
+    }
+}
+
+BENCHMARK_CAPTURE(CIRBTS_KEYGEN, AUTO, STD128_CircuitBootstrap_AUTO)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(CIRBTS_KEYGEN, CMUX_1, STD128_CircuitBootstrap_CMUX_1)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(CIRBTS_KEYGEN, CMUX_2, STD128_CircuitBootstrap_CMUX_2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(CIRBTS_KEYGEN, CMUX_3, STD128_CircuitBootstrap_CMUX_3)->Unit(benchmark::kMillisecond);
+
+/*
+ * Stages of circuit bootstrapping
+ */
+
+// modulus switching of all the coefficients of an LWE ciphertext
+template <class ParamSet>
+void CIRBTS_SPECIALMS(benchmark::State& state, ParamSet param_set) {
+    auto& ctx     = GetCirBTSContext(param_set);
+    auto& params  = ctx.cc.GetParams();
+    auto& scheme  = ctx.cc.GetCirBTSScheme();
+    auto ct       = ctx.cc.Encrypt(ctx.sk, 1);
+    uint32_t bits = GetBitwidth(ctx.cc);
+    NativeInteger q{params->GetLWEParams()->Getq()};
+    NativeInteger twoN{2 * params->GetRingGSWParams1()->GetN()};
+
+    const auto& a = ct->GetA();
+    for (auto _ : state) {
+        for (uint32_t i = 0; i < a.GetLength(); ++i)
+            benchmark::DoNotOptimize(scheme->SpecilMS(a[i], twoN, q, bits));
+        benchmark::DoNotOptimize(scheme->SpecilMS(ct->GetB(), twoN, q, bits));
+    }
+}
+
+BENCHMARK_CAPTURE(CIRBTS_SPECIALMS, AUTO, STD128_CircuitBootstrap_AUTO)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(CIRBTS_SPECIALMS, CMUX_1, STD128_CircuitBootstrap_CMUX_1)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(CIRBTS_SPECIALMS, CMUX_2, STD128_CircuitBootstrap_CMUX_2)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(CIRBTS_SPECIALMS, CMUX_3, STD128_CircuitBootstrap_CMUX_3)->Unit(benchmark::kMicrosecond);
+
+// MV-FBS: modulus switching and blind rotation of one LWE ciphertext
+template <class ParamSet>
+void CIRBTS_BOOTSTRAPMANYLUT(benchmark::State& state, ParamSet param_set) {
+    auto& ctx    = GetCirBTSContext(param_set);
+    auto& params = ctx.cc.GetParams();
+    auto& scheme = ctx.cc.GetCirBTSScheme();
+    auto ct      = ctx.cc.Encrypt(ctx.sk, 1);
+
+    for (auto _ : state) {
+        RLWECiphertext acc =
+            scheme->BootstrapManyLUT(params, ctx.cc.GetRefreshKey(), ct, params->GetLUT(), GetBitwidth(ctx.cc));
+    }
+}
+
+BENCHMARK_CAPTURE(CIRBTS_BOOTSTRAPMANYLUT, AUTO, STD128_CircuitBootstrap_AUTO)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(CIRBTS_BOOTSTRAPMANYLUT, CMUX_1, STD128_CircuitBootstrap_CMUX_1)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(CIRBTS_BOOTSTRAPMANYLUT, CMUX_2, STD128_CircuitBootstrap_CMUX_2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(CIRBTS_BOOTSTRAPMANYLUT, CMUX_3, STD128_CircuitBootstrap_CMUX_3)->Unit(benchmark::kMillisecond);
+
+// homomorphic trace of one RLWE ciphertext
+template <class ParamSet>
+void CIRBTS_EVALHT(benchmark::State& state, ParamSet param_set) {
+    auto& ctx = GetCirBTSContext(param_set);
+    auto ct   = EncryptRLWE(ctx);
+    RingLWEHomTrace homTrace;
+
+    for (auto _ : state) {
+        auto res = std::make_shared<RLWECiphertextImpl>(*ct);
+        homTrace.EvalHT(ctx.cc.GetParams()->GetRLWEParams(), ctx.cc.GetHomTraceKey(), res);
+    }
+}
+
+BENCHMARK_CAPTURE(CIRBTS_EVALHT, AUTO, STD128_CircuitBootstrap_AUTO)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(CIRBTS_EVALHT, CMUX_1, STD128_CircuitBootstrap_CMUX_1)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(CIRBTS_EVALHT, CMUX_2, STD128_CircuitBootstrap_CMUX_2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(CIRBTS_EVALHT, CMUX_3, STD128_CircuitBootstrap_CMUX_3)->Unit(benchmark::kMillisecond);
+
+// scheme switching of one RLWE ciphertext
+template <class ParamSet>
+void CIRBTS_EVALSS(benchmark::State& state, ParamSet param_set) {
+    auto& ctx = GetCirBTSContext(param_set);
+    auto ct   = EncryptRLWE(ctx);
+    RingLWESchemeSwitch schemeSwitch;
+
+    for (auto _ : state) {
+        auto res = std::make_shared<RLWECiphertextImpl>(*ct);
+        schemeSwitch.EvalSS(ctx.cc.GetParams()->GetRLWEParams(), ctx.cc.GetSchemeSwitchingKey(), res);
+    }
+}
+
+BENCHMARK_CAPTURE(CIRBTS_EVALSS, AUTO, STD128_CircuitBootstrap_AUTO)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(CIRBTS_EVALSS, CMUX_1, STD128_CircuitBootstrap_CMUX_1)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(CIRBTS_EVALSS, CMUX_2, STD128_CircuitBootstrap_CMUX_2)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(CIRBTS_EVALSS, CMUX_3, STD128_CircuitBootstrap_CMUX_3)->Unit(benchmark::kMicrosecond);
+
+// whole circuit bootstrap of one LWE ciphertext
+template <class ParamSet>
+void CIRBTS_CIRCUITBOOTSTRAP(benchmark::State& state, ParamSet param_set) {
+    auto& ctx = GetCirBTSContext(param_set);
+    auto ct   = ctx.cc.Encrypt(ctx.sk, 1);
+
+    for (auto _ : state) {
+        RGSWCiphertext ctGSW = ctx.cc.CircuitBootstrapping(ct);
+    }
+}
+
+BENCHMARK_CAPTURE(CIRBTS_CIRCUITBOOTSTRAP, AUTO, STD128_CircuitBootstrap_AUTO)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(CIRBTS_CIRCUITBOOTSTRAP, CMUX_1, STD128_CircuitBootstrap_CMUX_1)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(CIRBTS_CIRCUITBOOTSTRAP, CMUX_2, STD128_CircuitBootstrap_CMUX_2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(CIRBTS_CIRCUITBOOTSTRAP, CMUX_3, STD128_CircuitBootstrap_CMUX_3)->Unit(benchmark::kMillisecond);
+
+/*
+ * Circuit computation
+ */
+
+template <class ParamSet>
+void CIRBTS_EXTERNALPRODUCT(benchmark::State& state, ParamSet param_set) {
+    auto& ctx = GetCirBTSContext(param_set);
+    auto sel  = ctx.cc.CircuitBootstrapping(ctx.cc.Encrypt(ctx.sk, 1));
+    auto ct   = EncryptRLWE(ctx);
+    BlindRotationWorkspace ws;
+
+    for (auto _ : state) {
+        auto res = std::make_shared<RLWECiphertextImpl>(*ct);
+        ctx.cc.EvalExternalProductInPlace(sel, res, ws);
+    }
+}
+
+BENCHMARK_CAPTURE(CIRBTS_EXTERNALPRODUCT, AUTO, STD128_CircuitBootstrap_AUTO)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(CIRBTS_EXTERNALPRODUCT, CMUX_1, STD128_CircuitBootstrap_CMUX_1)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(CIRBTS_EXTERNALPRODUCT, CMUX_2, STD128_CircuitBootstrap_CMUX_2)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(CIRBTS_EXTERNALPRODUCT, CMUX_3, STD128_CircuitBootstrap_CMUX_3)->Unit(benchmark::kMicrosecond);
+
+template <class ParamSet>
+void CIRBTS_CMUX(benchmark::State& state, ParamSet param_set) {
+    auto& ctx = GetCirBTSContext(param_set);
+    auto sel  = ctx.cc.CircuitBootstrapping(ctx.cc.Encrypt(ctx.sk, 1));
+    auto ct0  = EncryptRLWE(ctx);
+    auto ct1  = EncryptRLWE(ctx);
+    BlindRotationWorkspace ws;
+
+    for (auto _ : state) {
+        auto res = std::make_shared<RLWECiphertextImpl>(*ct0);
+        ctx.cc.EvalCMuxInPlace(sel, res, ct1, ws);
+    }
+}
+
+BENCHMARK_CAPTURE(CIRBTS_CMUX, AUTO, STD128_CircuitBootstrap_AUTO)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(CIRBTS_CMUX, CMUX_1, STD128_CircuitBootstrap_CMUX_1)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(CIRBTS_CMUX, CMUX_2, STD128_CircuitBootstrap_CMUX_2)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(CIRBTS_CMUX, CMUX_3, STD128_CircuitBootstrap_CMUX_3)->Unit(benchmark::kMicrosecond);
+
+/*
+ * Thread scaling
+ */
+
+// batched circuit bootstrap; the arguments are the number of threads and the batch size
+template <class ParamSet>
+void CIRBTS_BATCH(benchmark::State& state, ParamSet param_set) {
+    auto& ctx  = GetCirBTSContext(param_set);
+    int threads(state.range(0));
+    uint32_t batch(state.range(1));
+    std::vector<LWECiphertext> ct(batch);
+    for (uint32_t i = 0; i < batch; ++i)
+        ct[i] = ctx.cc.Encrypt(ctx.sk, i & 0x1);
+
+    // the thread count of the caller is restored, which need not be the machine threads
+#ifdef PARALLEL
+    int savedThreads = omp_get_max_threads();
+#endif
+    OpenFHEParallelControls.SetNumThreads(threads);
+    for (auto _ : state) {
+        std::vector<RGSWCiphertext> ctGSW = ctx.cc.CircuitBootstrapBatch(ct);
+    }
+#ifdef PARALLEL
+    omp_set_num_threads(savedThreads);
+#endif
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+// 1, 2, 4, ... threads up to all the cores, and batches of 1, 4, 16, ..., 1024 ciphertexts
+void ThreadScalingArgs(benchmark::internal::Benchmark* b) {
+    int machineThreads = OpenFHEParallelControls.GetMachineThreads();
+    std::vector<int> threads;
+    for (int t = 1; t < machineThreads; t <<= 1)
+        threads.push_back(t);
+    threads.push_back(machineThreads);
+    for (auto t : threads) {
+        for (int batch = 1; batch <= 1024; batch <<= 2)
+            b->Args({t, batch});
+    }
+}
+
+BENCHMARK_CAPTURE(CIRBTS_BATCH, AUTO, STD128_CircuitBootstrap_AUTO)
+    ->Apply(ThreadScalingArgs)
+    ->ArgNames({"threads", "batch"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(CIRBTS_BATCH, CMUX_2, STD128_CircuitBootstrap_CMUX_2)
+    ->Apply(ThreadScalingArgs)
+    ->ArgNames({"threads", "batch"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -21,8 +21,6 @@ int main() {
     auto polyParams = rlweParams->GetPolyParams();
     auto N          = polyParams->GetRingDimension();
     auto Q          = polyParams->GetModulus();
-    auto basecc     = cc.GetParams()->GetRingGSWParams2()->GetBaseG();
-    auto digitscc   = cc.GetParams()->GetDigitsCC();
 
     BinaryUniformGeneratorImpl<NativeVector> bug;
     NativePoly m1p(bug, polyParams, COEFFICIENT);
@@ -36,11 +34,13 @@ int main() {
     cc.CirBTKeyGen(sk, sk2);
 
     std::chrono::system_clock::time_point start, end;
+    BlindRotationWorkspace ws;
 
     for (int l = 0; l < loop; l++) {
         start = std::chrono::system_clock::now();
 
         auto ct_gsw = cc.CircuitBootstrapping(ct2);
+        auto ct_cc  = std::make_shared<RLWECiphertextImpl>(*ct1);
 
         end = std::chrono::system_clock::now();
 
@@ -49,26 +49,11 @@ int main() {
         time += elapsed;
 
         //RLWE and GSW external product
-        std::vector<NativePoly> dct1(2 * digitscc, NativePoly(polyParams, COEFFICIENT, true));
-        ct1->GetElements()[0].SetFormat(COEFFICIENT);
-        ct1->GetElements()[1].SetFormat(COEFFICIENT);
-        rlwecontext.SignedDigitDecompose(rlweParams, ct1, basecc, digitscc, dct1);
-
-#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(2 * digitscc))
-        for (uint32_t i = 0; i < (2 * digitscc); ++i)
-            dct1[i].SetFormat(Format::EVALUATION);
-
-        std::vector<NativePoly> ct_cc(2, NativePoly(polyParams, EVALUATION, true));
-
-        for (uint32_t i = 0; i < (2 * digitscc); ++i) {
-            ct_cc[0] += dct1[i] * ct_gsw->GetElements()[i][0];
-            ct_cc[1] += dct1[i] * ct_gsw->GetElements()[i][1];
-        }
+        cc.EvalExternalProductInPlace(ct_gsw, ct_cc, ws);
 
         //Verify if ct_cc is the RLWE ciphertext of m1
-        RLWECiphertextImpl ct_c(ct_cc);
         NativePoly m(polyParams, COEFFICIENT, false);
-        rlwecontext.Decrypt(rlweParams, sk2, std::make_shared<RLWECiphertextImpl>(ct_c), &m, 2);
+        rlwecontext.Decrypt(rlweParams, sk2, ct_cc, &m, 2);
 
         for (uint32_t i = 0; i < N; i++) {
             if (m[i].ConvertToInt() != m1p[i].ConvertToInt()) {
@@ -0,0 +1,48 @@
+#ifndef _AUTOMORPHISM_PLAN_H_
+#define _AUTOMORPHISM_PLAN_H_
+
+#include "lattice/lat-hal.h"
+
+#include <vector>
+
+namespace lbcrypto {
+
+/**
+ * @brief Precomputed evaluation-domain permutation of the automorphism X -> X^k,
+ * stored together with its cycle decomposition so that it can be applied in place
+ */
+class AutomorphismPlan {
+public:
+    AutomorphismPlan() = default;
+
+    /**
+   * Precomputes the permutation of X -> X^k for ring dimension N
+   *
+   * @param N ring dimension
+   * @param k automorphism index (odd)
+   */
+    AutomorphismPlan(uint32_t N, uint32_t k);
+
+    uint32_t GetIndex() const {
+        return m_k;
+    }
+
+    /**
+   * Applies the automorphism to a polynomial in EVALUATION format, in place
+   *
+   * @param poly the polynomial to be permuted
+   */
+    void Apply(NativePoly& poly) const;
+
+private:
+    // automorphism index
+    uint32_t m_k{};
+    // m_map[j]: the slot whose value moves to slot j
+    std::vector<uint32_t> m_map;
+    // one slot of every non-trivial cycle of m_map
+    std::vector<uint32_t> m_cycles;
+};
+
+}  // namespace lbcrypto
+
+#endif
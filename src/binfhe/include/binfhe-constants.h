@@ -136,6 +136,15 @@ enum BINFHE_METHOD {
 };
 std::ostream& operator<<(std::ostream& s, BINFHE_METHOD f);
 
+/**
+ * @brief Arithmetic backend of the RGSW x RLWE external products in the blind rotation
+ */
+enum EXTPROD_BACKEND {
+    NTT_BACKEND = 0,  // exact products over NativePoly in the NTT domain
+    FFT_BACKEND,      // double-precision negacyclic FFT, the refresh key is stored in the FFT domain
+};
+std::ostream& operator<<(std::ostream& s, EXTPROD_BACKEND f);
+
 /**
  * @brief Type of gates supported, with two, three or four inputs
  */
@@ -6,6 +6,10 @@
 #include "lwe-cryptoparameters.h"
 #include "rlwe-cryptoparameters.h"
 #include "rgsw-cryptoparameters.h"
+#include "eval-monomials.h"
+
+#include <memory>
+#include <string>
 
 namespace lbcrypto{
 
@@ -13,7 +17,7 @@ namespace lbcrypto{
  * @brief Class that stores all parameters for the RingGSW scheme used in circuit
  * bootstrapping
  */
-class CirBTSCryptoParams {
+class CirBTSCryptoParams : public Serializable {
 public:
     CirBTSCryptoParams() = default;
         /**
@@ -89,8 +93,59 @@ public:
         return m_LUT;
     }
 
-    const NativePoly& GetMonomial(uint32_t i) const{
-        return m_monomials[i];
+    /**
+   * Getter for the generator of the monomials X^{-i} in EVALUATION format
+   * @return
+   */
+    const EvalMonomials& GetMonomials() const{
+        return m_monomials;
+    }
+
+    /**
+   * Getter for the backend of the external products in the MV-FBS
+   * @return
+   */
+    EXTPROD_BACKEND GetProductBackend() const{
+        return m_backend;
+    }
+
+    /**
+   * Setter for the backend of the external products in the MV-FBS
+   * @param backend NTT_BACKEND or FFT_BACKEND
+   */
+    void SetProductBackend(EXTPROD_BACKEND backend){
+        m_backend = backend;
+    }
+
+    template <class Archive>
+    void save(Archive& ar, std::uint32_t const version) const {
+        ar(::cereal::make_nvp("lweparams", m_LWEParams));
+        ar(::cereal::make_nvp("rgswparams1", m_RGSWParams1));
+        ar(::cereal::make_nvp("rlweparams", m_RLWEParams));
+        ar(::cereal::make_nvp("rgswparams2", m_RGSWParams2));
+        ar(::cereal::make_nvp("backend", m_backend));
+    }
+
+    template <class Archive>
+    void load(Archive& ar, std::uint32_t const version) {
+        if (version > SerializedVersion()) {
+            OPENFHE_THROW("serialized object version " + std::to_string(version) +
+                          " is from a later version of the library");
+        }
+        ar(::cereal::make_nvp("lweparams", m_LWEParams));
+        ar(::cereal::make_nvp("rgswparams1", m_RGSWParams1));
+        ar(::cereal::make_nvp("rlweparams", m_RLWEParams));
+        ar(::cereal::make_nvp("rgswparams2", m_RGSWParams2));
+        ar(::cereal::make_nvp("backend", m_backend));
+
+        PreCompute();
+    }
+
+    std::string SerializedObjectName() const override {
+        return "CirBTSCryptoParams";
+    }
+    static uint32_t SerializedVersion() {
+        return 1;
     }
 
 private:
@@ -109,9 +164,11 @@ private:
     //The LUT
     NativePoly m_LUT;
 
-    // Precomputed polynomials in Format::EVALUATION representation for X^{-i}
-    // (used only for CGGI bootstrapping)
-    std::vector<NativePoly> m_monomials;
+    // Generator of the polynomials X^{-i} in Format::EVALUATION representation
+    EvalMonomials m_monomials;
+
+    // Backend of the external products in the MV-FBS
+    EXTPROD_BACKEND m_backend{NTT_BACKEND};
 
 };
 
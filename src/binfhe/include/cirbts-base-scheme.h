@@ -2,6 +2,7 @@
 #define _CIRBTS_BASE_SCHEME_H
 
 #include "cirbts-base-params.h"
+#include "cirbts-noise.h"
 #include "lwe-pke.h"
 #include "rlwe-ciphertext.h"
 #include "rgsw-ciphertext.h"
@@ -18,19 +19,50 @@
 
 #include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace lbcrypto {
 
 // The struct for storing bootstrapping keys
-typedef struct {
+struct RingGSWCirBTKey {
     //refreshing key
     RingGSWACCKey RFkey;
     //Homtrace key
     RLWEHomTraceKey HTkey;
     //Scheme switching key
     RLWESchemeSwitchKey SSkey;
-} RingGSWCirBTKey;
+    //refreshing key in the FFT domain (only for the FFT backend)
+    RingGSWACCFFTKey FFTkey;
+    //round-to-odd correction key of the MV-FBS (only for LMKCDEY)
+    RingGSWEvalKey RTOkey;
+
+    // the key in the FFT domain is not serialized, it is derived from the refresh key on load
+    template <class Archive>
+    void save(Archive& ar, std::uint32_t const version) const {
+        ar(::cereal::make_nvp("RFkey", RFkey));
+        ar(::cereal::make_nvp("HTkey", HTkey));
+        ar(::cereal::make_nvp("SSkey", SSkey));
+        ar(::cereal::make_nvp("RTOkey", RTOkey));
+    }
+
+    template <class Archive>
+    void load(Archive& ar, std::uint32_t const version) {
+        if (version > SerializedVersion()) {
+            OPENFHE_THROW("serialized object version " + std::to_string(version) +
+                          " is from a later version of the library");
+        }
+        ar(::cereal::make_nvp("RFkey", RFkey));
+        ar(::cereal::make_nvp("HTkey", HTkey));
+        ar(::cereal::make_nvp("SSkey", SSkey));
+        ar(::cereal::make_nvp("RTOkey", RTOkey));
+        FFTkey.reset();
+    }
+
+    static uint32_t SerializedVersion() {
+        return 1;
+    }
+};
 
 /**
  * @brief circuit bootstrapping schemes described in
@@ -51,25 +83,113 @@ public:
     }
 
     /**
-   * Generates a refresh key
+   * Generates the circuit bootstrapping keys in parallel. Every key is generated from its own
+   * PRNG stream derived from the master seed (see PRNGStream), so the keys only depend on the
+   * secret keys and on the seed, and not on the number of threads
    *
    * @param params a shared pointer to RingGSW scheme parameters
    * @param LWEsk a shared pointer to the secret key of LWE
    * @param skNTT a shared pointer to the secret key of the RLWE
    * @param keygenMode enum to indicate generation of secret key only (SYM_ENCRYPT) or
    * secret key, public key pair (PUB_ENCRYPT)
-   * @return a shared pointer to the refresh key
+   * @param seed the master seed of the key generation
+   * @return the circuit bootstrapping keys
    */
     RingGSWCirBTKey KeyGen(const std::shared_ptr<CirBTSCryptoParams>& params, ConstLWEPrivateKey& LWEsk, ConstRLWEPrivateKey skNTT,
-                        KEYGEN_MODE keygenMode) const;
+                        KEYGEN_MODE keygenMode, const PolySeed& seed) const;
 
 
+    /**
+   * Converts a refresh key to the double-precision FFT domain of the FFT external product backend
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ek the refresh key
+   * @return a shared pointer to the refresh key in the FFT domain
+   */
+    RingGSWACCFFTKey KeyGenFFT(const std::shared_ptr<CirBTSCryptoParams>& params, ConstRingGSWACCKey& ek) const;
+
     /**
    * circuit bootstrapping
    */
     RGSWCiphertext CircuitBootstrap(const std::shared_ptr<CirBTSCryptoParams>& params, const RingGSWCirBTKey& ek,
                                     ConstLWECiphertext& ct) const;
 
+    /**
+   * circuit bootstrapping of a batch of LWE ciphertexts; one ciphertext is bootstrapped per thread
+   * and the nested (per-LUT and per-digit) parallel regions are run serially
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ek the circuit bootstrapping keys
+   * @param ct vector of input LWE ciphertexts
+   * @return a vector of RGSW ciphertexts, in the same order as the input
+   */
+    std::vector<RGSWCiphertext> CircuitBootstrapBatch(const std::shared_ptr<CirBTSCryptoParams>& params,
+                                                      const RingGSWCirBTKey& ek,
+                                                      const std::vector<LWECiphertext>& ct) const;
+
+    /**
+   * RGSW x RLWE external product in place: ct becomes an RLWE encryption of the product of the
+   * plaintexts of ctGSW and ct. ctGSW has the layout produced by circuit bootstrapping, i.e.,
+   * 2 * DigitsCC rows matching the signed digits (a_0, b_0, ..., a_{d-1}, b_{d-1}) of ct in the
+   * gadget of RingGSWParams2
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ctGSW the RGSW ciphertext, in Format::EVALUATION
+   * @param ct the RLWE ciphertext; the result is in Format::EVALUATION
+   * @param ws scratch polynomials, reused across calls by the same thread
+   */
+    void EvalExternalProductInPlace(const std::shared_ptr<CirBTSCryptoParams>& params, ConstRGSWCiphertext& ctGSW,
+                                    RLWECiphertext& ct, BlindRotationWorkspace& ws) const;
+
+    /**
+   * CMux in place: ct0 becomes ct0 + sel * (ct1 - ct0), i.e., an RLWE encryption of the
+   * plaintext of ct1 if sel encrypts 1 and of ct0 if sel encrypts 0, at the cost of a single
+   * external product
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param sel the RGSW encryption of the selector bit, see EvalExternalProductInPlace
+   * @param ct0 the RLWE ciphertext selected by 0; the result is in Format::EVALUATION
+   * @param ct1 the RLWE ciphertext selected by 1
+   * @param ws scratch polynomials, reused across calls by the same thread
+   */
+    void EvalCMuxInPlace(const std::shared_ptr<CirBTSCryptoParams>& params, ConstRGSWCiphertext& sel,
+                         RLWECiphertext& ct0, ConstRLWECiphertext& ct1, BlindRotationWorkspace& ws) const;
+
+    /**
+   * Evaluates a lookup table with k inputs and m outputs on circuit bootstrapped selector bits.
+   * The m output bits of an entry are packed in m consecutive coefficients (horizontal packing)
+   * and E = 2^e entries, the largest power of two with E * m <= N, in one plaintext polynomial.
+   * The k - e high bits select the polynomial with a tree of CMux gates, whose levels are
+   * evaluated in parallel, and the e low bits blindly rotate the selected polynomial by
+   * X^{-m * low} with CMux gates (vertical packing). Only the polynomials holding entries of the
+   * table enter the tree, the others are selected as 0
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param sel the RGSW encryptions of the k input bits, least significant first
+   * @param table the table of at most 2^k entries, T[x] < 2^m; the missing entries are 0
+   * @param numOutputBits m, or 0 to use the bit length of the largest entry
+   * @return an RLWE encryption (plaintext modulus 2) whose coefficients 0, ..., m - 1 are the
+   * bits of T[x], least significant first, in Format::EVALUATION
+   */
+    RLWECiphertext EvalLUT(const std::shared_ptr<CirBTSCryptoParams>& params, const std::vector<RGSWCiphertext>& sel,
+                           const std::vector<uint64_t>& table, uint32_t numOutputBits) const;
+
+    /**
+   * Debug mode measuring the errors of the stages of circuit bootstrapping with the secret keys:
+   * numRuns circuit bootstrappings of alternating bits are evaluated in parallel, one per thread,
+   * and the phase of every intermediate ciphertext is compared with its exact value. Every run
+   * also evaluates an external product of its result with an RLWE encryption of a random binary
+   * polynomial. See CirBTSNoiseStats for the errors measured
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ek the circuit bootstrapping keys
+   * @param LWEsk the LWE secret key the keys were generated with
+   * @param skNTT the RLWE secret key the keys were generated with
+   * @param numRuns the number of circuit bootstrappings
+   * @return the error statistics summed over the runs
+   */
+    CirBTSNoiseStats MeasureNoise(const std::shared_ptr<CirBTSCryptoParams>& params, const RingGSWCirBTKey& ek,
+                                  ConstLWEPrivateKey& LWEsk, ConstRLWEPrivateKey& skNTT, uint32_t numRuns) const;
 
      /**
    * Bootstrapping manyLUTs operation
@@ -84,6 +204,49 @@ public:
     RLWECiphertext BootstrapManyLUT(const std::shared_ptr<CirBTSCryptoParams>& params, ConstRingGSWACCKey& ek,
                                     ConstLWECiphertext& ct, const NativePoly& LUT, uint32_t bitwidth) const;
 
+    /**
+   * Bootstrapping manyLUTs operation for a group of ciphertexts; the accumulators are advanced
+   * in lockstep over the refresh keys, see RingGSWAccumulator::EvalAccBatch
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ek a shared pointer to the bootstrapping keys
+   * @param ct vector of input ciphertexts
+   * @param LUT function to evaluate in the multi-value functional bootstrapping
+   * @param bitwidth the bits represented numLUT in MV-FBS
+   * @return a vector of shared pointers to the resulting ciphertexts
+   */
+    std::vector<RLWECiphertext> BootstrapManyLUTBatch(const std::shared_ptr<CirBTSCryptoParams>& params,
+                                                      ConstRingGSWACCKey& ek, const std::vector<LWECiphertext>& ct,
+                                                      const NativePoly& LUT, uint32_t bitwidth) const;
+
+    /**
+   * Bootstrapping manyLUTs operation with the refresh key in the double-precision FFT domain
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ek a shared pointer to the refresh key in the FFT domain
+   * @param ct input ciphertext
+   * @param LUT function to evaluate in the multi-value functional bootstrapping
+   * @param bitwidth the bits represented numLUT in MV-FBS
+   * @return a shared pointer to the resulting ciphertext
+   */
+    RLWECiphertext BootstrapManyLUT(const std::shared_ptr<CirBTSCryptoParams>& params, ConstRingGSWACCFFTKey& ek,
+                                    ConstLWECiphertext& ct, const NativePoly& LUT, uint32_t bitwidth) const;
+
+    /**
+   * Bootstrapping manyLUTs operation for a group of ciphertexts with the refresh key in the
+   * double-precision FFT domain
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ek a shared pointer to the refresh key in the FFT domain
+   * @param ct vector of input ciphertexts
+   * @param LUT function to evaluate in the multi-value functional bootstrapping
+   * @param bitwidth the bits represented numLUT in MV-FBS
+   * @return a vector of shared pointers to the resulting ciphertexts
+   */
+    std::vector<RLWECiphertext> BootstrapManyLUTBatch(const std::shared_ptr<CirBTSCryptoParams>& params,
+                                                      ConstRingGSWACCFFTKey& ek, const std::vector<LWECiphertext>& ct,
+                                                      const NativePoly& LUT, uint32_t bitwidth) const;
+
      /**
    * Special modulus switching operation in MV-FBS
    *
@@ -96,6 +259,94 @@ public:
     NativeInteger SpecilMS(const NativeInteger& v, const NativeInteger& q, const NativeInteger& Q, const uint32_t bitwidth) const;
 
 protected:
+    /**
+   * Special modulus switching of ct to 2N and generation of the initial MV-FBS accumulator X^{-b_MS} * LUT
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ct input ciphertext
+   * @param LUT function to evaluate in the multi-value functional bootstrapping
+   * @param bitwidth the bits represented numLUT in MV-FBS
+   * @param a_ms the modulus switched vector a of ct
+   * @return a shared pointer to the initial accumulator
+   */
+    RLWECiphertext InitManyLUTAcc(const std::shared_ptr<CirBTSCryptoParams>& params, ConstLWECiphertext& ct,
+                                  const NativePoly& LUT, uint32_t bitwidth, NativeVector& a_ms) const;
+
+    /**
+   * Removes the round-to-odd offset of the LMKCDEY blind rotation from the MV-FBS accumulators;
+   * the modulus switched vectors a are even, so the offset is the same for every ciphertext.
+   * Does nothing for the other methods
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ek the circuit bootstrapping keys
+   * @param acc the accumulators after the blind rotation, modified in place
+   */
+    void CorrectRoundToOdd(const std::shared_ptr<CirBTSCryptoParams>& params, const RingGSWCirBTKey& ek,
+                           std::vector<RLWECiphertext>& acc) const;
+
+    /**
+   * Converts the result of MV-FBS to an RGSW ciphertext using HomTrace and scheme switching
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ek the circuit bootstrapping keys
+   * @param acc the accumulator after MV-FBS, modified in place
+   * @return a shared pointer to the resulting RGSW ciphertext
+   */
+    RGSWCiphertext ConvertToRGSW(const std::shared_ptr<CirBTSCryptoParams>& params, const RingGSWCirBTKey& ek,
+                                 RLWECiphertext& acc) const;
+
+    /**
+   * Scales the MV-FBS accumulator by 1/N and rotates it into the numLUT RLWE ciphertexts acc*X^{-i}
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param acc the accumulator after MV-FBS, modified in place and returned as the first element
+   * @return the numLUT RLWE ciphertexts to be traced
+   */
+    std::vector<RLWECiphertext> SplitManyLUT(const std::shared_ptr<CirBTSCryptoParams>& params,
+                                             RLWECiphertext& acc) const;
+
+    /**
+   * acc += ctGSW * (ws.GetCt()) for the RLWE ciphertext held by the workspace in
+   * Format::COEFFICIENT; the digits are transformed as they are produced and multiplied with
+   * the rows of ctGSW in place, without temporary products
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ctGSW the RGSW ciphertext, in Format::EVALUATION
+   * @param ws the workspace holding the input; its digits are overwritten
+   * @param acc the two polynomials of the result, in Format::EVALUATION
+   * @param overwrite true to assign the product to acc instead of adding it
+   */
+    void AddExternalProduct(const std::shared_ptr<CirBTSCryptoParams>& params, ConstRGSWCiphertext& ctGSW,
+                            BlindRotationWorkspace& ws, std::vector<NativePoly>& acc, bool overwrite) const;
+
+    /**
+   * Builds the RGSW ciphertext from the traced RLWE ciphertexts; the odd rows are the traced
+   * ciphertexts and the even rows are their scheme switched counterparts
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ek the circuit bootstrapping keys
+   * @param MV_RLWEs the numLUT traced RLWE ciphertexts, modified in place
+   * @return a shared pointer to the resulting RGSW ciphertext
+   */
+    RGSWCiphertext SchemeSwitchToRGSW(const std::shared_ptr<CirBTSCryptoParams>& params, const RingGSWCirBTKey& ek,
+                                      std::vector<RLWECiphertext>& MV_RLWEs) const;
+
+    /**
+   * One run of MeasureNoise
+   *
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ek the circuit bootstrapping keys
+   * @param LWEsk the LWE secret key
+   * @param skNTT the RLWE secret key polynomial in Format::EVALUATION
+   * @param ct the LWE encryption of bit
+   * @param bit the plaintext of ct
+   * @param ctEP the RLWE ciphertext multiplied with the circuit bootstrapped ct
+   * @return the error statistics of the run
+   */
+    CirBTSNoiseStats MeasureNoiseRun(const std::shared_ptr<CirBTSCryptoParams>& params, const RingGSWCirBTKey& ek,
+                                     ConstLWEPrivateKey& LWEsk, const NativePoly& skNTT, ConstLWECiphertext& ct,
+                                     LWEPlaintext bit, ConstRLWECiphertext& ctEP) const;
+
     std::shared_ptr<LWEEncryptionScheme> LWEscheme{std::make_shared<LWEEncryptionScheme>()};
     std::shared_ptr<RingGSWAccumulator> ACCscheme{nullptr};
     std::shared_ptr<RingLWEHomTrace> HomTrace{nullptr};
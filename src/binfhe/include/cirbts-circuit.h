@@ -0,0 +1,124 @@
+#ifndef _CIRBTS_CIRCUIT_H_
+#define _CIRBTS_CIRCUIT_H_
+
+#include "cirbtscontext.h"
+
+#include <memory>
+#include <vector>
+
+namespace lbcrypto {
+
+enum CIRCUIT_NODE_TYPE { LWE_INPUT, RLWE_INPUT, CMUX_NODE, EXTPROD_NODE, LUT_NODE };
+
+/**
+ * @brief A circuit of CMux gates, external products and lookup tables over circuit
+ * bootstrapped LWE wires, stored as a DAG: a node only refers to nodes added before it.
+ *
+ * The LWE inputs are the selector wires; every wire used by a needed node is circuit
+ * bootstrapped exactly once, whatever its fan-out, and its RGSW ciphertext is released after
+ * its last consumer. The RLWE values flow between the gates and are released in the same way.
+ * Evaluate runs the bootstraps and the gates as OpenMP tasks: a gate is spawned as soon as its
+ * selectors and inputs are ready, so independent parts of the circuit run in parallel and the
+ * gates start before all the bootstraps are done
+ */
+class CirBTSCircuit {
+public:
+    CirBTSCircuit() = default;
+
+    /**
+   * Adds an LWE input (a selector wire); the inputs are numbered in the order they are added
+   *
+   * @return the node id
+   */
+    uint32_t AddLWEInput();
+
+    /**
+   * Adds an RLWE input under the level 2 secret key; numbered in the order they are added
+   *
+   * @return the node id
+   */
+    uint32_t AddRLWEInput();
+
+    /**
+   * Adds a CMux gate, see CirBTSContext::EvalCMux
+   *
+   * @param sel the LWE wire of the selector
+   * @param ct0 the RLWE node selected by 0
+   * @param ct1 the RLWE node selected by 1
+   * @return the node id
+   */
+    uint32_t AddCMux(uint32_t sel, uint32_t ct0, uint32_t ct1);
+
+    /**
+   * Adds an external product of a bit and an RLWE value, see CirBTSContext::EvalExternalProduct
+   *
+   * @param sel the LWE wire of the bit
+   * @param ct the RLWE node
+   * @return the node id
+   */
+    uint32_t AddExternalProduct(uint32_t sel, uint32_t ct);
+
+    /**
+   * Adds a lookup table, see CirBTSContext::EvalLUT
+   *
+   * @param sel the LWE wires of the index bits, least significant first
+   * @param table the table
+   * @param numOutputBits the number of output bits, or 0 to use the bit length of the largest entry
+   * @return the node id
+   */
+    uint32_t AddLUT(const std::vector<uint32_t>& sel, const std::vector<uint64_t>& table, uint32_t numOutputBits = 0);
+
+    /**
+   * Marks an RLWE node as an output; Evaluate returns the outputs in the order they are marked
+   *
+   * @param node the node id
+   */
+    void MarkOutput(uint32_t node);
+
+    /**
+   * Gets the number of circuit bootstraps of an evaluation, i.e., the number of distinct LWE
+   * wires the outputs depend on
+   */
+    uint32_t GetNumBootstraps() const;
+
+    /**
+   * Evaluates the circuit; only the nodes the outputs depend on are evaluated
+   *
+   * @param cc the context holding the circuit bootstrapping keys
+   * @param bits the LWE inputs
+   * @param cts the RLWE inputs
+   * @return the RLWE outputs
+   */
+    std::vector<RLWECiphertext> Evaluate(const CirBTSContext& cc, const std::vector<LWECiphertext>& bits,
+                                         const std::vector<RLWECiphertext>& cts) const;
+
+private:
+    struct Node {
+        CIRCUIT_NODE_TYPE type;
+        // input index for the inputs
+        uint32_t index{0};
+        // distinct LWE wires and RLWE nodes the node depends on
+        std::vector<uint32_t> wires;
+        std::vector<uint32_t> inputs;
+        // operands in gate order
+        std::vector<uint32_t> sel;
+        std::vector<uint32_t> ct;
+        std::vector<uint64_t> table;
+        uint32_t numOutputBits{0};
+    };
+
+    uint32_t AddGate(Node&& node);
+    void CheckNode(uint32_t node, CIRCUIT_NODE_TYPE type) const;
+    std::vector<bool> GetNeeded() const;
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_outputs;
+    uint32_t m_numLWEInputs{0};
+    uint32_t m_numRLWEInputs{0};
+
+    friend class CirBTSCircuitExecution;
+};
+
+}  // namespace lbcrypto
+
+#endif
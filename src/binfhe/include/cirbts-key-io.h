@@ -0,0 +1,95 @@
+#ifndef _CIRBTS_KEY_IO_H_
+#define _CIRBTS_KEY_IO_H_
+
+#include "cirbts-base-scheme.h"
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace lbcrypto {
+
+/**
+ * @brief Raw binary format of the circuit bootstrapping keys. Every field is a native-endian
+ * uint64 word:
+ *
+ *   header:   magic, version, N, Q, method, mask of the present keys (RF, HT, SS, RTO)
+ *   ACC key:  dim1, dim2, dim3, then for every slot a presence word followed by the eval key
+ *   eval key: rows, cols, seeded, then for every row its seed if seeded (16 uint32 words) and
+ *             for every polynomial its format followed by its N coefficients; the polynomials
+ *             of the first column of a seeded key are not written but expanded from the seeds
+ *
+ * The refresh and round-to-odd keys use the ring of RingGSWParams1, the homtrace and scheme
+ * switching keys the ring of RLWEParams. The coefficients are read straight into the buffers
+ * of preallocated polynomials, without the per-element overhead of cereal.
+ *
+ * The mappable format stores the keys exactly as the flat arrays read by the external products,
+ * so that a file mapped read-only is shared through the page cache by all the processes using
+ * it and no key is copied or expanded on load:
+ *
+ *   header:   magic, version, N, Q, method, mask, offset and size in bytes of the data region
+ *   ACC key:  dim1, dim2, dim3, then for every slot a presence word followed by the eval key
+ *   eval key: rows, cols, offset of its block in the data region
+ *
+ * The data region starts at a multiple of MAP_ALIGNMENT and the blocks of the eval keys follow
+ * each other in it, so a block is only aligned to 8 bytes; the block of an eval key holds its
+ * rows * cols polynomials in Format::EVALUATION, row by row, N coefficients each
+ */
+class CirBTSKeyIO {
+public:
+    static constexpr uint64_t MAGIC   = 0x59454b5354424943;  // "CIBTSKEY"
+    static constexpr uint64_t VERSION = 2;
+
+    static constexpr uint64_t MAP_MAGIC     = 0x50414d5354424943;  // "CIBTSMAP"
+    static constexpr uint64_t MAP_VERSION   = 1;
+    static constexpr uint64_t MAP_ALIGNMENT = 4096;
+
+    /**
+   * Writes the circuit bootstrapping keys; the key in the FFT domain is not written
+   *
+   * @param os output stream
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ek the circuit bootstrapping keys
+   */
+    static void Write(std::ostream& os, const std::shared_ptr<CirBTSCryptoParams>& params, const RingGSWCirBTKey& ek);
+
+    /**
+   * Reads circuit bootstrapping keys written by Write for the same parameters. Throws if the
+   * ring or the shape of a key (the gadget lengths, the key unrolling, the automorphism keys)
+   * differs from the parameters
+   *
+   * @param is input stream
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @return the circuit bootstrapping keys without the key in the FFT domain
+   */
+    static RingGSWCirBTKey Read(std::istream& is, const std::shared_ptr<CirBTSCryptoParams>& params);
+
+    /**
+   * Writes the circuit bootstrapping keys in the mappable format; seeded keys are written
+   * expanded and the key in the FFT domain is not written
+   *
+   * @param os output stream
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @param ek the circuit bootstrapping keys
+   */
+    static void WriteMappable(std::ostream& os, const std::shared_ptr<CirBTSCryptoParams>& params,
+                              const RingGSWCirBTKey& ek);
+
+    /**
+   * Maps a file written by WriteMappable for the same parameters read-only into memory. The
+   * returned keys are views of the mapping (see RingGSWEvalKeyImpl::IsView), which is released
+   * with the last of them; the pages are loaded on first use. The shapes of the keys in the
+   * header are checked against the parameters as in Read, the contents of the data region are
+   * trusted, i.e., not validated. Only supported on POSIX systems
+   *
+   * @param filename name of the file
+   * @param params a shared pointer to circuit bootstrapping scheme parameters
+   * @return the circuit bootstrapping keys without the key in the FFT domain
+   */
+    static RingGSWCirBTKey Map(const std::string& filename, const std::shared_ptr<CirBTSCryptoParams>& params);
+};
+
+}  // namespace lbcrypto
+
+#endif
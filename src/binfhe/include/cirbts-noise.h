@@ -0,0 +1,86 @@
+#ifndef _CIRBTS_NOISE_H_
+#define _CIRBTS_NOISE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lbcrypto {
+
+/**
+ * @brief Statistics of the error coefficients of a stage, centered in (-Q/2, Q/2]
+ */
+struct CirBTSErrorStats {
+    uint64_t count{0};
+    double sum{0.0};
+    double sumSquares{0.0};
+    double maxAbs{0.0};
+
+    void Add(double e) {
+        ++count;
+        sum += e;
+        sumSquares += e * e;
+        maxAbs = std::max(maxAbs, std::fabs(e));
+    }
+
+    double GetMean() const {
+        return count ? sum / count : 0.0;
+    }
+
+    double GetVariance() const {
+        if (count == 0)
+            return 0.0;
+        double mean = GetMean();
+        return std::max(sumSquares / count - mean * mean, 0.0);
+    }
+
+    /**
+   * @return log2 of the standard deviation, i.e., the bits of Q taken by the error
+   */
+    double GetStdDevBits() const {
+        double var = GetVariance();
+        return var > 0.0 ? 0.5 * std::log2(var) : 0.0;
+    }
+
+    void Merge(const CirBTSErrorStats& other) {
+        count += other.count;
+        sum += other.sum;
+        sumSquares += other.sumSquares;
+        maxAbs = std::max(maxAbs, other.maxAbs);
+    }
+};
+
+/**
+ * @brief Measured errors of the stages of circuit bootstrapping, see CirBTSScheme::MeasureNoise.
+ * The errors of the MV-FBS accumulator and of the traced ciphertexts are the whole errors of
+ * their phases; the errors of the key switching steps (a level of HomTrace, scheme switching and
+ * the external product) are the errors added by the step, i.e., the phase of the output minus
+ * the exact operation applied to the phase of the input, so that every entry only depends on
+ * the gadget of its own step
+ */
+struct CirBTSNoiseStats {
+    // the bit length of Q, to compare with the standard deviations
+    uint32_t logQ{0};
+    // number of circuit bootstrappings measured
+    uint32_t numRuns{0};
+    // the MV-FBS accumulator after the round-to-odd correction (BaseEP/DigitsEP)
+    CirBTSErrorStats mvfbs;
+    // the error added by each automorphism level of HomTrace (BaseHT/DigitsHT)
+    std::vector<CirBTSErrorStats> homtraceLevels;
+    // the traced RLWE ciphertexts, i.e., the odd rows of the RGSW ciphertext
+    CirBTSErrorStats homtrace;
+    // the error added by scheme switching to the even rows (BaseSS/DigitsSS)
+    CirBTSErrorStats schemeSwitch;
+    // the error added by an external product with the bootstrapped RGSW ciphertext (BaseCC/DigitsCC)
+    CirBTSErrorStats externalProduct;
+
+    void Merge(const CirBTSNoiseStats& other);
+
+    std::string ToJSON() const;
+};
+
+}  // namespace lbcrypto
+
+#endif
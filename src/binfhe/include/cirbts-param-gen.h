@@ -0,0 +1,192 @@
+#ifndef _CIRBTS_PARAM_GEN_H_
+#define _CIRBTS_PARAM_GEN_H_
+
+#include "cirbtscontext.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace lbcrypto {
+
+/**
+ * @brief Error variances predicted by CirBTSErrorModel for a set of parameters
+ */
+struct CirBTSErrorEstimate {
+    // blind rotation of the MV-FBS
+    double errBR{0.0};
+    // HomTrace
+    double errTrace{0.0};
+    // the even rows of the RGSW ciphertext, i.e., scheme switching of the traced ciphertexts
+    double errSS{0.0};
+    // error added by one external product with the circuit bootstrapped RGSW ciphertext
+    double noise{0.0};
+    // the number of external products before the output no longer decrypts within the failure rate
+    double maxDepth{0.0};
+    // number of NTTs of one circuit bootstrapping, the cost model of the candidates
+    uint64_t numNTTs{0};
+    // size of the bootstrapping keys in MB
+    double keySizeMB{0.0};
+};
+
+/**
+ * @brief The analytic error model of circuit bootstrapping of parameters_gen.py, see
+ * https://eprint.iacr.org/2024/323. The gadgets are given by their lengths l and the exponents b
+ * of their bases 2^b; the variances are in units of Z_Q with Q = 2^numberBits
+ */
+class CirBTSErrorModel {
+public:
+    /**
+   * @param params the parameters; only n, N, q, Q and the key deviation are read
+   * @param method GINX for the CMux blind rotation, LMKCDEY for the automorphism one
+   * @param numAutomorphisms number of automorphisms of the LMKCDEY blind rotation
+   */
+    CirBTSErrorModel(const CirBTSContextParams& params, BINFHE_METHOD method, uint32_t numAutomorphisms = 368);
+
+    /**
+   * @return log2 of erfc(x), also beyond the underflow of std::erfc
+   */
+    static double Log2Erfc(double x);
+
+    /**
+   * Gets the failure rate of the sparse rounding (modulus switching) of an LWE input
+   *
+   * @param sigmaIn2 the error variance of the LWE input
+   * @return log2 of the failure rate
+   */
+    double GetLog2FailureRate(double sigmaIn2) const;
+
+    /**
+   * Gets the largest error variance of the LWE inputs that keeps the failure rate of their
+   * modulus switching below a target
+   *
+   * @param log2FailureRate log2 of the target failure rate
+   * @return the error variance
+   */
+    double GetSigmaIn2(double log2FailureRate) const;
+
+    double ErrorBlindRotation(uint32_t l, uint32_t b) const;
+
+    double ErrorTrace(uint32_t l, uint32_t b) const;
+
+    double ErrorSchemeSwitch(uint32_t l, uint32_t b) const;
+
+    /**
+   * @param errSS the error variance of the even rows of the RGSW ciphertext
+   */
+    double NoiseSum(double errSS, uint32_t l, uint32_t b) const;
+
+    /**
+   * @param noise the error variance of an external product
+   * @param sigmaIn2 the error variance of the LWE inputs, see GetSigmaIn2
+   */
+    double MaxDepth(double noise, double sigmaIn2) const;
+
+    // the exponents of the bases minimizing the errors for a gadget length
+    uint32_t OptimizeBaseBR(uint32_t l) const;
+    uint32_t OptimizeBaseTrace(uint32_t l) const;
+    uint32_t OptimizeBaseSS(uint32_t l) const;
+    uint32_t OptimizeBaseNoise(double errSS, uint32_t l) const;
+
+    /**
+   * Predicts the errors of a set of parameters; the bases must be powers of two
+   *
+   * @param params the parameters
+   * @param sigmaIn2 the error variance of the LWE inputs, see GetSigmaIn2
+   * @return the estimate
+   */
+    CirBTSErrorEstimate Evaluate(const CirBTSContextParams& params, double sigmaIn2) const;
+
+private:
+    // the rounding error of an approximate gadget of length l and base 2^b
+    double RoundingError(uint32_t l, uint32_t b) const;
+
+    bool m_isAuto;
+    double m_n;
+    double m_N;
+    double m_q;
+    double m_logQ;
+    double m_sigmaKey;
+    double m_numAuto;
+};
+
+/**
+ * @brief Options of CirBTSParamsTuner
+ */
+struct CirBTSTunerOptions {
+    // the number of external products the RGSW ciphertexts must support
+    double targetDepth{1000};
+    // log2 of the failure rate of the modulus switching of the LWE inputs
+    double log2FailureRate{-32};
+    // the gadget lengths searched; the MV-FBS computes DigitsCC values, so every doubling of
+    // DigitsCC costs a bit of the modulus switching precision
+    uint32_t maxDigitsEP{3};
+    uint32_t maxDigitsHT{4};
+    uint32_t maxDigitsSS{3};
+    uint32_t maxDigitsCC{8};
+    // the number of candidates with the fewest NTTs that are benchmarked
+    uint32_t numCandidates{3};
+    // the number of timed circuit bootstrappings per candidate
+    uint32_t numSamples{3};
+    // the external products counted with every circuit bootstrapping in the latency
+    uint32_t productsPerBootstrap{1};
+};
+
+/**
+ * @brief A candidate of CirBTSParamsTuner
+ */
+struct CirBTSTunedParams {
+    CirBTSContextParams params;
+    CirBTSErrorEstimate estimate;
+    // latency of a circuit bootstrapping and productsPerBootstrap external products on this machine
+    double latencyMs{0.0};
+};
+
+/**
+ * @brief Chooses the gadgets of circuit bootstrapping for a workload: enumerates the gadget
+ * lengths, takes the bases minimizing the errors of CirBTSErrorModel, keeps the candidates
+ * reaching the target depth at the target failure rate, and benchmarks the ones with the fewest
+ * NTTs on this machine. The result is passed to CirBTSContext::GenerateCirBTSContext
+ */
+class CirBTSParamsTuner {
+public:
+    /**
+   * @param method the bootstrapping method
+   * @param options the target and the search space
+   */
+    explicit CirBTSParamsTuner(BINFHE_METHOD method, const CirBTSTunerOptions& options = CirBTSTunerOptions());
+
+    /**
+   * @param method the bootstrapping method
+   * @param base the parameters whose gadgets are tuned; the other fields are kept
+   * @param options the target and the search space
+   */
+    CirBTSParamsTuner(BINFHE_METHOD method, const CirBTSContextParams& base,
+                      const CirBTSTunerOptions& options = CirBTSTunerOptions());
+
+    /**
+   * @return the candidates reaching the target, with the fewest NTTs first; not benchmarked
+   */
+    std::vector<CirBTSTunedParams> GetCandidates() const;
+
+    /**
+   * Measures the latency of a candidate: generates a context and its keys, and times the
+   * circuit bootstrappings
+   *
+   * @param candidate the candidate, whose latencyMs is set
+   */
+    void Benchmark(CirBTSTunedParams& candidate) const;
+
+    /**
+   * @return the fastest of the benchmarked candidates
+   */
+    CirBTSTunedParams Tune() const;
+
+private:
+    BINFHE_METHOD m_method;
+    CirBTSContextParams m_base;
+    CirBTSTunerOptions m_options;
+};
+
+}  // namespace lbcrypto
+
+#endif
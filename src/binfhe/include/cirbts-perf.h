@@ -0,0 +1,166 @@
+#ifndef _CIRBTS_PERF_H_
+#define _CIRBTS_PERF_H_
+
+#include "cirbts-trace.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace lbcrypto {
+
+/**
+ * @brief The timed stages of circuit bootstrapping and of the circuit computation
+ */
+enum CIRBTS_STAGE {
+    STAGE_MODSWITCH,          // modulus switching of an LWE input and set-up of its accumulator
+    STAGE_BLIND_ROTATION,     // blind rotation of one accumulator (a batch records one sample per accumulator)
+    STAGE_ROUND_TO_ODD,       // LMKCDEY round-to-odd correction of one accumulator
+    STAGE_HOMTRACE,           // homomorphic trace of a group of RLWE ciphertexts
+    STAGE_HOMTRACE_LEVEL,     // one automorphism level of the homomorphic trace
+    STAGE_SCHEME_SWITCH,      // scheme switching of the traced ciphertexts into one RGSW ciphertext
+    STAGE_CIRCUIT_BOOTSTRAP,  // whole circuit bootstrapping of one ciphertext (likewise for a batch)
+    STAGE_EXTERNAL_PRODUCT,   // external product of an RGSW and an RLWE ciphertext
+    STAGE_CMUX,               // CMux gate
+    STAGE_LUT,                // lookup table evaluation
+    NUM_CIRBTS_STAGES
+};
+
+/**
+ * @brief Latency statistics of one stage. The histogram has logarithmic buckets: bucket b
+ * counts the samples that took [2^b, 2^(b+1)) microseconds, bucket 0 also the faster ones
+ */
+struct CirBTSStageStats {
+    static constexpr uint32_t NUM_BUCKETS = 32;
+
+    uint64_t count{0};
+    uint64_t totalNs{0};
+    uint64_t minNs{0};
+    uint64_t maxNs{0};
+    std::array<uint64_t, NUM_BUCKETS> histogram{};
+
+    double GetMeanNs() const {
+        return count ? static_cast<double>(totalNs) / count : 0.0;
+    }
+
+    /**
+   * Gets an upper bound of a percentile of the latency from the histogram
+   *
+   * @param p the percentile in [0, 1]
+   * @return the upper end of the bucket holding the percentile in microseconds, 0 without samples
+   */
+    uint64_t GetPercentileUs(double p) const;
+
+    void Merge(const CirBTSStageStats& other);
+};
+
+/**
+ * @brief Snapshot of the performance counters summed over all threads
+ */
+struct CirBTSPerfStats {
+    std::array<CirBTSStageStats, NUM_CIRBTS_STAGES> stages{};
+    // number of NTTs and inverse NTTs of native polynomials
+    uint64_t numTransforms{0};
+    // number of polynomial buffers allocated by the blind rotation workspaces
+    uint64_t numAllocations{0};
+
+    const CirBTSStageStats& operator[](CIRBTS_STAGE stage) const {
+        return stages[stage];
+    }
+
+    std::string ToJSON() const;
+};
+
+/**
+ * @brief Process-wide performance counters of circuit bootstrapping. Every thread records into
+ * its own counters, which only it writes, so recording takes no lock and shares no cache line;
+ * Collect sums the counters of all threads, including the threads that have exited. The
+ * counters are off by default; when off, a stage costs one relaxed atomic load
+ */
+class CirBTSPerf {
+public:
+    static void Enable(bool enable);
+
+    static bool IsEnabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    static CirBTSPerfStats Collect();
+
+    /**
+   * Zeroes the counters. It may run during a bootstrapping: the counters of every thread are
+   * dropped from Collect and cleared by the thread itself at its next sample, so the counts, the
+   * totals and the histograms stay consistent; the samples in flight during the reset are lost
+   */
+    static void Reset();
+
+    /**
+   * Records the latency of a stage
+   *
+   * @param stage the stage
+   * @param ns the duration in nanoseconds
+   * @param numSamples the number of ciphertexts processed together in ns, recorded as as many
+   * samples of ns / numSamples each
+   */
+    static void Record(CIRBTS_STAGE stage, uint64_t ns, uint64_t numSamples = 1);
+
+    static void CountAllocations(uint64_t numPolys) {
+        if (IsEnabled())
+            AddAllocations(numPolys);
+    }
+
+    static const char* GetStageName(CIRBTS_STAGE stage);
+
+private:
+    static void AddAllocations(uint64_t numPolys);
+
+    inline static std::atomic<bool> s_enabled{false};
+};
+
+/**
+ * @brief Times the enclosing scope as one sample of a stage, or as one sample per ciphertext of
+ * a batch, and records it as a span of the timeline when tracing, see CirBTSTrace
+ */
+class CirBTSPerfScope {
+public:
+    /**
+   * @param stage the stage
+   * @param active false to skip the sample, e.g., on all but one thread of a parallel region
+   * @param numSamples the number of ciphertexts of the batch timed by the scope
+   */
+    explicit CirBTSPerfScope(CIRBTS_STAGE stage, bool active = true, uint64_t numSamples = 1)
+        : m_stage(stage),
+          m_numSamples(numSamples),
+          m_perf(active && numSamples != 0 && CirBTSPerf::IsEnabled()),
+          m_trace(active && CirBTSTrace::IsEnabled()) {
+        if (m_perf || m_trace)
+            m_start = std::chrono::steady_clock::now();
+    }
+
+    ~CirBTSPerfScope() {
+        if (m_perf || m_trace) {
+            auto end = std::chrono::steady_clock::now();
+            if (m_perf)
+                CirBTSPerf::Record(m_stage, std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_start).count(),
+                                   m_numSamples);
+            if (m_trace)
+                CirBTSTrace::Record(CirBTSPerf::GetStageName(m_stage), m_start, end);
+        }
+    }
+
+    CirBTSPerfScope(const CirBTSPerfScope&)            = delete;
+    CirBTSPerfScope& operator=(const CirBTSPerfScope&) = delete;
+
+private:
+    CIRBTS_STAGE m_stage;
+    uint64_t m_numSamples;
+    bool m_perf;
+    bool m_trace;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+}  // namespace lbcrypto
+
+#endif
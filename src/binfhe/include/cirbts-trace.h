@@ -0,0 +1,99 @@
+#ifndef _CIRBTS_TRACE_H_
+#define _CIRBTS_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace lbcrypto {
+
+/**
+ * @brief Process-wide timeline of circuit bootstrapping in the Chrome trace-event format, to be
+ * opened in chrome://tracing or Perfetto. Every thread appends the begin and end times of its
+ * spans (the stages of CirBTSPerfScope and the sub-steps of CirBTSTraceScope) to its own
+ * buffer, so the spans of the nested OpenMP regions show on the threads that ran them. Tracing
+ * is off by default; when off, a span costs one relaxed atomic load
+ */
+class CirBTSTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // the spans beyond this number are dropped and counted, to bound the memory of a thread
+    static constexpr uint64_t MAX_EVENTS_PER_THREAD = uint64_t(1) << 20;
+
+    /**
+   * Starts or stops tracing; starting drops the spans of the previous session
+   *
+   * @param enable true to record spans
+   */
+    static void Enable(bool enable);
+
+    static bool IsEnabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+   * Records a span on the calling thread
+   *
+   * @param name name of the span, a string literal
+   * @param begin start time
+   * @param end end time
+   */
+    static void Record(const char* name, Clock::time_point begin, Clock::time_point end);
+
+    /**
+   * Writes the spans recorded so far as a Chrome trace-event JSON object
+   *
+   * @param os output stream
+   */
+    static void Write(std::ostream& os);
+
+    /**
+   * Writes the spans recorded so far to a file, see Write
+   *
+   * @param filename name of the file
+   * @return true on success, false if the file could not be written
+   */
+    static bool WriteToFile(const std::string& filename);
+
+    /**
+   * Drops the spans recorded so far
+   */
+    static void Clear();
+
+private:
+    inline static std::atomic<bool> s_enabled{false};
+};
+
+/**
+ * @brief Records the enclosing scope as a span of the timeline
+ */
+class CirBTSTraceScope {
+public:
+    /**
+   * @param name name of the span, a string literal
+   */
+    explicit CirBTSTraceScope(const char* name) : m_name(name), m_active(CirBTSTrace::IsEnabled()) {
+        if (m_active)
+            m_start = CirBTSTrace::Clock::now();
+    }
+
+    ~CirBTSTraceScope() {
+        if (m_active)
+            CirBTSTrace::Record(m_name, m_start, CirBTSTrace::Clock::now());
+    }
+
+    CirBTSTraceScope(const CirBTSTraceScope&)            = delete;
+    CirBTSTraceScope& operator=(const CirBTSTraceScope&) = delete;
+
+private:
+    const char* m_name;
+    bool m_active;
+    CirBTSTrace::Clock::time_point m_start;
+};
+
+}  // namespace lbcrypto
+
+#endif
@@ -0,0 +1,22 @@
+/*
+  Header file adding serialization support to circuit bootstrapping
+ */
+
+#ifndef BINFHE_CIRBTSCONTEXT_SER_H
+#define BINFHE_CIRBTSCONTEXT_SER_H
+
+#include "cirbtscontext.h"
+#include "utils/serial.h"
+
+CEREAL_REGISTER_TYPE(lbcrypto::LWECryptoParams);
+CEREAL_REGISTER_TYPE(lbcrypto::LWECiphertextImpl);
+CEREAL_REGISTER_TYPE(lbcrypto::LWEPrivateKeyImpl);
+CEREAL_REGISTER_TYPE(lbcrypto::RLWECryptoParams);
+CEREAL_REGISTER_TYPE(lbcrypto::RLWECiphertextImpl);
+CEREAL_REGISTER_TYPE(lbcrypto::RingGSWCryptoParams);
+CEREAL_REGISTER_TYPE(lbcrypto::RingGSWEvalKeyImpl);
+CEREAL_REGISTER_TYPE(lbcrypto::RingGSWACCKeyImpl);
+CEREAL_REGISTER_TYPE(lbcrypto::CirBTSCryptoParams);
+CEREAL_REGISTER_TYPE(lbcrypto::CirBTSContext);
+
+#endif
@@ -7,12 +7,15 @@
 #include "rgsw-cryptoparameters.h"
 #include "rlwe-ske.h"
 #include "cirbts-base-scheme.h"
+#include "cirbts-perf.h"
 
 #include "lattice/stdlatticeparms.h"
 #include "utils/serializable.h"
 
+#include <istream>
 #include <map>
 #include <memory>
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -23,7 +26,7 @@ namespace lbcrypto{
  * The parameters of circuitbootstrapping
  */
 struct CirBTSContextParams{
-    usint numberBits;
+    usint numberBits; // bit length of Q; the gadgets keep its top digits, the arithmetic is 64-bit for any size
     usint cyclOrder;//the order of cyclotomic ring
 
     // for LWE crypto parameters
@@ -48,7 +51,7 @@ struct CirBTSContextParams{
  *
  * The wrapper class for circuitbootstrap FHE
  */
-class CirBTSContext {
+class CirBTSContext : public Serializable {
 public:
     CirBTSContext() = default;
 
@@ -57,10 +60,59 @@ public:
    * most users.
    *
    * @param set the parameter set: STD128_CircuitBootstrap_AUTO, STD128_CircuitBootstrap_CMUX with their variants, see binfhe_constants.h
-   * @param method the bootstrapping method (CircuitBootstrap_AUTO or CircuitBootstrap_CMUX)
+   * @param method the bootstrapping method: GINX for the CMUX sets, LMKCDEY for STD128_CircuitBootstrap_AUTO
+   * @param backend the backend of the external products in the MV-FBS, see SetProductBackend
    * @return create the cryptocontext
    */
-    void GenerateCirBTSContext(CirBTS_PARAMSET set, BINFHE_METHOD method = GINX);
+    void GenerateCirBTSContext(CirBTS_PARAMSET set, BINFHE_METHOD method = GINX,
+                               EXTPROD_BACKEND backend = NTT_BACKEND);
+
+    /**
+   * Creates a crypto context using custom parameters, e.g., the output of CirBTSParamsTuner.
+   * The gadget bases must be powers of two and the gadgets must fit in numberBits
+   *
+   * @param params the parameters
+   * @param method the bootstrapping method
+   * @param backend the backend of the external products in the MV-FBS, see SetProductBackend
+   */
+    void GenerateCirBTSContext(const CirBTSContextParams& params, BINFHE_METHOD method = GINX,
+                               EXTPROD_BACKEND backend = NTT_BACKEND);
+
+    /**
+   * Gets the parameters of a predefined parameter set, e.g., as a starting point for custom ones
+   *
+   * @param set the parameter set
+   * @return the parameters
+   */
+    static CirBTSContextParams GetParamSet(CirBTS_PARAMSET set);
+
+    /**
+   * Selects the backend of the external products in the MV-FBS. FFT_BACKEND keeps a copy of the
+   * refresh key in the double-precision FFT domain (GINX only); it is derived from the refresh key
+   * when the keys already exist
+   *
+   * @param backend NTT_BACKEND or FFT_BACKEND
+   */
+    void SetProductBackend(EXTPROD_BACKEND backend);
+
+    /**
+   * Selects key unrolling for the MV-FBS (GINX only): the refresh key encrypts the indicators of
+   * the 2^u - 1 nonzero bit patterns of every group of u secret bits, so the blind rotation takes
+   * n/u sequential steps instead of n at the cost of (2^u - 1)/u times more key material.
+   * Must be called before CirBTKeyGen
+   *
+   * @param unroll 1 (no unrolling), 2 or 3
+   */
+    void SetKeyUnrollFactor(uint32_t unroll);
+
+    /**
+   * Gets the backend of the external products in the MV-FBS
+   *
+   * @return the backend
+   */
+    EXTPROD_BACKEND GetProductBackend() const {
+        return m_params->GetProductBackend();
+    }
 
     /**
    * Gets the circuit bootstrapping key.
@@ -139,6 +191,77 @@ public:
    */
     void CirBTKeyGen(ConstLWEPrivateKey& sk, ConstRLWEPrivateKey skNTT, KEYGEN_MODE keygenMode = SYM_ENCRYPT);
 
+    /**
+   * Generates circuit boostrapping keys from a master seed; the keys are generated in parallel
+   * and are the same for the same secret keys and seed, whatever the number of threads
+   *
+   * @param sk LWE secret key(level 0)
+   * @param skNTT RLWE secret key(level 2)
+   * @param seed master seed of the key generation, see SeededUniformGenerator::GenerateSeed; it
+   * determines the error samples of the keys, so it must be kept secret like sk and skNTT
+   * @param keygenMode key generation mode for symmetric or public encryption
+   */
+    void CirBTKeyGen(ConstLWEPrivateKey& sk, ConstRLWEPrivateKey skNTT, const PolySeed& seed,
+                     KEYGEN_MODE keygenMode = SYM_ENCRYPT);
+
+    /**
+   * Loads circuit bootstrapping keys in the context (typically after deserializing); the refresh
+   * key in the FFT domain is derived when the FFT backend is selected
+   *
+   * @param key struct with the circuit bootstrapping keys
+   */
+    void BTKeyLoad(const RingGSWCirBTKey& key);
+
+    /**
+   * Writes the circuit bootstrapping keys in the raw binary format of CirBTSKeyIO, which is
+   * loaded much faster than the cereal archive
+   *
+   * @param os output stream
+   */
+    void SerializeBTKey(std::ostream& os) const;
+
+    /**
+   * Reads circuit bootstrapping keys written by SerializeBTKey for the same parameters and
+   * loads them in the context
+   *
+   * @param is input stream
+   */
+    void DeserializeBTKey(std::istream& is);
+
+    /**
+   * Writes the circuit bootstrapping keys to a file in the raw binary format
+   *
+   * @param filename name of the file
+   * @return true on success, false if the file could not be opened
+   */
+    bool SerializeBTKeyToFile(const std::string& filename) const;
+
+    /**
+   * Reads the circuit bootstrapping keys from a file written by SerializeBTKeyToFile
+   *
+   * @param filename name of the file
+   * @return true on success, false if the file could not be opened
+   */
+    bool DeserializeBTKeyFromFile(const std::string& filename);
+
+    /**
+   * Writes the circuit bootstrapping keys to a file in the mappable format of CirBTSKeyIO
+   *
+   * @param filename name of the file
+   * @return true on success, false if the file could not be opened
+   */
+    bool SerializeBTKeyToMappableFile(const std::string& filename) const;
+
+    /**
+   * Maps a file written by SerializeBTKeyToMappableFile read-only and loads the keys in the
+   * context without copying them, so that all the processes mapping the file share one copy
+   * of the keys in memory. With the FFT backend, the refresh key in the FFT domain is still
+   * derived per process. Throws if the file can not be mapped
+   *
+   * @param filename name of the file
+   */
+    void MapBTKeyFromFile(const std::string& filename);
+
     /**
    * Clear the bootstrapping keys in the current context
    */
@@ -146,6 +269,8 @@ public:
         m_BTKey.RFkey.reset();
         m_BTKey.HTkey.reset();
         m_BTKey.SSkey.reset();
+        m_BTKey.FFTkey.reset();
+        m_BTKey.RTOkey.reset();
     }
 
     /**
@@ -155,6 +280,142 @@ public:
     */
     RGSWCiphertext CircuitBootstrapping(ConstLWECiphertext& ct) const;
 
+    /**
+    * Bootstap a batch of LWE ciphertexts to RGSW ciphertexts, one ciphertext per thread
+    *
+    * @param ct a vector of LWE ciphertexts to be circuit bootstrapped
+    * @return a vector of RGSW ciphertexts, in the same order as the input
+    */
+    std::vector<RGSWCiphertext> CircuitBootstrapBatch(const std::vector<LWECiphertext>& ct) const;
+
+    /**
+   * RGSW x RLWE external product of a circuit bootstrapped RGSW ciphertext and an RLWE
+   * ciphertext under the level 2 secret key
+   *
+   * @param ctGSW the RGSW ciphertext
+   * @param ct the RLWE ciphertext
+   * @return an RLWE encryption of the product of both plaintexts, in Format::EVALUATION
+   */
+    RLWECiphertext EvalExternalProduct(ConstRGSWCiphertext& ctGSW, ConstRLWECiphertext& ct) const;
+
+    /**
+   * RGSW x RLWE external product in place; the workspace is reused across calls, so a loop of
+   * products does not allocate. A workspace must not be shared between threads
+   *
+   * @param ctGSW the RGSW ciphertext
+   * @param ct the RLWE ciphertext, replaced by the product in Format::EVALUATION
+   * @param ws scratch polynomials
+   */
+    void EvalExternalProductInPlace(ConstRGSWCiphertext& ctGSW, RLWECiphertext& ct, BlindRotationWorkspace& ws) const;
+
+    /**
+   * CMux of two RLWE ciphertexts selected by a circuit bootstrapped RGSW ciphertext
+   *
+   * @param sel the RGSW encryption of the selector bit
+   * @param ct0 the RLWE ciphertext selected by 0
+   * @param ct1 the RLWE ciphertext selected by 1
+   * @return an RLWE encryption of the plaintext of ct1 if sel encrypts 1 and of ct0 otherwise
+   */
+    RLWECiphertext EvalCMux(ConstRGSWCiphertext& sel, ConstRLWECiphertext& ct0, ConstRLWECiphertext& ct1) const;
+
+    /**
+   * CMux in place, see EvalCMux and EvalExternalProductInPlace
+   *
+   * @param sel the RGSW encryption of the selector bit
+   * @param ct0 the RLWE ciphertext selected by 0, replaced by the result in Format::EVALUATION
+   * @param ct1 the RLWE ciphertext selected by 1
+   * @param ws scratch polynomials
+   */
+    void EvalCMuxInPlace(ConstRGSWCiphertext& sel, RLWECiphertext& ct0, ConstRLWECiphertext& ct1,
+                         BlindRotationWorkspace& ws) const;
+
+    /**
+   * Evaluates a lookup table on circuit bootstrapped bits with a CMux tree and a blind rotation,
+   * see CirBTSScheme::EvalLUT. The bits of the result are read by decrypting it with the level 2
+   * secret key and plaintext modulus 2
+   *
+   * @param sel the RGSW encryptions of the input bits, least significant first, e.g., the output
+   * of CircuitBootstrapBatch
+   * @param table the table, indexed by the input bits; the missing entries are 0
+   * @param numOutputBits the number of output bits, or 0 to use the bit length of the largest entry
+   * @return an RLWE ciphertext whose coefficient t encrypts the bit t of the selected entry
+   */
+    RLWECiphertext EvalLUT(const std::vector<RGSWCiphertext>& sel, const std::vector<uint64_t>& table,
+                           uint32_t numOutputBits = 0) const;
+
+    /**
+   * Turns the stage counters of circuit bootstrapping on or off, see CirBTSPerf. The counters
+   * are process-wide: they cover the calls of all contexts and all threads
+   *
+   * @param enable true to record the stages
+   */
+    void EnablePerfCounters(bool enable = true) const {
+        CirBTSPerf::Enable(enable);
+    }
+
+    /**
+   * Gets the stage counters, the latency histograms and the numbers of NTTs and workspace
+   * allocations recorded since the last reset, summed over all threads
+   */
+    CirBTSPerfStats GetPerfCounters() const {
+        return CirBTSPerf::Collect();
+    }
+
+    /**
+   * Gets the stage counters as a JSON object, see GetPerfCounters
+   */
+    std::string GetPerfCountersJSON() const {
+        return CirBTSPerf::Collect().ToJSON();
+    }
+
+    /**
+   * Zeroes the stage counters, also during an evaluation, see CirBTSPerf::Reset
+   */
+    void ResetPerfCounters() const {
+        CirBTSPerf::Reset();
+    }
+
+    /**
+   * Starts or stops recording the timeline of the stages and their sub-steps on every thread,
+   * see CirBTSTrace; starting drops the previous timeline. The timeline is process-wide
+   *
+   * @param enable true to record the timeline
+   */
+    void EnableTracing(bool enable = true) const {
+        CirBTSTrace::Enable(enable);
+    }
+
+    /**
+   * Writes the timeline recorded so far as Chrome trace-event JSON
+   *
+   * @param os output stream
+   */
+    void WriteTrace(std::ostream& os) const {
+        CirBTSTrace::Write(os);
+    }
+
+    /**
+   * Writes the timeline recorded so far to a file as Chrome trace-event JSON
+   *
+   * @param filename name of the file
+   * @return true on success, false if the file could not be written
+   */
+    bool WriteTraceToFile(const std::string& filename) const {
+        return CirBTSTrace::WriteToFile(filename);
+    }
+
+    /**
+   * Measures the errors of the stages of circuit bootstrapping with the secret keys, for tuning
+   * the gadgets of the parameters; see CirBTSScheme::MeasureNoise. A debugging tool: it needs
+   * the secret keys the circuit bootstrapping keys were generated with
+   *
+   * @param sk the LWE secret key
+   * @param skNTT the RLWE secret key
+   * @param numRuns the number of circuit bootstrappings, evaluated in parallel
+   * @return the error statistics; CirBTSNoiseStats::ToJSON prints them
+   */
+    CirBTSNoiseStats MeasureNoise(ConstLWEPrivateKey& sk, ConstRLWEPrivateKey& skNTT, uint32_t numRuns) const;
+
     /**
    * Getter for params
    * @return
@@ -184,6 +445,29 @@ public:
    */
     void PreCompute();
 
+    template <class Archive>
+    void save(Archive& ar, std::uint32_t const version) const {
+        ar(::cereal::make_nvp("params", m_params));
+    }
+
+    template <class Archive>
+    void load(Archive& ar, std::uint32_t const version) {
+        if (version > SerializedVersion()) {
+            OPENFHE_THROW("serialized object version " + std::to_string(version) +
+                          " is from a later version of the library");
+        }
+        ar(::cereal::make_nvp("params", m_params));
+        m_cirbtsscheme = std::make_shared<CirBTSScheme>(m_params->GetRingGSWParams1()->GetMethod());
+        ClearBTKeys();
+    }
+
+    std::string SerializedObjectName() const override {
+        return "CirBTSContext";
+    }
+    static uint32_t SerializedVersion() {
+        return 1;
+    }
+
 private:
     //Shared pointer to circuit bootstrapping parameters
     std::shared_ptr<CirBTSCryptoParams> m_params{nullptr};
@@ -198,7 +482,7 @@ private:
     std::shared_ptr<CirBTSScheme> m_cirbtsscheme{nullptr};
 
     //Struct contating the bootstrapping keys
-    RingGSWCirBTKey m_BTKey = {0};
+    RingGSWCirBTKey m_BTKey{};
 
 };
 
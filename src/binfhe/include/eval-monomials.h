@@ -0,0 +1,79 @@
+#ifndef _EVAL_MONOMIALS_H_
+#define _EVAL_MONOMIALS_H_
+
+#include "lattice/lat-hal.h"
+
+#include <memory>
+#include <vector>
+
+namespace lbcrypto {
+
+/**
+ * @brief Generates the monomials X^k and X^k - 1 in Format::EVALUATION directly
+ * from the powers of the 2N-th root of unity, instead of storing one NTT-form
+ * polynomial per k
+ */
+class EvalMonomials {
+public:
+    EvalMonomials() = default;
+
+    /**
+   * Precomputes the powers of the 2N-th root of unity and the power held by each slot
+   *
+   * @param polyParams the parameters of the polynomials the monomials are applied to
+   */
+    explicit EvalMonomials(const std::shared_ptr<ILNativeParams>& polyParams);
+
+    /**
+   * Generates X^k in Format::EVALUATION
+   *
+   * @param k the exponent, taken mod 2N
+   * @return the monomial
+   */
+    NativePoly GetMonomial(uint32_t k) const;
+
+    /**
+   * Generates X^k - 1 in Format::EVALUATION
+   *
+   * @param k the exponent, taken mod 2N
+   * @return the monomial minus one
+   */
+    NativePoly GetMonomialMinusOne(uint32_t k) const;
+
+    /**
+   * Multiplies a polynomial in Format::EVALUATION by X^k in place
+   *
+   * @param poly the polynomial
+   * @param k the exponent, taken mod 2N
+   */
+    void MultiplyByMonomial(NativePoly& poly, uint32_t k) const;
+
+    /**
+   * Multiplies a polynomial in Format::EVALUATION by X^k - 1 in place
+   *
+   * @param poly the polynomial
+   * @param k the exponent, taken mod 2N
+   */
+    void MultiplyByMonomialMinusOne(NativePoly& poly, uint32_t k) const;
+
+private:
+    // Parameters for the generated polynomials
+    std::shared_ptr<ILNativeParams> m_polyParams;
+    // 2N - 1, the exponents are reduced mod 2N with this mask
+    uint32_t m_mask{};
+    // m_exps[j]: slot j of X in Format::EVALUATION is psi^m_exps[j]
+    std::vector<uint32_t> m_exps;
+    // psi^t and psi^t - 1 for 0 <= t < 2N, with their precomputed constants for
+    // ModMulFastConst
+    std::vector<NativeInteger> m_powers;
+    std::vector<NativeInteger> m_powersPrecon;
+    std::vector<NativeInteger> m_powersMinusOne;
+    std::vector<NativeInteger> m_powersMinusOnePrecon;
+
+    void MultiplyByTable(NativePoly& poly, uint32_t k, const std::vector<NativeInteger>& table,
+                         const std::vector<NativeInteger>& precon) const;
+};
+
+}  // namespace lbcrypto
+
+#endif
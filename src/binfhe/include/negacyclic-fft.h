@@ -0,0 +1,84 @@
+#ifndef _NEGACYCLIC_FFT_H_
+#define _NEGACYCLIC_FFT_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace lbcrypto {
+
+// A polynomial of Z[X]/(X^N + 1) in the folded FFT domain: the N/2 real parts
+// followed by the N/2 imaginary parts of its slots
+using FFTPoly = std::vector<double>;
+
+/**
+ * @brief Double-precision negacyclic FFT of size N/2. A real polynomial of R[X]/(X^N + 1) is
+ * folded into the N/2 complex coefficients a_j + i*a_{j+N/2} of C[X]/(X^{N/2} - i), twisted by
+ * the powers of the 2N-th root of unity and transformed by a cyclic complex FFT of size N/2, so
+ * that negacyclic products become pointwise products. The slots are left in bit-reversed order,
+ * which the pointwise products do not depend on
+ */
+class NegacyclicFFT {
+public:
+    NegacyclicFFT() = default;
+
+    /**
+   * Precomputes the twisting factors and the twiddle factors of every stage
+   *
+   * @param N the ring dimension, a power of two
+   */
+    explicit NegacyclicFFT(uint32_t N);
+
+    uint32_t GetRingDimension() const {
+        return m_N;
+    }
+
+    /**
+   * Transforms a polynomial with N real coefficients to the FFT domain
+   *
+   * @param in the N coefficients
+   * @param out the transformed polynomial, resized to N doubles
+   */
+    void Forward(const double* in, FFTPoly& out) const;
+
+    /**
+   * Transforms a polynomial with coefficients mod Q to the FFT domain; the coefficients are
+   * centered in (-Q/2, Q/2] first
+   *
+   * @param in the N coefficients in [0, Q)
+   * @param Q the modulus
+   * @param out the transformed polynomial, resized to N doubles
+   */
+    void Forward(const uint64_t* in, uint64_t Q, FFTPoly& out) const;
+
+    /**
+   * Transforms a polynomial with integer coefficients back from the FFT domain and rounds them
+   *
+   * @param in the transformed polynomial, overwritten by the inverse transform
+   * @param out the N coefficients, which must be below 2^51 in absolute value
+   */
+    void Inverse(FFTPoly& in, int64_t* out) const;
+
+    /**
+   * Pointwise product accumulation acc += a * b in the FFT domain
+   *
+   * @param acc the accumulator
+   * @param a the first factor
+   * @param b the second factor
+   */
+    static void MultiplyAdd(FFTPoly& acc, const FFTPoly& a, const FFTPoly& b);
+
+private:
+    // ring dimension
+    uint32_t m_N{};
+    // twisting factors exp(i*pi*j/N) for 0 <= j < N/2
+    std::vector<double> m_twistRe;
+    std::vector<double> m_twistIm;
+    // twiddle factors of the stage with butterflies of half size h at [h, 2h):
+    // exp(-i*pi*j/h) for 0 <= j < h
+    std::vector<double> m_rootRe;
+    std::vector<double> m_rootIm;
+};
+
+}  // namespace lbcrypto
+
+#endif
@@ -15,7 +15,9 @@ public:
     RingGSWAccumulatorCGGI2() = default;
 
     /**
-   * Key generation for internal Ring GSW as described in https://eprint.iacr.org/2018/421.pdf
+   * Key generation for internal Ring GSW as described in https://eprint.iacr.org/2018/421.pdf.
+   * With a key unroll factor u > 1 (see RingGSWCryptoParams::GetKeyUnrollFactor) one key is
+   * generated for each of the 2^u - 1 nonzero bit patterns of every group of u secret coefficients
    *
    * @param params a shared pointer to RingGSW scheme parameters
    * @param skNTT secret key polynomial in the EVALUATION representation
@@ -36,6 +38,57 @@ public:
     void EvalAcc(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCKey& ek, RLWECiphertext& acc,
                  const NativeVector& a) const override;
 
+    /**
+   * Main accumulator function used in bootstrapping - GINX variant, using the caller's
+   * scratch buffers so that the n accumulator updates do not allocate
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param ek the accumulator key
+   * @param acc previous value of the accumulator
+   * @param a value to update the accumulator with
+   * @param ws scratch buffers owned by the calling thread
+   */
+    void EvalAcc(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCKey& ek, RLWECiphertext& acc,
+                 const NativeVector& a, BlindRotationWorkspace& ws) const override;
+
+    /**
+   * Accumulator function for a group of ciphertexts - GINX variant. The loops are interchanged
+   * (key-major order): all accumulators are advanced through the i-th RGSW key before moving to
+   * key i+1, so every refresh key is streamed from memory once per group instead of once per ciphertext
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param ek the accumulator key
+   * @param acc previous values of the accumulators
+   * @param a values to update the accumulators with, a[j] is used for acc[j]
+   */
+    void EvalAccBatch(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCKey& ek,
+                      std::vector<RLWECiphertext>& acc, const std::vector<NativeVector>& a) const override;
+
+    /**
+   * Main accumulator function used in bootstrapping - GINX variant with the refresh key in the
+   * double-precision FFT domain. The accumulator is kept in Format::COEFFICIENT for all n updates
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param ek the accumulator key in the FFT domain
+   * @param acc previous value of the accumulator
+   * @param a value to update the accumulator with
+   * @param ws scratch buffers owned by the calling thread
+   */
+    void EvalAccFFT(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCFFTKey& ek,
+                    RLWECiphertext& acc, const NativeVector& a, BlindRotationWorkspace& ws) const override;
+
+    /**
+   * Accumulator function for a group of ciphertexts - GINX variant with the refresh key in the
+   * double-precision FFT domain, in the same key-major order as EvalAccBatch
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param ek the accumulator key in the FFT domain
+   * @param acc previous values of the accumulators
+   * @param a values to update the accumulators with, a[j] is used for acc[j]
+   */
+    void EvalAccBatchFFT(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCFFTKey& ek,
+                         std::vector<RLWECiphertext>& acc, const std::vector<NativeVector>& a) const override;
+
 private:
     /**
    * Key generation for internal Ring GSW as described in https://eprint.iacr.org/2020/086
@@ -50,15 +103,57 @@ private:
 
     /**
    * CGGI Accumulation as described in https://eprint.iacr.org/2020/086
-   * with ternary MUX introduced in paper https://eprint.iacr.org/2022/074.pdf section 5
+   * with ternary MUX introduced in paper https://eprint.iacr.org/2022/074.pdf section 5,
+   * for one group of key unrolled secret coefficients
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param ek evaluation keys for Ring GSW, ek[k][g] is the key of bit pattern k + 1 of group g
+   * @param g index of the group
+   * @param exps exponents of the monomials X^exps[k] - 1 of the bit patterns of the group
+   * @param acc previous value of the accumulator
+   * @param ws scratch buffers owned by the calling thread
+   */
+    void AddToAccCGGI(const std::shared_ptr<RingGSWCryptoParams>& params,
+                      const std::vector<std::vector<RingGSWEvalKey>>& ek, uint32_t g,
+                      const std::vector<uint32_t>& exps, RLWECiphertext& acc, BlindRotationWorkspace& ws) const;
+
+    /**
+   * CGGI Accumulation with the external product evaluated in the double-precision FFT domain,
+   * for one group of key unrolled secret coefficients; the accumulator is in Format::COEFFICIENT
    *
    * @param params a shared pointer to RingGSW scheme parameters
-   * @param ek evaluation keys for Ring GSW
-   * @param a a value to add to the accumulator
+   * @param ek the refresh key in the FFT domain
+   * @param g index of the group
+   * @param exps exponents of the monomials X^exps[k] - 1 of the bit patterns of the group
    * @param acc previous value of the accumulator
+   * @param ws scratch buffers owned by the calling thread
+   */
+    void AddToAccCGGIFFT(const std::shared_ptr<RingGSWCryptoParams>& params, const RingGSWACCFFTKeyImpl& ek,
+                         uint32_t g, const std::vector<uint32_t>& exps, RLWECiphertext& acc,
+                         BlindRotationWorkspace& ws) const;
+
+    /**
+   * Checks that the shape of the refresh key matches the key unroll factor of the parameters
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param numPatterns number of keys per group in the refresh key
+   * @param numGroups number of groups in the refresh key
+   * @param n LWE dimension
+   * @return the number of groups
+   */
+    uint32_t CheckUnrolledKey(const std::shared_ptr<RingGSWCryptoParams>& params, uint32_t numPatterns,
+                              uint32_t numGroups, uint32_t n) const;
+
+    /**
+   * Computes the exponents of the monomials of the 2^u - 1 nonzero bit patterns of a group
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param a the LWE vector (mod q)
+   * @param g index of the group
+   * @param exps the exponents mod 2N, exps[k - 1] is the sum of the a_{g * u + j} * 2N / q with bit j set in k
    */
-    void AddToAccCGGI(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWEvalKey& ek,
-                     const NativeInteger& a, RLWECiphertext& acc) const;
+    void GroupExponents(const std::shared_ptr<RingGSWCryptoParams>& params, const NativeVector& a, uint32_t g,
+                        std::vector<uint32_t>& exps) const;
 
     /**
    * The signed digit decomposition which takes an RLWE ciphertext input and outputs a vector of its digits, i.e., an
@@ -67,9 +162,11 @@ private:
    * @param params a shared pointer to RingGSW scheme parameters
    * @param input input RLWE ciphertext
    * @param output output RLWE' ciphertext
+   * @param format the format of the output digits; EVALUATION transforms each digit as it is produced
    */
     void SignedDigitDecompose2(const std::shared_ptr<RingGSWCryptoParams>& params, const std::vector<NativePoly>& input,
-                              std::vector<NativePoly>& output) const;
+                              std::vector<NativePoly>& output,
+                              Format format = Format::COEFFICIENT) const;
 };
 
 };  // namespace lbcrypto
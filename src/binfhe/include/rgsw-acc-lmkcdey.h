@@ -35,6 +35,7 @@
 #include "rgsw-acc.h"
 
 #include <memory>
+#include <vector>
 
 namespace lbcrypto {
 
@@ -58,7 +59,8 @@ public:
                             ConstLWEPrivateKey& LWEsk) const override;
 
     /**
-   * Main accumulator function used in bootstrapping - LMKCDEY variant
+   * Main accumulator function used in bootstrapping - LMKCDEY variant. The automorphisms of an
+   * accumulator whose first component is zero skip the key switching until the first product
    *
    * @param params a shared pointer to RingGSW scheme parameters
    * @param ek the accumulator key
@@ -68,6 +70,29 @@ public:
     void EvalAcc(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCKey& ek, RLWECiphertext& acc,
                  const NativeVector& a) const override;
 
+    /**
+   * Generates the key RGSW(X^{-sum_i s_i}) that removes the offset of the round-to-odd in EvalAcc
+   * when every entry of a is even: acc is then rotated by sum_i (1 - a_i) * s_i, and the offset
+   * sum_i s_i is independent of a
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param skNTT secret key polynomial in the EVALUATION representation
+   * @param LWEsk the secret key
+   * @return a shared pointer to the resulting key
+   */
+    RingGSWEvalKey KeyGenRoundToOdd(const std::shared_ptr<RingGSWCryptoParams>& params, const NativePoly& skNTT,
+                                    ConstLWEPrivateKey& LWEsk) const;
+
+    /**
+   * Removes the offset of the round-to-odd from the result of EvalAcc for an even vector a
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param ek the key generated by KeyGenRoundToOdd
+   * @param acc the accumulator after EvalAcc
+   */
+    void EvalRoundToOdd(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWEvalKey& ek,
+                        RLWECiphertext& acc) const;
+
 private:
     /**
    * LMKCDEY Key generation for internal Ring GSW as described in https://eprint.iacr.org/2022/198
@@ -97,10 +122,11 @@ private:
    * @param params a shared pointer to RingGSW scheme parameters
    * @param ek evaluation key for Ring GSW
    * @param acc previous value of the accumulator
+   * @param ws scratch polynomials of the blind rotation
    * @return
    */
     void AddToAccLMKCDEY(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWEvalKey& ek,
-                         RLWECiphertext& acc) const;
+                         RLWECiphertext& acc, BlindRotationWorkspace& ws) const;
 
     /**
    * LMKCDEY Accumulation automorphism evaluation as described in https://eprint.iacr.org/2022/198
@@ -109,10 +135,29 @@ private:
    * @param a index
    * @param ak evaluation key for Ring GSW
    * @param acc previous value of the accumulator
+   * @param ws scratch polynomials of the blind rotation
+   * @param isTrivial acc is (0, b), so the key switching is skipped
    * @return
    */
-    void Automorphism(const std::shared_ptr<RingGSWCryptoParams>& params, const NativeInteger& a,
-                      ConstRingGSWEvalKey& ak, RLWECiphertext& acc) const;
+    void Automorphism(const std::shared_ptr<RingGSWCryptoParams>& params, uint32_t a, ConstRingGSWEvalKey& ak,
+                      RLWECiphertext& acc, BlindRotationWorkspace& ws, bool isTrivial) const;
+
+    /**
+   * One sweep of the LMKCDEY schedule over the discrete logs N/2 - 1, ..., 1: the products of
+   * the keys of every nonempty bucket are accumulated, and the automorphisms between them are
+   * merged up to the window of numAutoKeys
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param ek the accumulator key
+   * @param order the indices of a sorted by bucket
+   * @param offsets offsets[i] is the start in order of the bucket of discrete log i
+   * @param acc previous value of the accumulator
+   * @param ws scratch polynomials of the blind rotation
+   * @param isTrivial acc is (0, b); cleared by the first product
+   */
+    void EvalSweep(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCKey& ek,
+                   const std::vector<uint32_t>& order, const uint32_t* offsets, RLWECiphertext& acc,
+                   BlindRotationWorkspace& ws, bool& isTrivial) const;
 };
 
 }  // namespace lbcrypto
@@ -34,13 +34,126 @@
 
 #include "rlwe-ciphertext.h"
 #include "rgsw-acckey.h"
+#include "rgsw-fftkey.h"
 #include "rgsw-cryptoparameters.h"
+#include "cirbts-perf.h"
 
+#include <algorithm>
+#include <list>
 #include <vector>
 #include <memory>
 
 namespace lbcrypto {
 
+/**
+ * @brief Scratch polynomials reused across the steps of a blind rotation, so that the
+ * accumulator update does not allocate. The buffers are kept per shape, so that a workspace
+ * shared by steps with different gadgets, e.g., the MV-FBS and the external products of a
+ * circuit, does not reallocate when the shape alternates. A workspace is not thread-safe: every
+ * thread running an accumulator needs its own
+ */
+class BlindRotationWorkspace {
+public:
+    BlindRotationWorkspace() = default;
+
+    /**
+   * Selects the buffers of a shape, and allocates them the first time the shape is requested.
+   * The references returned by GetCt, GetDigits and GetProducts are valid until the next Reserve
+   *
+   * @param polyParams parameters of the accumulator polynomials
+   * @param numDigits number of digit polynomials of the decomposed accumulator
+   * @param numProducts number of product polynomials
+   */
+    void Reserve(const std::shared_ptr<ILNativeParams>& polyParams, uint32_t numDigits, uint32_t numProducts = 3) {
+        auto it = std::find_if(m_buffers.begin(), m_buffers.end(), [&](const PolyBuffers& b) {
+            return b.dct.size() == numDigits && (b.polyParams == polyParams || *b.polyParams == *polyParams);
+        });
+        if (it == m_buffers.end()) {
+            // the least recently used shape is dropped, a workspace rarely sees more than two
+            if (m_buffers.size() == MAX_SHAPES)
+                m_buffers.pop_back();
+            NativePoly zero(polyParams, Format::COEFFICIENT, true);
+            m_buffers.push_front(PolyBuffers{polyParams, std::vector<NativePoly>(2, zero),
+                                             std::vector<NativePoly>(numDigits, zero),
+                                             std::vector<NativePoly>(numProducts, zero)});
+            CirBTSPerf::CountAllocations(2 + numDigits + numProducts);
+            return;
+        }
+        if (it != m_buffers.begin())
+            m_buffers.splice(m_buffers.begin(), m_buffers, it);
+        auto& prod = m_buffers.front().prod;
+        if (prod.size() < numProducts) {
+            CirBTSPerf::CountAllocations(numProducts - prod.size());
+            prod.resize(numProducts, NativePoly(polyParams, Format::COEFFICIENT, true));
+        }
+    }
+
+    // copy of the accumulator used for the format conversion
+    std::vector<NativePoly>& GetCt() {
+        return m_buffers.front().ct;
+    }
+
+    // digits of the decomposed accumulator
+    std::vector<NativePoly>& GetDigits() {
+        return m_buffers.front().dct;
+    }
+
+    // product accumulators and temporary products
+    std::vector<NativePoly>& GetProducts() {
+        return m_buffers.front().prod;
+    }
+
+    /**
+   * Allocates the buffers of the FFT external product backend; does nothing if they already
+   * have the requested shape
+   *
+   * @param N ring dimension
+   * @param numDigits number of digit polynomials of the decomposed accumulator
+   * @param numLimbs number of limbs of the refresh key in the FFT domain
+   * @param numProducts number of products (RLWE component and key pairs) evaluated at once
+   */
+    void ReserveFFT(uint32_t N, uint32_t numDigits, uint32_t numLimbs, uint32_t numProducts) {
+        if (m_limbs.size() == numProducts * numLimbs * N && m_fftDigits.size() == numDigits)
+            return;
+        m_limbs.assign(numProducts * numLimbs * N, 0);
+        m_fftDigits.assign(numDigits, FFTPoly(N));
+        m_fftProd.assign(numProducts * numLimbs, FFTPoly(N));
+        CirBTSPerf::CountAllocations(1 + m_fftDigits.size() + m_fftProd.size());
+    }
+
+    // rounded coefficients of the limb products, limb l of product t at [(t * numLimbs + l) * N, ...)
+    std::vector<int64_t>& GetLimbs() {
+        return m_limbs;
+    }
+
+    // digits of the decomposed accumulator in the FFT domain
+    std::vector<FFTPoly>& GetFFTDigits() {
+        return m_fftDigits;
+    }
+
+    // products in the FFT domain, limb l of product t at t * numLimbs + l
+    std::vector<FFTPoly>& GetFFTProducts() {
+        return m_fftProd;
+    }
+
+private:
+    // the number of shapes whose buffers are kept
+    static constexpr size_t MAX_SHAPES = 4;
+
+    struct PolyBuffers {
+        std::shared_ptr<ILNativeParams> polyParams;
+        std::vector<NativePoly> ct;
+        std::vector<NativePoly> dct;
+        std::vector<NativePoly> prod;
+    };
+
+    // the buffers of the shapes, the one selected by the last Reserve first
+    std::list<PolyBuffers> m_buffers;
+    std::vector<int64_t> m_limbs;
+    std::vector<FFTPoly> m_fftDigits;
+    std::vector<FFTPoly> m_fftProd;
+};
+
 /**
  * @brief Ring GSW accumulator schemes described in
  * https://eprint.iacr.org/2014/816, https://eprint.iacr.org/2020/086 and https://eprint.iacr.org/2022/198
@@ -75,6 +188,60 @@ public:
         OPENFHE_THROW("ACC operation not supported");
     }
 
+    /**
+   * Main accumulator function used in bootstrapping, using the caller's scratch buffers.
+   * The default implementation ignores the workspace
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param ek the accumulator key
+   * @param acc previous value of the accumulator
+   * @param a value to update the accumulator with
+   * @param ws scratch buffers owned by the calling thread
+   */
+    virtual void EvalAcc(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCKey& ek,
+                         RLWECiphertext& acc, const NativeVector& a, BlindRotationWorkspace& ws) const {
+        EvalAcc(params, ek, acc, a);
+    }
+
+    /**
+   * Accumulator function for a group of ciphertexts that share the same accumulator key. The default
+   * implementation evaluates the accumulators independently, one per thread
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param ek the accumulator key
+   * @param acc previous values of the accumulators
+   * @param a values to update the accumulators with, a[j] is used for acc[j]
+   */
+    virtual void EvalAccBatch(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCKey& ek,
+                              std::vector<RLWECiphertext>& acc, const std::vector<NativeVector>& a) const;
+
+    /**
+   * Main accumulator function used in bootstrapping with the refresh key in the double-precision
+   * FFT domain
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param ek the accumulator key in the FFT domain
+   * @param acc previous value of the accumulator
+   * @param a value to update the accumulator with
+   * @param ws scratch buffers owned by the calling thread
+   */
+    virtual void EvalAccFFT(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCFFTKey& ek,
+                            RLWECiphertext& acc, const NativeVector& a, BlindRotationWorkspace& ws) const {
+        OPENFHE_THROW("FFT ACC operation not supported");
+    }
+
+    /**
+   * Accumulator function for a group of ciphertexts with the refresh key in the double-precision
+   * FFT domain. The default implementation evaluates the accumulators independently, one per thread
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param ek the accumulator key in the FFT domain
+   * @param acc previous values of the accumulators
+   * @param a values to update the accumulators with, a[j] is used for acc[j]
+   */
+    virtual void EvalAccBatchFFT(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCFFTKey& ek,
+                                 std::vector<RLWECiphertext>& acc, const std::vector<NativeVector>& a) const;
+
     /**
    * The signed digit decomposition which takes an RLWE ciphertext input and outputs a vector of its digits, i.e., an
    * RLWE' ciphertext
@@ -82,9 +249,11 @@ public:
    * @param params a shared pointer to RingGSW scheme parameters
    * @param input input RLWE ciphertext
    * @param output output RLWE' ciphertext
+   * @param format the format of the output digits; EVALUATION transforms each digit as it is produced
    */
     void SignedDigitDecompose(const std::shared_ptr<RingGSWCryptoParams>& params, const std::vector<NativePoly>& input,
-                              std::vector<NativePoly>& output) const;
+                              std::vector<NativePoly>& output,
+                              Format format = Format::COEFFICIENT) const;
 
     /**
    * The signed digit decomposition which takes a ring element input and outputs a vector of its digits, i.e.,
@@ -94,9 +263,11 @@ public:
    * @param params a shared pointer to RingGSW scheme parameters
    * @param input input ring element
    * @param output decomposed value
+   * @param format the format of the output digits; EVALUATION transforms each digit as it is produced
    */
     void SignedDigitDecompose(const std::shared_ptr<RingGSWCryptoParams>& params, const NativePoly& input,
-                              std::vector<NativePoly>& output) const;
+                              std::vector<NativePoly>& output,
+                              Format format = Format::COEFFICIENT) const;
 };
 }  // namespace lbcrypto
 
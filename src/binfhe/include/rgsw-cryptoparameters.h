@@ -39,6 +39,9 @@
 #include "utils/utilities.h"
 
 #include "binfhe-constants.h"
+#include "automorphism-plan.h"
+#include "eval-monomials.h"
+#include "negacyclic-fft.h"
 
 #include "lwe-ciphertext.h"
 #include "lwe-keyswitchkey.h"
@@ -147,6 +150,14 @@ public:
         return m_Gpower;
     }
 
+    /**
+   * Number of least significant bits dropped by the approximate decomposition,
+   * i.e., the bit length of Q minus digitsGA * log2(baseG)
+   */
+    uint32_t GetIgnoreBitsGA() const {
+        return m_ignoreBitsGA;
+    }
+
     const std::vector<NativeInteger>& GetAGPower() const {
         return m_AGpower;
     }
@@ -155,6 +166,43 @@ public:
         return m_logGen;
     }
 
+    /**
+   * Returns the powers 5^k (mod 2N) of the generator for 0 <= k < N/2 (only for LMKCDEY)
+   */
+    const std::vector<uint32_t>& GetGenPowers() const {
+        return m_genPowers;
+    }
+
+    /**
+   * Chooses the number of automorphism keys (the window size) of the LMKCDEY blind rotation.
+   * Every automorphism key saves key switching automorphisms wherever the discrete logs of the
+   * entries of a leave a gap longer than the window; the expected number of key switching
+   * automorphisms of one blind rotation is computed for every window size, and an extra key is
+   * only taken if it saves at least keyCost of them
+   *
+   * @param N ring dimension
+   * @param n LWE dimension
+   * @param logStep the entries of a are uniform multiples of 2^logStep (mod 2N)
+   * @param keyCost number of automorphisms per blind rotation an extra key has to save
+   * @param maxKeys largest number of automorphism keys considered
+   * @return the number of automorphism keys
+   */
+    static uint32_t ChooseNumAutoKeys(uint32_t N, uint32_t n, uint32_t logStep = 0, double keyCost = 1.0,
+                                      uint32_t maxKeys = 64);
+
+    /**
+   * Returns the precomputed plan of the automorphism X -> X^k (only for LMKCDEY)
+   *
+   * @param k automorphism index, 5^i (mod 2N) for 1 <= i <= numAutoKeys or -5 (mod 2N)
+   * @return the automorphism plan
+   */
+    const AutomorphismPlan& GetAutoPlan(uint32_t k) const {
+        auto it = m_autoPlans.find(k);
+        if (it == m_autoPlans.end())
+            OPENFHE_THROW("no precomputed automorphism plan for index " + std::to_string(k));
+        return it->second;
+    }
+
     const std::map<uint32_t, std::vector<NativeInteger>>& GetGPowerMap() const {
         return m_Gpower_map;
     }
@@ -167,8 +215,76 @@ public:
         return m_gateConst;
     }
 
-    const NativePoly& GetMonomial(uint32_t i) const {
-        return m_monomials[i];
+    /**
+   * Returns the generator of the monomials X^m - 1 in Format::EVALUATION
+   * (used only for CGGI bootstrapping)
+   */
+    const EvalMonomials& GetMonomials() const {
+        return m_monomials;
+    }
+
+    /**
+   * Number u of secret coefficients processed by one step of the CGGI blind rotation; the
+   * refresh key holds 2^u - 1 RGSW keys per group of u coefficients (used only for CGGI bootstrapping)
+   */
+    uint32_t GetKeyUnrollFactor() const {
+        return m_keyUnroll;
+    }
+
+    /**
+   * Sets the key unroll factor; the refresh key has to be generated after the change
+   *
+   * @param unroll 1 (no unrolling), 2 or 3
+   */
+    void SetKeyUnrollFactor(uint32_t unroll) {
+        if (unroll < 1 || unroll > 3)
+            OPENFHE_THROW(config_error, "the key unroll factor should be 1, 2 or 3");
+        if (unroll > 1 && m_method != GINX)
+            OPENFHE_THROW(config_error, "key unrolling is only supported for the GINX method");
+        m_keyUnroll = unroll;
+    }
+
+    /**
+   * Returns the double-precision negacyclic FFT used by the FFT external product backend
+   * (used only for CGGI bootstrapping)
+   */
+    const NegacyclicFFT& GetFFT() const {
+        return m_fft;
+    }
+
+    /**
+   * Number of bits of the limbs the refresh key coefficients are split into in the FFT domain,
+   * chosen so that a blind rotation rounds all the decomposed products to the right integers
+   * except with probability below 2^-40, see GetFFTLog2FailureRate
+   */
+    uint32_t GetFFTLimbBits() const {
+        return m_fftLimbBits;
+    }
+
+    /**
+   * Number of limbs of the refresh key coefficients in the FFT domain
+   */
+    uint32_t GetFFTNumLimbs() const {
+        return m_fftNumLimbs;
+    }
+
+    /**
+   * Bound on log2 of the probability that the FFT rounds a product of a blind rotation to a
+   * wrong integer, for n <= N steps and any key unrolling; 0 when numLimbs is 0
+   */
+    double GetFFTLog2FailureRate() const {
+        return m_fftLog2FailureRate;
+    }
+
+    /**
+   * Weights 2^(l * limbBits) of the limbs, with their precomputed constants for ModMulFastConst
+   */
+    const std::vector<NativeInteger>& GetFFTLimbPowers() const {
+        return m_fftLimbPowers;
+    }
+
+    const std::vector<NativeInteger>& GetFFTLimbPowersPrecon() const {
+        return m_fftLimbPowersPrecon;
     }
 
     BINFHE_METHOD GetMethod() const {
@@ -199,6 +315,9 @@ public:
         ar(::cereal::make_nvp("bdigitsG", m_digitsG));
         ar(::cereal::make_nvp("bparams", m_polyParams));
         ar(::cereal::make_nvp("numAutoKeys", m_numAutoKeys));
+        ar(::cereal::make_nvp("bdigitsGA", m_digitsGA));
+        ar(::cereal::make_nvp("keyDist", m_keyDist));
+        ar(::cereal::make_nvp("keyUnroll", m_keyUnroll));
     }
 
     template <class Archive>
@@ -219,6 +338,11 @@ public:
         ar(::cereal::make_nvp("bdigitsG", m_digitsG));
         ar(::cereal::make_nvp("bparams", m_polyParams));
         ar(::cereal::make_nvp("numAutoKeys", m_numAutoKeys));
+        if (version > 1) {
+            ar(::cereal::make_nvp("bdigitsGA", m_digitsGA));
+            ar(::cereal::make_nvp("keyDist", m_keyDist));
+            ar(::cereal::make_nvp("keyUnroll", m_keyUnroll));
+        }
 
         PreCompute();
     }
@@ -227,7 +351,7 @@ public:
         return "RingGSWCryptoParams";
     }
     static uint32_t SerializedVersion() {
-        return 1;
+        return 2;
     }
 
     void Change_BaseG(uint32_t BaseG) {
@@ -261,6 +385,9 @@ private:
     // number of digits in decomposing integers mod Q
     uint32_t m_digitsG{};
 
+    // number of least significant bits dropped by the approximate decomposition
+    uint32_t m_ignoreBitsGA{};
+
     // powers of m_baseR (used only for DM bootstrapping)
     std::vector<NativeInteger> m_digitsR;
 
@@ -275,6 +402,12 @@ private:
     // m_logGen[-1 (mod M)] = M (special case for efficiency)
     std::vector<int32_t> m_logGen;
 
+    // m_genPowers[k] = 5^k (mod M) for 0 <= k < N/2 (only for LMKCDEY)
+    std::vector<uint32_t> m_genPowers;
+
+    // Precomputed automorphism plans for the generator powers (only for LMKCDEY)
+    std::map<uint32_t, AutomorphismPlan> m_autoPlans;
+
     // Error distribution generator
     DiscreteGaussianGeneratorImpl<NativeVector> m_dgg;
 
@@ -290,9 +423,21 @@ private:
     // Constants used in evaluating binary gates
     std::vector<NativeInteger> m_gateConst;
 
-    // Precomputed polynomials in Format::EVALUATION representation for X^m - 1
+    // Generator of the polynomials X^m - 1 in Format::EVALUATION representation
     // (used only for CGGI bootstrapping)
-    std::vector<NativePoly> m_monomials;
+    EvalMonomials m_monomials;
+
+    // number of secret coefficients per step of the CGGI blind rotation
+    uint32_t m_keyUnroll{1};
+
+    // Double-precision negacyclic FFT and the limb split of the refresh key for the
+    // FFT external product backend (used only for CGGI bootstrapping)
+    NegacyclicFFT m_fft;
+    uint32_t m_fftLimbBits{};
+    uint32_t m_fftNumLimbs{};
+    double m_fftLog2FailureRate{};
+    std::vector<NativeInteger> m_fftLimbPowers;
+    std::vector<NativeInteger> m_fftLimbPowersPrecon;
 
     // Bootstrapping method (DM or CGGI or LMKCDEY)
     BINFHE_METHOD m_method{BINFHE_METHOD::INVALID_METHOD};
@@ -36,6 +36,7 @@
 #include "lwe-keyswitchkey.h"
 #include "lwe-privatekey.h"
 #include "lwe-cryptoparameters.h"
+#include "seeded-uniform.h"
 
 #include "lattice/lat-hal.h"
 #include "math/discretegaussiangenerator.h"
@@ -43,6 +44,8 @@
 #include "utils/serializable.h"
 #include "utils/utilities.h"
 
+#include <algorithm>
+#include <cassert>
 #include <memory>
 #include <string>
 #include <utility>
@@ -68,26 +71,117 @@ public:
 
     explicit RingGSWEvalKeyImpl(const std::vector<std::vector<NativePoly>>& elements) : m_elements(elements) {}
 
-    RingGSWEvalKeyImpl(const RingGSWEvalKeyImpl& rhs) : m_elements(rhs.m_elements) {}
+    /**
+   * Creates a read-only view of a key stored outside of the object, e.g., in a memory-mapped
+   * file: the element (i, j) is given by the N coefficients in Format::EVALUATION starting at
+   * data + (i * colSize + j) * N. Views are only accessed through GetElementData
+   *
+   * @param rowSize number of rows
+   * @param colSize number of columns
+   * @param polyParams parameters of the ring of the elements
+   * @param data the coefficients of the elements
+   * @param owner keeps the buffer of the coefficients alive as long as the view exists
+   */
+    RingGSWEvalKeyImpl(uint32_t rowSize, uint32_t colSize, const std::shared_ptr<ILNativeParams>& polyParams,
+                       const NativeInteger* data, std::shared_ptr<const void> owner)
+        : m_view(data),
+          m_viewOwner(std::move(owner)),
+          m_viewParams(polyParams),
+          m_viewRows(rowSize),
+          m_viewCols(colSize) {}
+
+    RingGSWEvalKeyImpl(const RingGSWEvalKeyImpl& rhs)
+        : m_elements(rhs.m_elements),
+          m_seeds(rhs.m_seeds),
+          m_view(rhs.m_view),
+          m_viewOwner(rhs.m_viewOwner),
+          m_viewParams(rhs.m_viewParams),
+          m_viewRows(rhs.m_viewRows),
+          m_viewCols(rhs.m_viewCols) {}
 
-    RingGSWEvalKeyImpl(RingGSWEvalKeyImpl&& rhs) noexcept : m_elements(std::move(rhs.m_elements)) {}
+    RingGSWEvalKeyImpl(RingGSWEvalKeyImpl&& rhs) noexcept
+        : m_elements(std::move(rhs.m_elements)),
+          m_seeds(std::move(rhs.m_seeds)),
+          m_view(rhs.m_view),
+          m_viewOwner(std::move(rhs.m_viewOwner)),
+          m_viewParams(std::move(rhs.m_viewParams)),
+          m_viewRows(rhs.m_viewRows),
+          m_viewCols(rhs.m_viewCols) {}
 
     RingGSWEvalKeyImpl& operator=(const RingGSWEvalKeyImpl& rhs) {
-        RingGSWEvalKeyImpl::m_elements = rhs.m_elements;
+        RingGSWEvalKeyImpl::m_elements   = rhs.m_elements;
+        RingGSWEvalKeyImpl::m_seeds      = rhs.m_seeds;
+        RingGSWEvalKeyImpl::m_view       = rhs.m_view;
+        RingGSWEvalKeyImpl::m_viewOwner  = rhs.m_viewOwner;
+        RingGSWEvalKeyImpl::m_viewParams = rhs.m_viewParams;
+        RingGSWEvalKeyImpl::m_viewRows   = rhs.m_viewRows;
+        RingGSWEvalKeyImpl::m_viewCols   = rhs.m_viewCols;
         return *this;
     }
 
     RingGSWEvalKeyImpl& operator=(RingGSWEvalKeyImpl&& rhs) noexcept {
-        RingGSWEvalKeyImpl::m_elements = std::move(rhs.m_elements);
+        RingGSWEvalKeyImpl::m_elements   = std::move(rhs.m_elements);
+        RingGSWEvalKeyImpl::m_seeds      = std::move(rhs.m_seeds);
+        RingGSWEvalKeyImpl::m_view       = rhs.m_view;
+        RingGSWEvalKeyImpl::m_viewOwner  = std::move(rhs.m_viewOwner);
+        RingGSWEvalKeyImpl::m_viewParams = std::move(rhs.m_viewParams);
+        RingGSWEvalKeyImpl::m_viewRows   = rhs.m_viewRows;
+        RingGSWEvalKeyImpl::m_viewCols   = rhs.m_viewCols;
         return *this;
     }
 
+    /**
+   * Gets the elements of the key; not available for views
+   */
     const std::vector<std::vector<NativePoly>>& GetElements() const {
+        if (IsView())
+            OPENFHE_THROW("the elements of an RGSW key view are only accessible through GetElementData");
         return m_elements;
     }
 
+    /**
+   * Returns true if the key is a read-only view of an external buffer
+   */
+    bool IsView() const {
+        return m_view != nullptr;
+    }
+
+    uint32_t GetRowSize() const {
+        return IsView() ? m_viewRows : m_elements.size();
+    }
+
+    uint32_t GetColSize() const {
+        if (IsView())
+            return m_viewCols;
+        return m_elements.empty() ? 0 : m_elements[0].size();
+    }
+
+    /**
+   * Gets the coefficients of the element (i, j) in Format::EVALUATION, both for owned keys and
+   * for views
+   */
+    const NativeInteger* GetElementData(uint32_t i, uint32_t j) const {
+        if (IsView())
+            return m_view + (static_cast<size_t>(i) * m_viewCols + j) * m_viewParams->GetRingDimension();
+        assert(m_elements[i][j].GetFormat() == Format::EVALUATION);
+        return &m_elements[i][j][0];
+    }
+
     void SetElements(const std::vector<std::vector<NativePoly>>& elements) {
         m_elements = elements;
+        m_seeds.clear();
+    }
+
+    /**
+   * Gets the seeds of the key: the element (i, 0) is SeededUniformGenerator::Expand of the
+   * i-th seed; empty if the key is not seeded
+   */
+    const std::vector<PolySeed>& GetSeeds() const {
+        return m_seeds;
+    }
+
+    void SetSeeds(std::vector<PolySeed>&& seeds) {
+        m_seeds = std::move(seeds);
     }
 
     /**
@@ -95,6 +189,13 @@ public:
    * representations using NTT
    */
     void SetFormat(const Format format) {
+        if (IsView()) {
+            if (format != Format::EVALUATION)
+                OPENFHE_THROW("an RGSW key view is read-only");
+            return;
+        }
+        if (format != Format::EVALUATION)
+            m_seeds.clear();
         for (size_t i = 0; i < m_elements.size(); ++i) {
             auto& l1 = m_elements[i];
             for (size_t j = 0; j < l1.size(); ++j)
@@ -102,15 +203,24 @@ public:
         }
     }
 
+    /**
+   * Gets a row of the key; not available for views
+   */
     std::vector<NativePoly>& operator[](uint32_t i) {
+        if (IsView())
+            OPENFHE_THROW("an RGSW key view is read-only");
         return m_elements[i];
     }
 
     const std::vector<NativePoly>& operator[](uint32_t i) const {
+        if (IsView())
+            OPENFHE_THROW("the elements of an RGSW key view are only accessible through GetElementData");
         return m_elements[i];
     }
 
     bool operator==(const RingGSWEvalKeyImpl& other) const {
+        if (IsView() || other.IsView())
+            return EqualElementData(other);
         if (m_elements.size() != other.m_elements.size())
             return false;
         for (size_t i = 0; i < m_elements.size(); ++i) {
@@ -132,6 +242,10 @@ public:
 
     template <class Archive>
     void save(Archive& ar, std::uint32_t const version) const {
+        if (IsView()) {
+            ar(::cereal::make_nvp("elements", CopyViewElements()));
+            return;
+        }
         ar(::cereal::make_nvp("elements", m_elements));
     }
 
@@ -152,9 +266,93 @@ public:
     }
 
 private:
+    // compares the coefficients of the elements in Format::EVALUATION when either key is a view
+    bool EqualElementData(const RingGSWEvalKeyImpl& other) const {
+        uint32_t rows{GetRowSize()};
+        uint32_t cols{GetColSize()};
+        if (rows != other.GetRowSize() || cols != other.GetColSize())
+            return false;
+        for (uint32_t i = 0; i < rows; ++i) {
+            for (uint32_t j = 0; j < cols; ++j) {
+                if (!IsEvaluationElement(i, j) || !other.IsEvaluationElement(i, j))
+                    return false;
+                uint32_t N{IsView() ? m_viewParams->GetRingDimension() : m_elements[i][j].GetLength()};
+                if (N != (other.IsView() ? other.m_viewParams->GetRingDimension() : other.m_elements[i][j].GetLength()))
+                    return false;
+                const NativeInteger* a{GetElementData(i, j)};
+                if (!std::equal(a, a + N, other.GetElementData(i, j)))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    bool IsEvaluationElement(uint32_t i, uint32_t j) const {
+        return IsView() || (m_elements[i].size() > j && m_elements[i][j].GetFormat() == Format::EVALUATION);
+    }
+
+    std::vector<std::vector<NativePoly>> CopyViewElements() const {
+        uint32_t N{m_viewParams->GetRingDimension()};
+        std::vector<std::vector<NativePoly>> elements(m_viewRows, std::vector<NativePoly>(m_viewCols));
+        for (uint32_t i = 0; i < m_viewRows; ++i) {
+            for (uint32_t j = 0; j < m_viewCols; ++j) {
+                NativePoly poly(m_viewParams, Format::EVALUATION, true);
+                const NativeInteger* data{GetElementData(i, j)};
+                std::copy(data, data + N, &poly[0]);
+                elements[i][j] = std::move(poly);
+            }
+        }
+        return elements;
+    }
+
     std::vector<std::vector<NativePoly>> m_elements;
+    // seeds of the uniformly random elements (i, 0), empty if the key is not seeded
+    std::vector<PolySeed> m_seeds;
+    // external coefficients of a view and the object keeping them alive
+    const NativeInteger* m_view{nullptr};
+    std::shared_ptr<const void> m_viewOwner;
+    std::shared_ptr<ILNativeParams> m_viewParams;
+    uint32_t m_viewRows{0};
+    uint32_t m_viewCols{0};
 };
 
+/**
+ * a *= b for an element b of an RGSW key given by its coefficients (see
+ * RingGSWEvalKeyImpl::GetElementData); a is in Format::EVALUATION
+ */
+inline void MultiplyKeyElement(NativePoly& a, const NativeInteger* b) {
+    const auto& q{a.GetModulus()};
+    uint32_t N{a.GetLength()};
+    NativeInteger* av{&a[0]};
+#ifdef NATIVEINT_BARRET_MOD
+    auto mu{q.ComputeMu()};
+    for (uint32_t k = 0; k < N; ++k)
+        av[k].ModMulFastEq(b[k], q, mu);
+#else
+    for (uint32_t k = 0; k < N; ++k)
+        av[k].ModMulFastEq(b[k], q);
+#endif
+}
+
+/**
+ * acc += a * b for an element b of an RGSW key given by its coefficients, without the
+ * temporary copy of a; a and acc are in Format::EVALUATION
+ */
+inline void MultiplyAddKeyElement(const NativePoly& a, const NativeInteger* b, NativePoly& acc) {
+    const auto& q{acc.GetModulus()};
+    uint32_t N{acc.GetLength()};
+    const NativeInteger* av{&a[0]};
+    NativeInteger* accv{&acc[0]};
+#ifdef NATIVEINT_BARRET_MOD
+    auto mu{q.ComputeMu()};
+    for (uint32_t k = 0; k < N; ++k)
+        accv[k].ModAddFastEq(av[k].ModMulFast(b[k], q, mu), q);
+#else
+    for (uint32_t k = 0; k < N; ++k)
+        accv[k].ModAddFastEq(av[k].ModMulFast(b[k], q), q);
+#endif
+}
+
 }  // namespace lbcrypto
 
 #endif  // _RGSW_EVAL_KEY_H_
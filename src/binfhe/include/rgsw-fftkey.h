@@ -0,0 +1,72 @@
+#ifndef _RGSW_FFTKEY_H_
+#define _RGSW_FFTKEY_H_
+
+#include "rgsw-acckey.h"
+#include "rgsw-cryptoparameters.h"
+#include "negacyclic-fft.h"
+
+#include <memory>
+#include <vector>
+
+namespace lbcrypto {
+
+class RingGSWACCFFTKeyImpl;
+using RingGSWACCFFTKey      = std::shared_ptr<RingGSWACCFFTKeyImpl>;
+using ConstRingGSWACCFFTKey = const std::shared_ptr<const RingGSWACCFFTKeyImpl>;
+
+/**
+ * @brief Refresh key of the CGGI accumulator in the double-precision FFT domain. Every
+ * coefficient of the RGSW keys is centered and split into numLimbs signed limbs of limbBits
+ * bits, and every limb polynomial is stored transformed. The limbs are sized so that a blind
+ * rotation rounds all its decomposed products to the right integers except with probability
+ * below 2^-40, see RingGSWCryptoParams::GetFFTLog2FailureRate: the CMUX sets use three 18-bit
+ * limbs, which bounds it by 2^-70 for CMUX_1 and far lower for the narrower gadgets. A wrong
+ * rounding of limb l adds +-2^(l * limbBits) to the error of the accumulator
+ */
+class RingGSWACCFFTKeyImpl {
+public:
+    RingGSWACCFFTKeyImpl() = default;
+
+    /**
+   * Converts a refresh key in the NTT domain
+   *
+   * @param params a shared pointer to RingGSW scheme parameters
+   * @param ek the refresh key, ek[0][k][g] is the key k of group g
+   */
+    RingGSWACCFFTKeyImpl(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCKey& ek);
+
+    uint32_t GetNumLimbs() const {
+        return m_numLimbs;
+    }
+
+    /**
+   * Number of keys per group of key unrolled secret coefficients
+   */
+    uint32_t GetNumPatterns() const {
+        return m_numPatterns;
+    }
+
+    /**
+   * Gets the i-th RGSW key, i = g * numPatterns + k for the key k of group g; limb l of the entry
+   * (row, col) is at (2 * row + col) * numLimbs + l
+   *
+   * @param i index of the key
+   * @return the limb polynomials of the key
+   */
+    const std::vector<FFTPoly>& operator[](uint32_t i) const {
+        return m_key[i];
+    }
+
+    size_t size() const {
+        return m_key.size();
+    }
+
+private:
+    uint32_t m_numLimbs{};
+    uint32_t m_numPatterns{};
+    std::vector<std::vector<FFTPoly>> m_key;
+};
+
+}  // namespace lbcrypto
+
+#endif
@@ -3,12 +3,17 @@
 
 
 #include "binfhe-constants.h"
+#include "automorphism-plan.h"
 #include "math/discretegaussiangenerator.h"
 #include "lattice/lat-hal.h"
+#include "utils/serializable.h"
+
+#include <map>
+#include <string>
 
 namespace lbcrypto {
 
-class RLWECryptoParams {
+class RLWECryptoParams : public Serializable {
 public:
     RLWECryptoParams() = default;
     
@@ -54,12 +59,7 @@ public:
             OPENFHE_THROW(config_error, "m_digitsSS (the digits used for scheme switch) can not be zero");
         if (m_Q.GetMSB() > MAX_MODULUS_SIZE)
             OPENFHE_THROW(config_error, "Q.GetMSB() > MAX_MODULUS_SIZE");
-        auto logQ{log(m_Q.ConvertToDouble())};
-        m_EXdigitsHT = static_cast<uint32_t>(std::ceil(logQ / log(static_cast<double>(m_baseHT))));
-        m_EXdigitsSS = static_cast<uint32_t>(std::ceil(logQ / log(static_cast<double>(m_baseSS))));
-        m_dgg.SetStd(std);
-        m_ht_dgg.SetStd(std);
-        m_ss_dgg.SetStd(std);
+        SetStd(std);
         PreCompute(signEval); 
     }
     
@@ -112,6 +112,20 @@ public:
         return m_SSpower;
     }
 
+    /**
+   * Number of least significant bits dropped by the approximate homtrace decomposition
+   */
+    uint32_t GetIgnoreBitsHT() const {
+        return m_ignoreBitsHT;
+    }
+
+    /**
+   * Number of least significant bits dropped by the approximate scheme switching decomposition
+   */
+    uint32_t GetIgnoreBitsSS() const {
+        return m_ignoreBitsSS;
+    }
+
     const std::vector<NativeInteger>& GetAHTPower() const {
         return m_AHTpower;
     }
@@ -139,7 +153,69 @@ public:
     const SecretKeyDist GetKeyDist() const {
         return m_keyDist;
     }
+
+    template <class Archive>
+    void save(Archive& ar, std::uint32_t const version) const {
+        ar(::cereal::make_nvp("m", m_m));
+        ar(::cereal::make_nvp("N", m_N));
+        ar(::cereal::make_nvp("Q", m_Q));
+        ar(::cereal::make_nvp("s", m_dgg.GetStd()));
+        ar(::cereal::make_nvp("bHT", m_baseHT));
+        ar(::cereal::make_nvp("dHT", m_digitsHT));
+        ar(::cereal::make_nvp("bSS", m_baseSS));
+        ar(::cereal::make_nvp("dSS", m_digitsSS));
+        ar(::cereal::make_nvp("keyDist", m_keyDist));
+    }
+
+    template <class Archive>
+    void load(Archive& ar, std::uint32_t const version) {
+        if (version > SerializedVersion()) {
+            OPENFHE_THROW("serialized object version " + std::to_string(version) +
+                          " is from a later version of the library");
+        }
+        ar(::cereal::make_nvp("m", m_m));
+        ar(::cereal::make_nvp("N", m_N));
+        ar(::cereal::make_nvp("Q", m_Q));
+        double sigma = 0;
+        ar(::cereal::make_nvp("s", sigma));
+        ar(::cereal::make_nvp("bHT", m_baseHT));
+        ar(::cereal::make_nvp("dHT", m_digitsHT));
+        ar(::cereal::make_nvp("bSS", m_baseSS));
+        ar(::cereal::make_nvp("dSS", m_digitsSS));
+        ar(::cereal::make_nvp("keyDist", m_keyDist));
+
+        m_polyParams = std::make_shared<ILNativeParams>(m_m, m_Q);
+        SetStd(sigma);
+        PreCompute();
+    }
+
+    std::string SerializedObjectName() const override {
+        return "RLWECryptoParams";
+    }
+    static uint32_t SerializedVersion() {
+        return 1;
+    }
+
+    /**
+   * Returns the precomputed plan of the automorphism X -> X^k used by homtrace
+   *
+   * @param k automorphism index, (N >> i) + 1 for the i-th homtrace level
+   * @return the automorphism plan
+   */
+    const AutomorphismPlan& GetAutoPlan(uint32_t k) const {
+        auto it = m_autoPlans.find(k);
+        if (it == m_autoPlans.end())
+            OPENFHE_THROW(config_error, "no precomputed automorphism plan for index " + std::to_string(k));
+        return it->second;
+    }
 private:
+    // Sets the standard deviation of all error distributions
+    void SetStd(double std) {
+        m_dgg.SetStd(std);
+        m_ht_dgg.SetStd(std);
+        m_ss_dgg.SetStd(std);
+    }
+
     // cyclotomic ring order for RingGSW/RingLWE scheme
     uint32_t m_m{};
     // ring dimension for RingGSW/RingLWE scheme
@@ -158,6 +234,10 @@ private:
     uint32_t m_digitsSS{};
     // Exact digits in scheme switching
     uint32_t m_EXdigitsSS{};
+    // Bits dropped by the approximate decomposition in homtrace
+    uint32_t m_ignoreBitsHT{};
+    // Bits dropped by the approximate decomposition in scheme switching
+    uint32_t m_ignoreBitsSS{};
 
     // A vector of powers of baseHT
     std::vector<NativeInteger> m_HTpower;
@@ -171,6 +251,9 @@ private:
     // A vector of base of SS approximate decomposition
     std::vector<NativeInteger> m_ASSpower;
 
+    // Precomputed automorphism plans for the homtrace indices (N >> i) + 1
+    std::map<uint32_t, AutomorphismPlan> m_autoPlans;
+
     // Secret key distribution: GAUSSIAN, UNIFORM_TERNARY, UNIFORM_BINARY,etc.
     SecretKeyDist m_keyDist{SecretKeyDist::UNIFORM_BINARY};
     // Error distribution generator
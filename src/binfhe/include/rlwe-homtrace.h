@@ -32,6 +32,30 @@ public:
    */
     void EvalHT(const std::shared_ptr<RLWECryptoParams>& params, ConstRLWEHomTraceKey& ek, RLWECiphertext& ct) const;
 
+    /**
+   * Homtrace of a group of ciphertexts evaluated level by level: all ciphertexts go through the
+   * i-th automorphism before any of them moves to level i+1, so each automorphism key is
+   * reused while it is cached
+   *
+   * @param params a shared pointer to RingLWE scheme parameters
+   * @param ek the homtrace key
+   * @param ct input RingLWE ciphertexts, modified in place
+   */
+    void EvalHTBatch(const std::shared_ptr<RLWECryptoParams>& params, ConstRLWEHomTraceKey& ek,
+                     std::vector<RLWECiphertext>& ct) const;
+
+    /**
+   * One level of homtrace: ct becomes ct + tau(ct) for the automorphism tau of the level-th
+   * homtrace key, X -> X^{(N >> level) + 1}
+   *
+   * @param params a shared pointer to RingLWE scheme parameters
+   * @param ek the homtrace key
+   * @param level the level, from 0 to log2(N) - 1
+   * @param ct input RingLWE ciphertext, modified in place
+   */
+    void EvalHTLevel(const std::shared_ptr<RLWECryptoParams>& params, ConstRLWEHomTraceKey& ek, uint32_t level,
+                     RLWECiphertext& ct) const;
+
    /**
    * The signed digit decomposition which takes a ring element input and outputs a vector of its digits, i.e.,
    * decompose(a) = (a_0, ..., a_{d-1}) = R^d.
@@ -39,13 +63,14 @@ public:
    * @param params a shared pointer to RingLWE scheme parameters
    * @param input input ring element
    * @param output decomposed value
+   * @param format the format of the output digits; EVALUATION transforms each digit as it is produced
    */
     void SignedDigitDecompose(const std::shared_ptr<RLWECryptoParams>& params, const NativePoly& input,
-                            std::vector<NativePoly>& output) const;
+                            std::vector<NativePoly>& output,
+                              Format format = Format::COEFFICIENT) const;
 
-private:
     /**
-   * Key generation for automorphism
+   * Key generation for automorphism; the i-th key of the homtrace key is the key of (N >> i) + 1
    *
    * @param params a shared pointer to RingLWE scheme parameters
    * @param skNTT secret key polynomial in the EVALUATION representation
@@ -53,7 +78,8 @@ private:
    * @return a shared pointer to the resulting keys
    */
     RingGSWEvalKey KeyGenAuto(const std::shared_ptr<RLWECryptoParams>& params, const NativePoly& skNTT, uint32_t k) const;
-   
+
+private:
    /**
    * Main homomorphic automorphism function used in field trace evaluation
    *
@@ -41,9 +41,11 @@ public:
    * @param params a shared pointer to RingLWE scheme parameters
    * @param input input ring element
    * @param output decomposed value
+   * @param format the format of the output digits; EVALUATION transforms each digit as it is produced
    */
     void SignedDigitDecompose(const std::shared_ptr<RLWECryptoParams>& params, const NativePoly& input,
-                                std::vector<NativePoly>& output) const;
+                                std::vector<NativePoly>& output,
+                              Format format = Format::COEFFICIENT) const;
 };
 }
 #endif
\ No newline at end of file
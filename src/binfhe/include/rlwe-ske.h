@@ -84,9 +84,11 @@ public:
    * @param base the base of gadget decomposition
    * @param digits the digits of approximate decomposition
    * @param output decomposed value
+   * @param format the format of the output digits; EVALUATION transforms each digit as it is produced
    */
     void SignedDigitDecompose(const std::shared_ptr<RLWECryptoParams>& params, ConstRLWECiphertext& input,
-                              const uint32_t base, const uint32_t digits, std::vector<NativePoly>& output) const;
+                              const uint32_t base, const uint32_t digits, std::vector<NativePoly>& output,
+                              Format format = Format::COEFFICIENT) const;
 
 };
 }
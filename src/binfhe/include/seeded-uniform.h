@@ -0,0 +1,101 @@
+#ifndef _SEEDED_UNIFORM_H_
+#define _SEEDED_UNIFORM_H_
+
+#include "lattice/lat-hal.h"
+#include "math/distributiongenerator.h"
+#include "utils/prng/blake2engine.h"
+
+#include <array>
+#include <memory>
+
+namespace lbcrypto {
+
+// Seed of a uniformly random polynomial; the 16 words of the seed of the Blake2 PRNG
+using PolySeed = std::array<uint32_t, 16>;
+
+/**
+ * @brief Generates the uniformly random polynomials of the keys from a short seed, so that a
+ * key can be stored with one seed per row instead of the random polynomial
+ */
+class SeededUniformGenerator {
+public:
+    /**
+   * Draws a fresh seed from the PRNG of the calling thread
+   *
+   * @return the seed
+   */
+    static PolySeed GenerateSeed();
+
+    /**
+   * Derives the seed of an independent stream from a parent seed: the first 16 words of the
+   * Blake2 block of the parent with the counter set to the stream index
+   *
+   * @param parent the parent seed
+   * @param index the index of the stream
+   * @return the seed of the stream
+   */
+    static PolySeed DeriveSeed(const PolySeed& parent, uint32_t index);
+
+    /**
+   * Expands a seed into a polynomial with coefficients uniform mod Q. The NTT is a bijection,
+   * so the values are directly taken as the Format::EVALUATION representation
+   *
+   * @param polyParams parameters of the polynomial
+   * @param seed the seed
+   * @return the uniformly random polynomial in Format::EVALUATION
+   */
+    static NativePoly Expand(const std::shared_ptr<ILNativeParams>& polyParams, const PolySeed& seed);
+
+    /**
+   * Expands a seed into a preallocated polynomial in Format::EVALUATION
+   *
+   * @param seed the seed
+   * @param poly the polynomial to overwrite
+   */
+    static void Expand(const PolySeed& seed, NativePoly& poly);
+};
+
+/**
+ * @brief Reproducible PRNG streams for parallel key generation. A stream with the seed
+ * DeriveSeed(parent, index) installs a Blake2 engine seeded from it as the PRNG of the calling
+ * thread for its lifetime, so that all uniform and Gaussian samples of a task only depend on the parent seed
+ * and on the index of the task, not on the thread that runs it. Its seed becomes the parent of
+ * the streams of the nested tasks, which take it with Current() before their parallel region.
+ * A stream with a null parent does nothing. The parent seed determines the error samples and the
+ * secret indicators of the keys as well as their public part: it must be kept as secret as the
+ * secret keys and never be stored or sent with the keys
+ */
+class PRNGStream {
+public:
+    // index of the child of the seed of a stream that seeds the samples of its own task
+    static constexpr uint32_t SAMPLING_INDEX = 0xffffffff;
+
+    /**
+   * Installs the stream of a task
+   *
+   * @param parent the seed of the parent stream, nullptr for no stream
+   * @param index the index of the task, smaller than SAMPLING_INDEX
+   */
+    PRNGStream(const std::shared_ptr<const PolySeed>& parent, uint32_t index);
+
+    ~PRNGStream();
+
+    PRNGStream(const PRNGStream&) = delete;
+    PRNGStream& operator=(const PRNGStream&) = delete;
+
+    /**
+   * Gets the seed of the stream of the calling thread
+   *
+   * @return the seed, nullptr outside of a stream
+   */
+    static std::shared_ptr<const PolySeed> Current();
+
+private:
+    bool m_active{false};
+    std::shared_ptr<PRNG> m_prevPRNG;
+    std::shared_ptr<const PolySeed> m_prevSeed;
+};
+
+}  // namespace lbcrypto
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef _SIGNED_DIGIT_DECOMPOSE_H_
+#define _SIGNED_DIGIT_DECOMPOSE_H_
+
+#include "lattice/lat-hal.h"
+
+#include <vector>
+
+namespace lbcrypto {
+
+/**
+ * Signed (approximate) gadget decomposition shared by the accumulators, homtrace, scheme
+ * switching and the RLWE external product. Every coefficient of input is centered in
+ * (-Q/2, Q/2], its ignoreBits least significant bits are rounded away, and the remainder is
+ * split into digits signed digits in [-B/2, B/2) with B = 2^gBits, least significant first.
+ * Digit d is written (not added) to output[offset + d * stride], mapped back to [0, Q).
+ *
+ * With format == EVALUATION every digit is transformed by the forward NTT as soon as it is
+ * produced, while it is still in cache, which saves a separate pass over all digits.
+ *
+ * The kernel is compiled for AVX-512, AVX2 and the baseline instruction set and the best
+ * version supported by the CPU is selected at load time.
+ *
+ * @param input polynomial in COEFFICIENT format
+ * @param Q the modulus
+ * @param gBits log2 of the gadget base
+ * @param ignoreBits number of least significant bits dropped by the approximate decomposition
+ * @param digits number of digits
+ * @param output preallocated digit polynomials
+ * @param offset index of the first digit in output
+ * @param stride distance between consecutive digits in output
+ * @param format format of the output digits
+ */
+void DecomposeSignedDigits(const NativePoly& input, const NativeInteger& Q, uint32_t gBits, uint32_t ignoreBits,
+                           uint32_t digits, std::vector<NativePoly>& output, uint32_t offset = 0,
+                           uint32_t stride = 1, Format format = Format::COEFFICIENT);
+
+}  // namespace lbcrypto
+
+#endif
@@ -0,0 +1,37 @@
+#include "automorphism-plan.h"
+#include "math/nbtheory.h"
+
+namespace lbcrypto {
+
+AutomorphismPlan::AutomorphismPlan(uint32_t N, uint32_t k) : m_k(k), m_map(N) {
+    if (k % 2 == 0)
+        OPENFHE_THROW("Automorphism index not odd");
+    PrecomputeAutoMap(N, k, &m_map);
+
+    std::vector<bool> visited(N, false);
+    for (uint32_t s = 0; s < N; ++s) {
+        if (visited[s])
+            continue;
+        uint32_t j = s;
+        do {
+            visited[j] = true;
+            j          = m_map[j];
+        } while (j != s);
+        if (m_map[s] != s)
+            m_cycles.push_back(s);
+    }
+}
+
+void AutomorphismPlan::Apply(NativePoly& poly) const {
+    if (poly.GetFormat() != Format::EVALUATION)
+        OPENFHE_THROW("Automorphism Poly Format not EVALUATION");
+    for (uint32_t s : m_cycles) {
+        NativeInteger tmp{poly[s]};
+        uint32_t j = s;
+        for (uint32_t i = m_map[j]; i != s; j = i, i = m_map[i])
+            poly[j] = poly[i];
+        poly[j] = tmp;
+    }
+}
+
+}  // namespace lbcrypto
@@ -149,6 +149,21 @@ std::ostream& operator<<(std::ostream& s, BINFHE_METHOD f) {
     return s;
 }
 
+std::ostream& operator<<(std::ostream& s, EXTPROD_BACKEND f) {
+    switch (f) {
+        case NTT_BACKEND:
+            s << "NTT_BACKEND";
+            break;
+        case FFT_BACKEND:
+            s << "FFT_BACKEND";
+            break;
+        default:
+            s << "UNKNOWN";
+            break;
+    }
+    return s;
+}
+
 std::ostream& operator<<(std::ostream& s, BINGATE f) {
     switch (f) {
         case OR:
@@ -23,26 +23,8 @@ void CirBTSCryptoParams::PreCompute() {
     m_LUT.SetValues(std::move(LUT), Format::COEFFICIENT);
     m_LUT.SetFormat(EVALUATION);
 
-    // Computes polynomials X^{-i} that are needed in the circuit bootstrapping
-    constexpr NativeInteger one{1};
-    m_monomials.reserve(2 * N);
-    NativePoly aPoly(polyParams, Format::COEFFICIENT, true);
-    aPoly[0].ModAddFastEq(one, Q);
-    aPoly.SetFormat(Format::EVALUATION);
-    m_monomials.push_back(std::move(aPoly));
-
-    for(uint32_t i = 1; i <= N; i++){
-        NativePoly aPoly(polyParams, Format::COEFFICIENT, true);
-        aPoly[N - i].ModSubFastEq(one, Q);
-        aPoly.SetFormat(Format::EVALUATION);
-        m_monomials.push_back(std::move(aPoly));
-    }
-
-    for(uint32_t i = 1; i < N; i++){
-        NativePoly aPoly(polyParams, Format::COEFFICIENT, true);
-        aPoly[N - i].ModAddFastEq(one, Q);
-        aPoly.SetFormat(Format::EVALUATION);
-        m_monomials.push_back(std::move(aPoly));
-    }
+    // Precomputes the powers of the root of unity from which the polynomials
+    // X^{-i} needed in the circuit bootstrapping are generated
+    m_monomials = EvalMonomials(polyParams);
 }
 }
\ No newline at end of file
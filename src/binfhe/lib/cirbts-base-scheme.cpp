@@ -1,42 +1,462 @@
 #include "cirbts-base-scheme.h"
-#include <chrono>
+#include "signed-digit-decompose.h"
+#include "cirbts-perf.h"
+#include "rlwe-ske.h"
+#include <algorithm>
+#include <exception>
+#include <limits>
 
 namespace lbcrypto{
 
+namespace {
+
+//the phase b - a * s of ct in Format::EVALUATION
+NativePoly Phase(ConstRLWECiphertext& ct, const NativePoly& skNTT){
+    NativePoly a(ct->GetElements()[0]);
+    NativePoly b(ct->GetElements()[1]);
+    a.SetFormat(EVALUATION);
+    b.SetFormat(EVALUATION);
+    return b - a * skNTT;
+}
+
+//adds the coefficients of err, centered in (-Q/2, Q/2], to stats
+void AddError(NativePoly err, CirBTSErrorStats& stats){
+    err.SetFormat(COEFFICIENT);
+    const auto& Q = err.GetModulus();
+    auto half = Q >> 1;
+    for (uint32_t i = 0; i < err.GetLength(); ++i){
+        const auto& e = err[i];
+        stats.Add(e > half ? -(Q - e).ConvertToDouble() : e.ConvertToDouble());
+    }
+}
+
+}  // namespace
+
 RingGSWCirBTKey CirBTSScheme::KeyGen(const std::shared_ptr<CirBTSCryptoParams>& params, ConstLWEPrivateKey& LWEsk, ConstRLWEPrivateKey skNTT,
-                                         KEYGEN_MODE keygenMode) const{
+                                         KEYGEN_MODE keygenMode, const PolySeed& seed) const{
     const auto& RGSWParams1 = params->GetRingGSWParams1();
     const auto& RLWEParams = params->GetRLWEParams();
     auto RLWEsk = skNTT->GetElement();
+    auto master = std::make_shared<const PolySeed>(seed);
 
-    RingGSWCirBTKey ek;
-    ek.RFkey = ACCscheme->KeyGenAcc(RGSWParams1, RLWEsk, LWEsk);
-    ek.HTkey = HomTrace->KeyGenHT(RLWEParams, RLWEsk);
-    ek.SSkey = SchemeSwitch->KeyGenSS(RLWEParams, RLWEsk);
+    RingGSWCirBTKey ek{};
+    //stream 0: the refresh key is parallel over its own tasks
+    {
+        PRNGStream stream(master, 0);
+        ek.RFkey = ACCscheme->KeyGenAcc(RGSWParams1, RLWEsk, LWEsk);
+    }
 
+    //the homtrace automorphism keys, the scheme switching key and the round-to-odd key are tasks
+    //of similar size and are generated together; task t uses the stream t + 1
+    uint32_t N = RLWEParams->GetN();
+    uint32_t numAuto = static_cast<uint32_t>(log2(N));
+    bool isLMKCDEY = RGSWParams1->GetMethod() == LMKCDEY;
+    uint32_t numTasks = numAuto + (isLMKCDEY ? 2 : 1);
+    ek.HTkey = std::make_shared<RLWEHomTraceKeyImpl>(1, 1, numAuto);
+#pragma omp parallel for schedule(dynamic) num_threads(OpenFHEParallelControls.GetThreadLimit(numTasks))
+    for (uint32_t t = 0; t < numTasks; ++t){
+        PRNGStream stream(master, t + 1);
+        if (t < numAuto)
+            (*ek.HTkey)[0][0][t] = HomTrace->KeyGenAuto(RLWEParams, RLWEsk, (N >> t) + 1);
+        else if (t == numAuto)
+            ek.SSkey = SchemeSwitch->KeyGenSS(RLWEParams, RLWEsk);
+        else
+            ek.RTOkey = std::static_pointer_cast<RingGSWAccumulatorLMKCDEY>(ACCscheme)->KeyGenRoundToOdd(RGSWParams1, RLWEsk, LWEsk);
+    }
+
+    if (params->GetProductBackend() == FFT_BACKEND)
+        ek.FFTkey = KeyGenFFT(params, ek.RFkey);
     return ek;
 }
 
+RingGSWACCFFTKey CirBTSScheme::KeyGenFFT(const std::shared_ptr<CirBTSCryptoParams>& params, ConstRingGSWACCKey& ek) const{
+    const auto& RGSWParams1 = params->GetRingGSWParams1();
+    if (RGSWParams1->GetMethod() != GINX)
+        OPENFHE_THROW(config_error, "the FFT backend is only supported for the GINX method");
+    return std::make_shared<RingGSWACCFFTKeyImpl>(RGSWParams1, ek);
+}
+
 RGSWCiphertext CirBTSScheme::CircuitBootstrap(const std::shared_ptr<CirBTSCryptoParams>& params, const RingGSWCirBTKey& ek,
                                                 ConstLWECiphertext& ct) const{
+    CirBTSPerfScope perf(STAGE_CIRCUIT_BOOTSTRAP);
+    auto numLUT = params->GetDigitsCC();
+    auto bitwidth = static_cast<uint32_t>(std::ceil(std::log2(numLUT)));
+
+    //MV-FBS
+    auto acc{params->GetProductBackend() == FFT_BACKEND ?
+                 BootstrapManyLUT(params, ek.FFTkey, ct, params->GetLUT(), bitwidth) :
+                 BootstrapManyLUT(params, ek.RFkey, ct, params->GetLUT(), bitwidth)};
+    std::vector<RLWECiphertext> accs{acc};
+    CorrectRoundToOdd(params, ek, accs);
+    return ConvertToRGSW(params, ek, acc);
+}
+
+std::vector<RGSWCiphertext> CirBTSScheme::CircuitBootstrapBatch(const std::shared_ptr<CirBTSCryptoParams>& params,
+                                                                const RingGSWCirBTKey& ek,
+                                                                const std::vector<LWECiphertext>& ct) const{
+    // no team of 0 threads is requested below
+    if (ct.empty())
+        return {};
+    // exceptions can not leave the parallel region below, so the keys are checked here
+    if (ek.RFkey == nullptr || ek.HTkey == nullptr || ek.SSkey == nullptr ||
+        (params->GetProductBackend() == FFT_BACKEND && ek.FFTkey == nullptr) ||
+        (params->GetRingGSWParams1()->GetMethod() == LMKCDEY && ek.RTOkey == nullptr)) {
+        std::string errMsg =
+            "Bootstrapping keys have not been generated. Please call CirBTKeyGen "
+            "before calling circuit bootstrapping.";
+        OPENFHE_THROW(config_error, errMsg);
+    }
+
+    CirBTSPerfScope perf(STAGE_CIRCUIT_BOOTSTRAP, true, ct.size());
     auto numLUT = params->GetDigitsCC();
     auto bitwidth = static_cast<uint32_t>(std::ceil(std::log2(numLUT)));
 
+    //MV-FBS of the whole batch in lockstep over the refresh keys
+    auto acc{params->GetProductBackend() == FFT_BACKEND ?
+                 BootstrapManyLUTBatch(params, ek.FFTkey, ct, params->GetLUT(), bitwidth) :
+                 BootstrapManyLUTBatch(params, ek.RFkey, ct, params->GetLUT(), bitwidth)};
+    CorrectRoundToOdd(params, ek, acc);
+
+    uint32_t numCt = ct.size();
+    std::vector<RLWECiphertext> MV_RLWEs(numCt * numLUT);
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(numCt)) if (!omp_in_parallel())
+    for(uint32_t i = 0; i < numCt; i++){
+        auto mv_i = SplitManyLUT(params, acc[i]);
+        std::move(mv_i.begin(), mv_i.end(), MV_RLWEs.begin() + i * numLUT);
+    }
+
+    //Homtrace of all numCt * numLUT ciphertexts level by level
+    HomTrace->EvalHTBatch(params->GetRLWEParams(), ek.HTkey, MV_RLWEs);
+
+    std::vector<RGSWCiphertext> res(numCt);
+    //one ciphertext per thread: the inner regions of SchemeSwitchToRGSW are disabled
+    //by their omp_in_parallel() checks, so the cores are not oversubscribed
+#pragma omp parallel for schedule(dynamic) num_threads(OpenFHEParallelControls.GetThreadLimit(numCt)) if (!omp_in_parallel())
+    for(uint32_t i = 0; i < numCt; i++){
+        std::vector<RLWECiphertext> mv_i(MV_RLWEs.begin() + i * numLUT, MV_RLWEs.begin() + (i + 1) * numLUT);
+        res[i] = SchemeSwitchToRGSW(params, ek, mv_i);
+    }
+    return res;
+}
+
+void CirBTSScheme::EvalExternalProductInPlace(const std::shared_ptr<CirBTSCryptoParams>& params,
+                                              ConstRGSWCiphertext& ctGSW, RLWECiphertext& ct,
+                                              BlindRotationWorkspace& ws) const{
+    CirBTSPerfScope perf(STAGE_EXTERNAL_PRODUCT);
+    ws.Reserve(params->GetRLWEParams()->GetPolyParams(), 2 * params->GetDigitsCC());
+    auto& in = ws.GetCt();
+    for (uint32_t k = 0; k < 2; ++k){
+        in[k] = ct->GetElements()[k];
+        in[k].SetFormat(COEFFICIENT);
+    }
+    AddExternalProduct(params, ctGSW, ws, ct->GetElements(), true);
+}
+
+void CirBTSScheme::EvalCMuxInPlace(const std::shared_ptr<CirBTSCryptoParams>& params, ConstRGSWCiphertext& sel,
+                                   RLWECiphertext& ct0, ConstRLWECiphertext& ct1, BlindRotationWorkspace& ws) const{
+    CirBTSPerfScope perf(STAGE_CMUX);
+    ws.Reserve(params->GetRLWEParams()->GetPolyParams(), 2 * params->GetDigitsCC());
+    //in = ct1 - ct0, then ct0 += sel * in
+    auto& in = ws.GetCt();
+    for (uint32_t k = 0; k < 2; ++k){
+        auto& c0 = ct0->GetElements()[k];
+        c0.SetFormat(EVALUATION);
+        in[k] = ct1->GetElements()[k];
+        in[k].SetFormat(EVALUATION);
+        in[k] -= c0;
+        in[k].SetFormat(COEFFICIENT);
+    }
+    AddExternalProduct(params, sel, ws, ct0->GetElements(), false);
+}
+
+RLWECiphertext CirBTSScheme::EvalLUT(const std::shared_ptr<CirBTSCryptoParams>& params,
+                                     const std::vector<RGSWCiphertext>& sel, const std::vector<uint64_t>& table,
+                                     uint32_t numOutputBits) const{
+    const auto& RLWEParams = params->GetRLWEParams();
+    const auto& polyParams = RLWEParams->GetPolyParams();
+    uint32_t N{RLWEParams->GetN()};
+    uint32_t k = sel.size();
+    if (k == 0 || k >= 64 || table.size() > (uint64_t(1) << k))
+        OPENFHE_THROW(config_error, "the table has more entries than the selector bits can address");
+    // exceptions can not leave the parallel regions below, so the selectors are checked here
+    uint32_t digitsCC{params->GetDigitsCC()};
+    for (const auto& s : sel){
+        if (s == nullptr || s->GetRowSize() != 2 * digitsCC || s->GetColSize() != 2)
+            OPENFHE_THROW(config_error, "the selector bits must be RGSW ciphertexts of the gadget of the circuit computation");
+    }
+
+    CirBTSPerfScope perf(STAGE_LUT);
+    //m output bits per entry, E = 2^e entries per polynomial
+    uint64_t maxEntry{table.empty() ? 0 : *std::max_element(table.begin(), table.end())};
+    uint32_t m = numOutputBits;
+    if (m == 0)
+        m = std::max(GetMSB(maxEntry), 1u);
+    if (m > 64 || m > N || (m < 64 && (maxEntry >> m) != 0))
+        OPENFHE_THROW(config_error, "the entries of the table do not fit in the output bits");
+    uint32_t e{GetMSB(N / m) - 1};
+    e = std::min(e, k);
+    uint64_t entriesPerPoly{uint64_t(1) << e};
+    //only the polynomials holding entries are encrypted, the missing ones of the 2^(k - e) are 0
+    uint64_t numEntryPolys{std::max<uint64_t>((table.size() + entriesPerPoly - 1) >> e, 1)};
+    if (numEntryPolys > std::numeric_limits<uint32_t>::max())
+        OPENFHE_THROW(config_error, "the table has too many entries");
+    uint32_t numPolys{static_cast<uint32_t>(numEntryPolys)};
+
+    //trivial encryptions (0, floor(Q/2) * P_j) of the packed polynomials
+    NativeInteger half{RLWEParams->GetQ() >> 1};
+    std::vector<RLWECiphertext> cts(numPolys);
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(numPolys)) if (!omp_in_parallel())
+    for (uint32_t j = 0; j < numPolys; ++j){
+        std::vector<NativePoly> ct(2, NativePoly(polyParams, Format::COEFFICIENT, true));
+        for (uint64_t x = j * entriesPerPoly, c = 0; x < table.size() && c < entriesPerPoly * m; ++x){
+            for (uint32_t t = 0; t < m; ++t, ++c){
+                if ((table[x] >> t) & 0x1)
+                    ct[1][c] = half;
+            }
+        }
+        ct[0].SetFormat(Format::EVALUATION);
+        ct[1].SetFormat(Format::EVALUATION);
+        cts[j] = std::make_shared<RLWECiphertextImpl>(std::move(ct));
+    }
+
+    //CMux tree over the high bits, one level at a time; a polynomial without a sibling is
+    //selected against 0
+    auto zero = std::make_shared<RLWECiphertextImpl>(
+        std::vector<NativePoly>(2, NativePoly(polyParams, Format::EVALUATION, true)));
+    for (uint32_t level = e; level < k; ++level){
+        uint32_t numPairs{(numPolys + 1) >> 1};
+        ConstRGSWCiphertext& s = sel[level];
+#pragma omp parallel num_threads(OpenFHEParallelControls.GetThreadLimit(numPairs)) if (!omp_in_parallel())
+        {
+            BlindRotationWorkspace ws;
+#pragma omp for
+            for (uint32_t j = 0; j < numPairs; ++j)
+                EvalCMuxInPlace(params, s, cts[2 * j], 2 * j + 1 < numPolys ? cts[2 * j + 1] : zero, ws);
+        }
+        for (uint32_t j = 0; j < numPairs; ++j)
+            cts[j] = std::move(cts[2 * j]);
+        numPolys = numPairs;
+        cts.resize(numPolys);
+    }
+
+    //blind rotation by X^{-m * low} over the low bits
+    auto& acc = cts[0];
+    const auto& monomials = params->GetMonomials();
+    BlindRotationWorkspace ws;
+    RLWECiphertext rot = std::make_shared<RLWECiphertextImpl>(*acc);
+    for (uint32_t i = 0; i < e; ++i){
+        uint32_t r{static_cast<uint32_t>(2 * N - ((uint64_t(m) << i) % (2 * N)))};
+        for (uint32_t c = 0; c < 2; ++c){
+            rot->GetElements()[c] = acc->GetElements()[c];
+            monomials.MultiplyByMonomial(rot->GetElements()[c], r);
+        }
+        EvalCMuxInPlace(params, sel[i], acc, rot, ws);
+    }
+    return acc;
+}
+
+CirBTSNoiseStats CirBTSScheme::MeasureNoise(const std::shared_ptr<CirBTSCryptoParams>& params, const RingGSWCirBTKey& ek,
+                                            ConstLWEPrivateKey& LWEsk, ConstRLWEPrivateKey& skNTT,
+                                            uint32_t numRuns) const{
+    // exceptions can not leave the parallel region below, so the keys are checked here
+    if (ek.RFkey == nullptr || ek.HTkey == nullptr || ek.SSkey == nullptr ||
+        (params->GetProductBackend() == FFT_BACKEND && ek.FFTkey == nullptr) ||
+        (params->GetRingGSWParams1()->GetMethod() == LMKCDEY && ek.RTOkey == nullptr)) {
+        std::string errMsg =
+            "Bootstrapping keys have not been generated. Please call CirBTKeyGen "
+            "before measuring the noise.";
+        OPENFHE_THROW(config_error, errMsg);
+    }
+    if (numRuns == 0)
+        return CirBTSNoiseStats();
+
+    const auto& LWEParams = params->GetLWEParams();
+    const auto& RLWEParams = params->GetRLWEParams();
+    auto polyParams = RLWEParams->GetPolyParams();
+
+    //the inputs are encrypted serially, the threads share the PRNG
+    RLWEEncryptionScheme RLWEscheme;
+    BinaryUniformGeneratorImpl<NativeVector> bug;
+    std::vector<LWEPlaintext> bits(numRuns);
+    std::vector<LWECiphertext> ct(numRuns);
+    std::vector<RLWECiphertext> ctEP(numRuns);
+    for (uint32_t r = 0; r < numRuns; r++){
+        bits[r] = r & 1;
+        ct[r] = LWEscheme->Encrypt(LWEParams, LWEsk, bits[r], 2, LWEParams->Getq());
+        NativePoly m(bug, polyParams, COEFFICIENT);
+        ctEP[r] = RLWEscheme.Encrypt(RLWEParams, skNTT, m, 2, RLWEParams->GetQ());
+    }
+
+    //an exception of a run is kept and rethrown after the region, which it can not leave
+    std::vector<CirBTSNoiseStats> runs(numRuns);
+    std::vector<std::exception_ptr> errors(numRuns);
+#pragma omp parallel for schedule(dynamic) num_threads(OpenFHEParallelControls.GetThreadLimit(numRuns))
+    for (uint32_t r = 0; r < numRuns; r++){
+        try{
+            runs[r] = MeasureNoiseRun(params, ek, LWEsk, skNTT->GetElement(), ct[r], bits[r], ctEP[r]);
+        }
+        catch (...){
+            errors[r] = std::current_exception();
+        }
+    }
+    for (const auto& error : errors){
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    CirBTSNoiseStats res;
+    for (const auto& run : runs)
+        res.Merge(run);
+    return res;
+}
+
+CirBTSNoiseStats CirBTSScheme::MeasureNoiseRun(const std::shared_ptr<CirBTSCryptoParams>& params,
+                                               const RingGSWCirBTKey& ek, ConstLWEPrivateKey& LWEsk,
+                                               const NativePoly& skNTT, ConstLWECiphertext& ct, LWEPlaintext bit,
+                                               ConstRLWECiphertext& ctEP) const{
+    const auto& RGSWParams1 = params->GetRingGSWParams1();
+    const auto& RLWEParams = params->GetRLWEParams();
+    const auto& Q = RLWEParams->GetQ();
+    uint32_t N = RLWEParams->GetN();
+    uint32_t M = 2 * N;
+    uint32_t numAuto = static_cast<uint32_t>(log2(N));
+    uint32_t numLUT = params->GetDigitsCC();
+    auto bitwidth = static_cast<uint32_t>(std::ceil(std::log2(numLUT)));
+    const auto& Gpow = params->GetRingGSWParams2()->GetAGPower();
+
+    CirBTSNoiseStats res;
+    res.logQ = Q.GetMSB();
+    res.numRuns = 1;
+    res.homtraceLevels.resize(numAuto);
+
+    //MV-FBS; the accumulator encrypts LUT * X^{-phi} for the modulus switched phase
+    //phi = b_MS - <a_MS, s> mod 2N of ct, so that the modulus switching error is not counted
+    NativeVector a_ms;
+    auto acc = InitManyLUTAcc(params, ct, params->GetLUT(), bitwidth, a_ms);
+    BlindRotationWorkspace ws;
+    if (params->GetProductBackend() == FFT_BACKEND)
+        ACCscheme->EvalAccFFT(RGSWParams1, ek.FFTkey, acc, a_ms, ws);
+    else
+        ACCscheme->EvalAcc(RGSWParams1, ek.RFkey, acc, a_ms, ws);
+    std::vector<RLWECiphertext> accs{acc};
+    CorrectRoundToOdd(params, ek, accs);
+
+    const auto& s = LWEsk->GetElement();
+    const auto& q = s.GetModulus();
+    uint64_t phi = SpecilMS(ct->GetB(), NativeInteger(M), params->GetLWEParams()->Getq(), bitwidth).ConvertToInt();
+    bool isLMKCDEY = RGSWParams1->GetMethod() == LMKCDEY;
+    for (uint32_t i = 0; i < a_ms.GetLength(); ++i){
+        //a_MS is negated for LMKCDEY, see InitManyLUTAcc
+        uint64_t ai = a_ms[i].ConvertToInt();
+        if (!isLMKCDEY)
+            ai = (M - ai) % M;
+        uint64_t si = s[i] > (q >> 1) ? M - (q - s[i]).ConvertToInt() % M : s[i].ConvertToInt() % M;
+        phi = (phi + ai * si) % M;
+    }
+    NativePoly expected(params->GetLUT());
+    params->GetMonomials().MultiplyByMonomial(expected, (M - phi) % M);
+    AddError(Phase(acc, skNTT) - expected, res.mvfbs);
+
+    //HomTrace level by level; a level maps the phase p to p + tau(p)
+    auto MV_RLWEs = SplitManyLUT(params, acc);
+    for (uint32_t i = 0; i < numAuto; i++){
+        for (auto& mv : MV_RLWEs){
+            auto before = Phase(mv, skNTT);
+            HomTrace->EvalHTLevel(RLWEParams, ek.HTkey, i, mv);
+            AddError(Phase(mv, skNTT) - (before + before.AutomorphismTransform((N >> i) + 1)), res.homtraceLevels[i]);
+        }
+    }
+
+    //the traced ciphertexts encrypt the constants B^i * bit; scheme switching maps the phase p to -s * p
+    RGSWCiphertextImpl ctGSW(2 * numLUT, 2);
+    for (uint32_t i = 0; i < numLUT; i++){
+        auto& mv = MV_RLWEs[i];
+        auto traced = Phase(mv, skNTT);
+        auto error = traced;
+        error.SetFormat(COEFFICIENT);
+        if (bit)
+            error[0].ModSubFastEq(Gpow[i], Q);
+        AddError(std::move(error), res.homtrace);
+
+        ctGSW[2 * i + 1] = mv->GetElements();
+        SchemeSwitch->EvalSS(RLWEParams, ek.SSkey, mv);
+        ctGSW[2 * i + 0] = mv->GetElements();
+        AddError(Phase(mv, skNTT) + traced * skNTT, res.schemeSwitch);
+    }
+
+    //the external product maps the phase p to bit * p
+    auto prod = std::make_shared<RLWECiphertextImpl>(*ctEP);
+    EvalExternalProductInPlace(params, std::make_shared<RGSWCiphertextImpl>(ctGSW), prod, ws);
+    auto error = Phase(prod, skNTT);
+    if (bit)
+        error -= Phase(ctEP, skNTT);
+    AddError(std::move(error), res.externalProduct);
+    return res;
+}
+
+void CirBTSScheme::AddExternalProduct(const std::shared_ptr<CirBTSCryptoParams>& params, ConstRGSWCiphertext& ctGSW,
+                                      BlindRotationWorkspace& ws, std::vector<NativePoly>& acc, bool overwrite) const{
+    const auto& Q = params->GetRLWEParams()->GetQ();
+    uint32_t digitsCC{params->GetDigitsCC()};
+    auto gBits{static_cast<uint32_t>(__builtin_ctz(params->GetRingGSWParams2()->GetBaseG()))};
+    uint32_t logQ{Q.GetMSB()};
+    if (digitsCC * gBits > logQ)
+        OPENFHE_THROW(config_error, "digits * log2(base) exceeds the bit length of Q");
+    if (ctGSW->GetRowSize() != 2 * digitsCC || ctGSW->GetColSize() != 2)
+        OPENFHE_THROW(config_error, "the RGSW ciphertext does not match the gadget of the circuit computation");
+
+    //dct = (a_0, b_0, ..., a_{d-1}, b_{d-1}) in EVALUATION
+    auto& in  = ws.GetCt();
+    auto& dct = ws.GetDigits();
+    DecomposeSignedDigits(in[0], Q, gBits, logQ - digitsCC * gBits, digitsCC, dct, 0, 2, EVALUATION);
+    DecomposeSignedDigits(in[1], Q, gBits, logQ - digitsCC * gBits, digitsCC, dct, 1, 2, EVALUATION);
+
+    const auto& C = *ctGSW;
+    for (uint32_t c = 0; c < 2; ++c){
+        uint32_t first{0};
+        if (overwrite){
+            acc[c] = dct[0];
+            MultiplyKeyElement(acc[c], C.GetElementData(0, c));
+            first = 1;
+        }
+        for (uint32_t i = first; i < 2 * digitsCC; ++i)
+            MultiplyAddKeyElement(dct[i], C.GetElementData(i, c), acc[c]);
+    }
+}
+
+void CirBTSScheme::CorrectRoundToOdd(const std::shared_ptr<CirBTSCryptoParams>& params, const RingGSWCirBTKey& ek,
+                                     std::vector<RLWECiphertext>& acc) const{
+    const auto& RGSWParams1 = params->GetRingGSWParams1();
+    if (RGSWParams1->GetMethod() != LMKCDEY)
+        return;
+    if (ek.RTOkey == nullptr)
+        OPENFHE_THROW(config_error, "the round-to-odd correction key has not been generated. Please call CirBTKeyGen");
+    auto LMKCDEYscheme = std::static_pointer_cast<RingGSWAccumulatorLMKCDEY>(ACCscheme);
+    uint32_t numAcc = acc.size();
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(numAcc)) if (!omp_in_parallel())
+    for(uint32_t i = 0; i < numAcc; i++){
+        CirBTSPerfScope perf(STAGE_ROUND_TO_ODD);
+        LMKCDEYscheme->EvalRoundToOdd(RGSWParams1, ek.RTOkey, acc[i]);
+    }
+}
+
+RGSWCiphertext CirBTSScheme::ConvertToRGSW(const std::shared_ptr<CirBTSCryptoParams>& params, const RingGSWCirBTKey& ek,
+                                           RLWECiphertext& acc) const{
+    auto MV_RLWEs = SplitManyLUT(params, acc);
+    //Homtrace
+    HomTrace->EvalHTBatch(params->GetRLWEParams(), ek.HTkey, MV_RLWEs);
+    return SchemeSwitchToRGSW(params, ek, MV_RLWEs);
+}
+
+std::vector<RLWECiphertext> CirBTSScheme::SplitManyLUT(const std::shared_ptr<CirBTSCryptoParams>& params,
+                                                       RLWECiphertext& acc) const{
+    auto numLUT = params->GetDigitsCC();
+
     auto Q = params->GetRingGSWParams1()->GetQ();
     auto N = params->GetRingGSWParams1()->GetN();
     const auto& Gpow = params->GetRingGSWParams2()->GetAGPower();
-    auto polyparams = params->GetRingGSWParams1()->GetPolyParams();
 
     NativeInteger N_inv = NativeInteger(N).ModInverse(Q);
-    auto LUT = params->GetLUT();
-    //std::chrono::system_clock::time_point start, end;
-    //MV-FBS
-    //start = std::chrono::system_clock::now();
-    //auto LUT = params->GetLUT();
-    auto acc{BootstrapManyLUT(params, ek.RFkey, ct, LUT, bitwidth)};
-    //end = std::chrono::system_clock::now();
-    //double elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-    //std::cout << "MV-FBS的时间为：" << elapsed << std::endl;
     acc->GetElements()[0] = acc->GetElements()[0].Times(N_inv);
     acc->GetElements()[1] = acc->GetElements()[1].Times(N_inv);
     acc->GetElements()[1].SetFormat(COEFFICIENT);
@@ -46,27 +466,32 @@ RGSWCiphertext CirBTSScheme::CircuitBootstrap(const std::shared_ptr<CirBTSCrypto
         acc->GetElements()[1][i].ModAddEq(temp.ModMulEq(N_inv, Q), Q);
     }
     acc->GetElements()[1].SetFormat(EVALUATION);
-    
-    auto& RLWEParams = params->GetRLWEParams();
-    std::vector<RLWECiphertextImpl> MV_RLWEs(numLUT);
-    std::vector<NativePoly> RLWE = {acc->GetElements()[0], acc->GetElements()[1]};
-    MV_RLWEs[0] = RLWECiphertextImpl(RLWE);
 
+    const auto& monomials = params->GetMonomials();
+    uint32_t M = 2 * N;
+    std::vector<RLWECiphertext> MV_RLWEs(numLUT);
     for(uint32_t i = 1; i < numLUT; i++){
         //acc*X^{-i}
-        auto temp = params->GetMonomial(i);
-        std::vector<NativePoly> RLWE = {acc->GetElements()[0] * temp, acc->GetElements()[1] * temp};
-        MV_RLWEs[i] = RLWECiphertextImpl(RLWE);
+        std::vector<NativePoly> RLWE(acc->GetElements());
+        monomials.MultiplyByMonomial(RLWE[0], M - i);
+        monomials.MultiplyByMonomial(RLWE[1], M - i);
+        MV_RLWEs[i] = std::make_shared<RLWECiphertextImpl>(std::move(RLWE));
     }
+    MV_RLWEs[0] = acc;
+    return MV_RLWEs;
+}
 
+RGSWCiphertext CirBTSScheme::SchemeSwitchToRGSW(const std::shared_ptr<CirBTSCryptoParams>& params,
+                                                const RingGSWCirBTKey& ek,
+                                                std::vector<RLWECiphertext>& MV_RLWEs) const{
+    CirBTSPerfScope perf(STAGE_SCHEME_SWITCH);
+    auto& RLWEParams = params->GetRLWEParams();
+    uint32_t numLUT = MV_RLWEs.size();
     uint32_t numLUT2 = numLUT * 2;
     RGSWCiphertextImpl res(numLUT2, 2);
-    //start = std::chrono::system_clock::now();
-#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(numLUT))
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(numLUT)) if (!omp_in_parallel())
     for(uint32_t i = 0; i < numLUT; i++){
-        auto mv_i = std::make_shared<RLWECiphertextImpl>(std::move(MV_RLWEs[i]));
-        //Homtrace
-        HomTrace->EvalHT(RLWEParams, ek.HTkey, mv_i);
+        auto& mv_i = MV_RLWEs[i];
         //In OpenFHE, gadget(a,b)=(a0,b0,a1,b1...)
         //so RGSW(m) = (RLWE(-skB^km),RLWE(B^km),RLWE(-skB^(k+1)m),RLWE(B^(k+1)m),...)
         res[2 * i + 1] = mv_i->GetElements();
@@ -74,10 +499,7 @@ RGSWCiphertext CirBTSScheme::CircuitBootstrap(const std::shared_ptr<CirBTSCrypto
         SchemeSwitch->EvalSS(RLWEParams, ek.SSkey, mv_i);
         res[2 * i + 0] = mv_i->GetElements();
     }
-    //end = std::chrono::system_clock::now();
-    //elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-    //std::cout << "HomTrace和Scheme Switch的时间为：" << elapsed << std::endl;
-    
+
     return std::make_shared<RGSWCiphertextImpl>(res);
 }
 
@@ -93,23 +515,114 @@ RLWECiphertext CirBTSScheme::BootstrapManyLUT(const std::shared_ptr<CirBTSCrypto
             OPENFHE_THROW(config_error, errMsg);
     }
 
+    NativeVector a_ms;
+    auto acc = InitManyLUTAcc(params, ct, LUT, bitwidth, a_ms);
+    {
+        CirBTSPerfScope perf(STAGE_BLIND_ROTATION);
+        ACCscheme->EvalAcc(params->GetRingGSWParams1(), ek, acc, a_ms);
+    }
+
+    return acc;
+}
+
+std::vector<RLWECiphertext> CirBTSScheme::BootstrapManyLUTBatch(const std::shared_ptr<CirBTSCryptoParams>& params,
+                                                                ConstRingGSWACCKey& ek,
+                                                                const std::vector<LWECiphertext>& ct,
+                                                                const NativePoly& LUT, uint32_t bitwidth) const{
+    if (ek == nullptr) {
+        std::string errMsg =
+            "Bootstrapping keys have not been generated. Please call BTKeyGen "
+            "before calling bootstrapping.";
+            OPENFHE_THROW(config_error, errMsg);
+    }
+
+    uint32_t numCt = ct.size();
+    if (numCt == 0)
+        return {};
+    std::vector<RLWECiphertext> acc(numCt);
+    std::vector<NativeVector> a_ms(numCt);
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(numCt)) if (!omp_in_parallel())
+    for(uint32_t i = 0; i < numCt; i++){
+        acc[i] = InitManyLUTAcc(params, ct[i], LUT, bitwidth, a_ms[i]);
+    }
+    {
+        CirBTSPerfScope perf(STAGE_BLIND_ROTATION, true, numCt);
+        ACCscheme->EvalAccBatch(params->GetRingGSWParams1(), ek, acc, a_ms);
+    }
+
+    return acc;
+}
+
+RLWECiphertext CirBTSScheme::BootstrapManyLUT(const std::shared_ptr<CirBTSCryptoParams>& params, ConstRingGSWACCFFTKey& ek,
+                            ConstLWECiphertext& ct, const NativePoly& LUT, uint32_t bitwidth) const{
+    if (ek == nullptr) {
+        std::string errMsg =
+            "Bootstrapping keys in the FFT domain have not been generated. Please call BTKeyGen "
+            "with the FFT backend before calling bootstrapping.";
+            OPENFHE_THROW(config_error, errMsg);
+    }
+
+    NativeVector a_ms;
+    auto acc = InitManyLUTAcc(params, ct, LUT, bitwidth, a_ms);
+    BlindRotationWorkspace ws;
+    {
+        CirBTSPerfScope perf(STAGE_BLIND_ROTATION);
+        ACCscheme->EvalAccFFT(params->GetRingGSWParams1(), ek, acc, a_ms, ws);
+    }
+
+    return acc;
+}
+
+std::vector<RLWECiphertext> CirBTSScheme::BootstrapManyLUTBatch(const std::shared_ptr<CirBTSCryptoParams>& params,
+                                                                ConstRingGSWACCFFTKey& ek,
+                                                                const std::vector<LWECiphertext>& ct,
+                                                                const NativePoly& LUT, uint32_t bitwidth) const{
+    if (ek == nullptr) {
+        std::string errMsg =
+            "Bootstrapping keys in the FFT domain have not been generated. Please call BTKeyGen "
+            "with the FFT backend before calling bootstrapping.";
+            OPENFHE_THROW(config_error, errMsg);
+    }
+
+    uint32_t numCt = ct.size();
+    if (numCt == 0)
+        return {};
+    std::vector<RLWECiphertext> acc(numCt);
+    std::vector<NativeVector> a_ms(numCt);
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(numCt)) if (!omp_in_parallel())
+    for(uint32_t i = 0; i < numCt; i++){
+        acc[i] = InitManyLUTAcc(params, ct[i], LUT, bitwidth, a_ms[i]);
+    }
+    {
+        CirBTSPerfScope perf(STAGE_BLIND_ROTATION, true, numCt);
+        ACCscheme->EvalAccBatchFFT(params->GetRingGSWParams1(), ek, acc, a_ms);
+    }
+
+    return acc;
+}
+
+RLWECiphertext CirBTSScheme::InitManyLUTAcc(const std::shared_ptr<CirBTSCryptoParams>& params, ConstLWECiphertext& ct,
+                                            const NativePoly& LUT, uint32_t bitwidth, NativeVector& a_ms) const{
+    CirBTSPerfScope perf(STAGE_MODSWITCH);
     auto& LWEParams = params->GetLWEParams();
     auto q = LWEParams->Getq();
     auto n = LWEParams->Getn();
-    auto& RGSWParams1 = params->GetRingGSWParams1();
-    auto& polyParams = RGSWParams1->GetPolyParams();
+    auto& polyParams = params->GetRingGSWParams1()->GetPolyParams();
     auto N = polyParams->GetRingDimension();
 
-    //Special modulus switching
+    //Special modulus switching; LMKCDEY rotates by -<a, s>, so a is negated, and a is kept
+    //even to make the offset of its round-to-odd independent of a, see CorrectRoundToOdd
     auto b = ct->GetB();
     NativeInteger b_ms = SpecilMS(b, NativeInteger(2 * N), q, bitwidth);
     auto a = ct->GetA();
-    NativeVector a_ms(n, NativeInteger(2 * N));
+    bool isLMKCDEY = params->GetRingGSWParams1()->GetMethod() == LMKCDEY;
+    uint32_t bitwidthA = isLMKCDEY ? std::max(bitwidth, 1u) : bitwidth;
+    a_ms = NativeVector(n, NativeInteger(2 * N));
     for (usint i = 0; i < n; ++i){
-        a_ms[i] = SpecilMS(a[i], NativeInteger(2 * N), q, bitwidth);
+        a_ms[i] = SpecilMS(a[i], NativeInteger(2 * N), q, bitwidthA);
+        if (isLMKCDEY)
+            a_ms[i] = NativeInteger(0).ModSubFast(a_ms[i], NativeInteger(2 * N));
     }
-    auto ct_ms = LWECiphertextImpl(a_ms, b_ms);
-    ct_ms.SetModulus(NativeInteger(2 * N));
 
     //Generate original ACC
     std::vector<NativePoly> res(2);
@@ -117,15 +630,9 @@ RLWECiphertext CirBTSScheme::BootstrapManyLUT(const std::shared_ptr<CirBTSCrypto
     res[1] = LUT;
 
     //Multiply with X^{-b_MS}
-    auto b_momial_inv = params->GetMonomial(b_ms.ConvertToInt<uint32_t>());
-    res[1] = res[1] * b_momial_inv;
-
-    
-    auto acc = std::make_shared<RLWECiphertextImpl>(std::move(res));
+    params->GetMonomials().MultiplyByMonomial(res[1], 2 * N - b_ms.ConvertToInt<uint32_t>());
 
-    ACCscheme->EvalAcc(RGSWParams1, ek, acc, ct_ms.GetA());
-
-    return acc;
+    return std::make_shared<RLWECiphertextImpl>(std::move(res));
 }
 
 NativeInteger CirBTSScheme::SpecilMS(const NativeInteger& v, const NativeInteger& q, const NativeInteger& Q, const uint32_t bitwidth) const{
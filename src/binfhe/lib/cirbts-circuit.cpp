@@ -0,0 +1,274 @@
+#include "cirbts-circuit.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <string>
+
+namespace lbcrypto {
+
+uint32_t CirBTSCircuit::AddLWEInput() {
+    Node node{LWE_INPUT};
+    node.index = m_numLWEInputs++;
+    m_nodes.push_back(std::move(node));
+    return m_nodes.size() - 1;
+}
+
+uint32_t CirBTSCircuit::AddRLWEInput() {
+    Node node{RLWE_INPUT};
+    node.index = m_numRLWEInputs++;
+    m_nodes.push_back(std::move(node));
+    return m_nodes.size() - 1;
+}
+
+uint32_t CirBTSCircuit::AddCMux(uint32_t sel, uint32_t ct0, uint32_t ct1) {
+    Node node{CMUX_NODE};
+    node.sel = {sel};
+    node.ct  = {ct0, ct1};
+    return AddGate(std::move(node));
+}
+
+uint32_t CirBTSCircuit::AddExternalProduct(uint32_t sel, uint32_t ct) {
+    Node node{EXTPROD_NODE};
+    node.sel = {sel};
+    node.ct  = {ct};
+    return AddGate(std::move(node));
+}
+
+uint32_t CirBTSCircuit::AddLUT(const std::vector<uint32_t>& sel, const std::vector<uint64_t>& table,
+                               uint32_t numOutputBits) {
+    if (sel.empty() || sel.size() >= 64 || table.size() > (uint64_t(1) << sel.size()))
+        OPENFHE_THROW(config_error, "the table has more entries than the selector bits can address");
+    Node node{LUT_NODE};
+    node.sel           = sel;
+    node.table         = table;
+    node.numOutputBits = numOutputBits;
+    return AddGate(std::move(node));
+}
+
+void CirBTSCircuit::MarkOutput(uint32_t node) {
+    if (node >= m_nodes.size() || m_nodes[node].type == LWE_INPUT)
+        OPENFHE_THROW(config_error, "the outputs of a circuit must be RLWE nodes");
+    m_outputs.push_back(node);
+}
+
+void CirBTSCircuit::CheckNode(uint32_t node, CIRCUIT_NODE_TYPE type) const {
+    // a node can only refer to the nodes added before it, so the circuit has no cycle
+    if (node >= m_nodes.size())
+        OPENFHE_THROW(config_error, "the node " + std::to_string(node) + " does not exist");
+    bool isWire = m_nodes[node].type == LWE_INPUT;
+    if (isWire != (type == LWE_INPUT))
+        OPENFHE_THROW(config_error, "the node " + std::to_string(node) +
+                                        (isWire ? " is an LWE wire, an RLWE node is expected" :
+                                                  " is an RLWE node, an LWE wire is expected"));
+}
+
+uint32_t CirBTSCircuit::AddGate(Node&& node) {
+    for (auto s : node.sel)
+        CheckNode(s, LWE_INPUT);
+    for (auto c : node.ct)
+        CheckNode(c, RLWE_INPUT);
+    node.wires = node.sel;
+    std::sort(node.wires.begin(), node.wires.end());
+    node.wires.erase(std::unique(node.wires.begin(), node.wires.end()), node.wires.end());
+    node.inputs = node.ct;
+    std::sort(node.inputs.begin(), node.inputs.end());
+    node.inputs.erase(std::unique(node.inputs.begin(), node.inputs.end()), node.inputs.end());
+    m_nodes.push_back(std::move(node));
+    return m_nodes.size() - 1;
+}
+
+std::vector<bool> CirBTSCircuit::GetNeeded() const {
+    std::vector<bool> needed(m_nodes.size(), false);
+    for (auto o : m_outputs)
+        needed[o] = true;
+    // the dependencies of a node have smaller ids
+    for (uint32_t i = m_nodes.size(); i-- > 0;) {
+        if (!needed[i])
+            continue;
+        for (auto w : m_nodes[i].wires)
+            needed[w] = true;
+        for (auto c : m_nodes[i].inputs)
+            needed[c] = true;
+    }
+    return needed;
+}
+
+uint32_t CirBTSCircuit::GetNumBootstraps() const {
+    auto needed = GetNeeded();
+    uint32_t numBootstraps{0};
+    for (uint32_t i = 0; i < m_nodes.size(); ++i)
+        numBootstraps += needed[i] && m_nodes[i].type == LWE_INPUT;
+    return numBootstraps;
+}
+
+/**
+ * @brief State of one evaluation of a circuit: the values of the nodes, the number of missing
+ * dependencies of every gate and the number of pending consumers of every value
+ */
+class CirBTSCircuitExecution {
+public:
+    CirBTSCircuitExecution(const CirBTSCircuit& circuit, const CirBTSContext& cc,
+                           const std::vector<LWECiphertext>& bits, const std::vector<RLWECiphertext>& cts)
+        : m_circuit(circuit),
+          m_cc(cc),
+          m_bits(bits),
+          m_nodes(circuit.m_nodes),
+          m_needed(circuit.GetNeeded()),
+          m_rgsw(m_nodes.size()),
+          m_values(m_nodes.size()),
+          m_consumers(m_nodes.size()),
+          m_missing(m_nodes.size()),
+          m_uses(m_nodes.size()) {
+        std::vector<uint32_t> uses(m_nodes.size(), 0);
+        for (uint32_t i = 0; i < m_nodes.size(); ++i) {
+            const auto& node = m_nodes[i];
+            if (!m_needed[i])
+                continue;
+            if (node.type == RLWE_INPUT)
+                m_values[i] = cts[node.index];
+            if (node.type == LWE_INPUT || node.type == RLWE_INPUT)
+                continue;
+            uint32_t missing = node.wires.size();
+            for (auto w : node.wires)
+                m_consumers[w].push_back(i);
+            for (auto c : node.inputs) {
+                ++uses[c];
+                if (m_nodes[c].type != RLWE_INPUT) {
+                    m_consumers[c].push_back(i);
+                    ++missing;
+                }
+            }
+            for (auto w : node.wires)
+                ++uses[w];
+            m_missing[i].store(missing, std::memory_order_relaxed);
+        }
+        // the outputs are never released
+        for (auto o : circuit.m_outputs)
+            ++uses[o];
+        for (uint32_t i = 0; i < m_nodes.size(); ++i)
+            m_uses[i].store(uses[i], std::memory_order_relaxed);
+    }
+
+    std::vector<RLWECiphertext> Run() {
+        // the team runs the bootstraps and the gates, whose own parallel regions are serialized
+        // inside it, so it is sized by all the tasks rather than by the wires
+        uint32_t numTasks{0};
+        for (uint32_t i = 0; i < m_nodes.size(); ++i)
+            numTasks += m_needed[i] && m_nodes[i].type != RLWE_INPUT;
+
+        // every gate depends on at least one wire, so the bootstraps are the initial tasks
+#pragma omp parallel num_threads(OpenFHEParallelControls.GetThreadLimit(std::max(numTasks, 1u)))
+        {
+#pragma omp single
+            {
+                for (uint32_t i = 0; i < m_nodes.size(); ++i) {
+                    if (m_needed[i] && m_nodes[i].type == LWE_INPUT)
+                        Spawn(i);
+                }
+            }
+        }
+        if (m_error)
+            std::rethrow_exception(m_error);
+
+        std::vector<RLWECiphertext> res;
+        for (auto o : m_circuit.m_outputs)
+            res.push_back(m_values[o]);
+        return res;
+    }
+
+private:
+    void Spawn(uint32_t node) {
+#pragma omp task firstprivate(node)
+        {
+            Execute(node);
+        }
+    }
+
+    void Execute(uint32_t i) {
+        if (m_failed.load(std::memory_order_acquire))
+            return;
+        try {
+            const auto& node = m_nodes[i];
+            if (node.type == LWE_INPUT) {
+                m_rgsw[i] = m_cc.CircuitBootstrapping(m_bits[node.index]);
+            }
+            else {
+                Evaluate(node, m_values[i]);
+                for (auto w : node.wires)
+                    Release(w);
+                for (auto c : node.inputs)
+                    Release(c);
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(m_errorMutex);
+            if (!m_error)
+                m_error = std::current_exception();
+            m_failed.store(true, std::memory_order_release);
+            return;
+        }
+        // the consumers whose last dependency is this node become ready
+        for (auto c : m_consumers[i]) {
+            if (m_missing[c].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                Spawn(c);
+        }
+    }
+
+    void Evaluate(const CirBTSCircuit::Node& node, RLWECiphertext& res) {
+        BlindRotationWorkspace ws;
+        switch (node.type) {
+            case CMUX_NODE:
+                res = std::make_shared<RLWECiphertextImpl>(*m_values[node.ct[0]]);
+                m_cc.EvalCMuxInPlace(m_rgsw[node.sel[0]], res, m_values[node.ct[1]], ws);
+                break;
+            case EXTPROD_NODE:
+                res = std::make_shared<RLWECiphertextImpl>(*m_values[node.ct[0]]);
+                m_cc.EvalExternalProductInPlace(m_rgsw[node.sel[0]], res, ws);
+                break;
+            case LUT_NODE: {
+                std::vector<RGSWCiphertext> sel(node.sel.size());
+                for (uint32_t j = 0; j < sel.size(); ++j)
+                    sel[j] = m_rgsw[node.sel[j]];
+                res = m_cc.EvalLUT(sel, node.table, node.numOutputBits);
+                break;
+            }
+            default:
+                OPENFHE_THROW("unexpected node type " + std::to_string(node.type));
+        }
+    }
+
+    // the value of a node is dropped once all its consumers are done
+    void Release(uint32_t i) {
+        if (m_uses[i].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            m_rgsw[i].reset();
+            m_values[i].reset();
+        }
+    }
+
+    const CirBTSCircuit& m_circuit;
+    const CirBTSContext& m_cc;
+    const std::vector<LWECiphertext>& m_bits;
+    const std::vector<CirBTSCircuit::Node>& m_nodes;
+    std::vector<bool> m_needed;
+    std::vector<RGSWCiphertext> m_rgsw;
+    std::vector<RLWECiphertext> m_values;
+    std::vector<std::vector<uint32_t>> m_consumers;
+    std::vector<std::atomic<uint32_t>> m_missing;
+    std::vector<std::atomic<uint32_t>> m_uses;
+    std::atomic<bool> m_failed{false};
+    std::mutex m_errorMutex;
+    std::exception_ptr m_error;
+};
+
+std::vector<RLWECiphertext> CirBTSCircuit::Evaluate(const CirBTSContext& cc, const std::vector<LWECiphertext>& bits,
+                                                    const std::vector<RLWECiphertext>& cts) const {
+    if (bits.size() != m_numLWEInputs || cts.size() != m_numRLWEInputs)
+        OPENFHE_THROW(config_error, "the number of inputs does not match the circuit");
+    if (m_outputs.empty())
+        return {};
+    return CirBTSCircuitExecution(*this, cc, bits, cts).Run();
+}
+
+}  // namespace lbcrypto
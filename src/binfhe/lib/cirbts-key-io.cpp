@@ -0,0 +1,552 @@
+#include "cirbts-key-io.h"
+
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace lbcrypto {
+
+static_assert(sizeof(NativeInteger) == sizeof(uint64_t), "the raw key format stores one word per coefficient");
+
+namespace {
+
+enum : uint64_t { RF_KEY = 1, HT_KEY = 2, SS_KEY = 4, RTO_KEY = 8 };
+
+void WriteWord(std::ostream& os, uint64_t w) {
+    os.write(reinterpret_cast<const char*>(&w), sizeof(w));
+}
+
+uint64_t ReadWord(std::istream& is) {
+    uint64_t w = 0;
+    if (!is.read(reinterpret_cast<char*>(&w), sizeof(w)))
+        OPENFHE_THROW("unexpected end of the circuit bootstrapping key stream");
+    return w;
+}
+
+// a key is written seeded if it has one seed per row and its uniform column is still the
+// expansion of the seeds, i.e., in Format::EVALUATION
+bool IsSeeded(ConstRingGSWEvalKey& ek) {
+    if (ek->IsView())
+        return false;
+    const auto& elements = ek->GetElements();
+    const auto& seeds    = ek->GetSeeds();
+    if (seeds.empty() || seeds.size() != elements.size())
+        return false;
+    for (const auto& row : elements) {
+        if (row.empty() || row[0].GetFormat() != Format::EVALUATION)
+            return false;
+    }
+    return true;
+}
+
+// the elements of views are in Format::EVALUATION
+Format GetElementFormat(ConstRingGSWEvalKey& ek, uint32_t i, uint32_t j) {
+    return ek->IsView() ? Format::EVALUATION : (*ek)[i][j].GetFormat();
+}
+
+// the coefficients of the element (i, j) in its own format
+const NativeInteger* GetElementCoefficients(ConstRingGSWEvalKey& ek, uint32_t i, uint32_t j) {
+    return ek->IsView() ? ek->GetElementData(i, j) : &(*ek)[i][j][0];
+}
+
+void CheckRows(ConstRingGSWEvalKey& ek) {
+    if (ek->IsView())
+        return;
+    uint32_t cols{ek->GetColSize()};
+    for (const auto& row : ek->GetElements()) {
+        if (row.size() != cols)
+            OPENFHE_THROW("the rows of an RGSW key must have the same length");
+    }
+}
+
+// the expected shape of an accumulator key: its dimensions and the rows of its RGSW keys, 0 for
+// the slots that must be empty
+struct ACCShape {
+    uint64_t dims[3]{0, 0, 0};
+    uint64_t rows{0};
+    // LMKCDEY: the rows of the automorphism keys [0][1][k], which exist for k <= numAuto
+    uint64_t autoRows{0};
+    uint64_t numAuto{0};
+
+    uint64_t GetRows(uint64_t j, uint64_t k) const {
+        if (autoRows != 0 && j == 1)
+            return k <= numAuto ? autoRows : 0;
+        return rows;
+    }
+};
+
+// the shapes of the keys KeyGen generates for the parameters; every RGSW key has 2 columns
+struct KeyShapes {
+    ACCShape rf;
+    ACCShape ht;
+    uint64_t ssRows{0};
+    uint64_t rtoRows{0};
+};
+
+KeyShapes GetKeyShapes(const std::shared_ptr<CirBTSCryptoParams>& params) {
+    const auto& RGSWParams1 = params->GetRingGSWParams1();
+    const auto& RLWEParams  = params->GetRLWEParams();
+    uint64_t n{params->GetLWEParams()->Getn()};
+    KeyShapes shapes;
+    if (RGSWParams1->GetMethod() == LMKCDEY) {
+        // the first digit of the LMKCDEY gadget is ignored
+        uint64_t digits{RGSWParams1->GetDigitsG() - 1};
+        shapes.rf.dims[0]  = 1;
+        shapes.rf.dims[1]  = 2;
+        shapes.rf.dims[2]  = n;
+        shapes.rf.rows     = 2 * digits;
+        shapes.rf.autoRows = digits;
+        shapes.rf.numAuto  = RGSWParams1->GetNumAutoKeys();
+        shapes.rtoRows     = 2 * digits;
+    }
+    else {
+        uint64_t unroll{RGSWParams1->GetKeyUnrollFactor()};
+        shapes.rf.dims[0] = 1;
+        shapes.rf.dims[1] = (uint64_t(1) << unroll) - 1;
+        shapes.rf.dims[2] = (n + unroll - 1) / unroll;
+        shapes.rf.rows    = 2 * RGSWParams1->GetDigitsGA();
+    }
+    shapes.ht.dims[0] = 1;
+    shapes.ht.dims[1] = 1;
+    shapes.ht.dims[2] = GetMSB(RLWEParams->GetN()) - 1;
+    shapes.ht.rows    = RLWEParams->GetDigitsHTA();
+    shapes.ssRows     = RLWEParams->GetDigitsSSA();
+    return shapes;
+}
+
+void CheckEvalKeyShape(uint64_t rows, uint64_t cols, uint64_t expectedRows) {
+    if (rows != expectedRows || cols != 2)
+        OPENFHE_THROW("the circuit bootstrapping keys were generated for different parameters: an RGSW key has " +
+                      std::to_string(rows) + "x" + std::to_string(cols) + " elements instead of " +
+                      std::to_string(expectedRows) + "x2");
+}
+
+void CheckACCKeyShape(uint64_t dim1, uint64_t dim2, uint64_t dim3, const ACCShape& shape) {
+    if (dim1 != shape.dims[0] || dim2 != shape.dims[1] || dim3 != shape.dims[2])
+        OPENFHE_THROW("the circuit bootstrapping keys were generated for different parameters: an accumulator key has "
+                      "the dimensions " + std::to_string(dim1) + "x" + std::to_string(dim2) + "x" + std::to_string(dim3) +
+                      " instead of " + std::to_string(shape.dims[0]) + "x" + std::to_string(shape.dims[1]) + "x" +
+                      std::to_string(shape.dims[2]));
+}
+
+void CheckSlot(bool present, uint64_t expectedRows) {
+    if (present != (expectedRows != 0))
+        OPENFHE_THROW("the circuit bootstrapping keys were generated for different parameters: an accumulator key " +
+                      std::string(present ? "has an unexpected" : "misses a") + " key");
+}
+
+void WriteEvalKey(std::ostream& os, ConstRingGSWEvalKey& ek, uint32_t N) {
+    CheckRows(ek);
+    uint32_t rows{ek->GetRowSize()};
+    uint32_t cols{ek->GetColSize()};
+    bool seeded = IsSeeded(ek);
+    WriteWord(os, rows);
+    WriteWord(os, cols);
+    WriteWord(os, seeded);
+    for (uint32_t i = 0; i < rows; ++i) {
+        if (seeded)
+            os.write(reinterpret_cast<const char*>(ek->GetSeeds()[i].data()), sizeof(PolySeed));
+        for (uint32_t j = seeded ? 1 : 0; j < cols; ++j) {
+            WriteWord(os, GetElementFormat(ek, i, j));
+            os.write(reinterpret_cast<const char*>(GetElementCoefficients(ek, i, j)), N * sizeof(uint64_t));
+        }
+    }
+}
+
+// the uniform columns of seeded keys are expanded after the whole stream is read
+struct SeededPolys {
+    std::vector<RingGSWEvalKey> keys;
+
+    void Expand(const std::shared_ptr<ILNativeParams>& polyParams) {
+        uint32_t numKeys = keys.size();
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(numKeys))
+        for (uint32_t k = 0; k < numKeys; ++k) {
+            auto& ek          = *keys[k];
+            const auto& seeds = ek.GetSeeds();
+            for (size_t i = 0; i < seeds.size(); ++i)
+                ek[i][0] = SeededUniformGenerator::Expand(polyParams, seeds[i]);
+        }
+    }
+};
+
+RingGSWEvalKey ReadEvalKey(std::istream& is, const std::shared_ptr<ILNativeParams>& polyParams, uint64_t version,
+                           SeededPolys& seeded, uint64_t expectedRows) {
+    uint64_t rows = ReadWord(is);
+    uint64_t cols = ReadWord(is);
+    CheckEvalKeyShape(rows, cols, expectedRows);
+    bool isSeeded = version > 1 && ReadWord(is);
+    const std::streamsize bytes = polyParams->GetRingDimension() * sizeof(uint64_t);
+    auto ek = std::make_shared<RingGSWEvalKeyImpl>(rows, cols);
+    std::vector<PolySeed> seeds(isSeeded ? rows : 0);
+    for (uint64_t i = 0; i < rows; ++i) {
+        if (isSeeded && !is.read(reinterpret_cast<char*>(seeds[i].data()), sizeof(PolySeed)))
+            OPENFHE_THROW("unexpected end of the circuit bootstrapping key stream");
+        for (uint64_t j = isSeeded ? 1 : 0; j < cols; ++j) {
+            uint64_t format = ReadWord(is);
+            if (format != EVALUATION && format != COEFFICIENT)
+                OPENFHE_THROW("invalid polynomial format in the circuit bootstrapping key stream");
+            NativePoly poly(polyParams, static_cast<Format>(format), true);
+            if (!is.read(reinterpret_cast<char*>(&poly[0]), bytes))
+                OPENFHE_THROW("unexpected end of the circuit bootstrapping key stream");
+            (*ek)[i][j] = std::move(poly);
+        }
+    }
+    if (isSeeded) {
+        ek->SetSeeds(std::move(seeds));
+        seeded.keys.push_back(ek);
+    }
+    return ek;
+}
+
+void WriteACCKey(std::ostream& os, ConstRingGSWACCKey& ek, uint32_t N) {
+    const auto& key = ek->GetElements();
+    uint64_t dim2   = key.empty() ? 0 : key[0].size();
+    uint64_t dim3   = dim2 == 0 ? 0 : key[0][0].size();
+    WriteWord(os, key.size());
+    WriteWord(os, dim2);
+    WriteWord(os, dim3);
+    for (const auto& k1 : key) {
+        for (const auto& k2 : k1) {
+            if (k1.size() != dim2 || k2.size() != dim3)
+                OPENFHE_THROW("the dimensions of an accumulator key must be uniform");
+            for (const auto& k3 : k2) {
+                WriteWord(os, k3 != nullptr);
+                if (k3 != nullptr)
+                    WriteEvalKey(os, k3, N);
+            }
+        }
+    }
+}
+
+RingGSWACCKey ReadACCKey(std::istream& is, const std::shared_ptr<ILNativeParams>& polyParams, uint64_t version,
+                         SeededPolys& seeded, const ACCShape& shape) {
+    uint64_t dim1 = ReadWord(is);
+    uint64_t dim2 = ReadWord(is);
+    uint64_t dim3 = ReadWord(is);
+    CheckACCKeyShape(dim1, dim2, dim3, shape);
+    auto ek = std::make_shared<RingGSWACCKeyImpl>(dim1, dim2, dim3);
+    for (uint64_t i = 0; i < dim1; ++i) {
+        for (uint64_t j = 0; j < dim2; ++j) {
+            for (uint64_t k = 0; k < dim3; ++k) {
+                uint64_t rows{shape.GetRows(j, k)};
+                bool present = ReadWord(is);
+                CheckSlot(present, rows);
+                if (present)
+                    (*ek)[i][j][k] = ReadEvalKey(is, polyParams, version, seeded, rows);
+            }
+        }
+    }
+    return ek;
+}
+
+}  // namespace
+
+void CirBTSKeyIO::Write(std::ostream& os, const std::shared_ptr<CirBTSCryptoParams>& params, const RingGSWCirBTKey& ek) {
+    const auto& RGSWParams1 = params->GetRingGSWParams1();
+    uint64_t mask           = (ek.RFkey != nullptr ? RF_KEY : 0) | (ek.HTkey != nullptr ? HT_KEY : 0) |
+                    (ek.SSkey != nullptr ? SS_KEY : 0) | (ek.RTOkey != nullptr ? RTO_KEY : 0);
+
+    WriteWord(os, MAGIC);
+    WriteWord(os, VERSION);
+    WriteWord(os, RGSWParams1->GetN());
+    WriteWord(os, RGSWParams1->GetQ().ConvertToInt());
+    WriteWord(os, RGSWParams1->GetMethod());
+    WriteWord(os, mask);
+    uint32_t N1{RGSWParams1->GetN()};
+    uint32_t N{params->GetRLWEParams()->GetN()};
+    if (ek.RFkey != nullptr)
+        WriteACCKey(os, ek.RFkey, N1);
+    if (ek.HTkey != nullptr)
+        WriteACCKey(os, ek.HTkey, N);
+    if (ek.SSkey != nullptr)
+        WriteEvalKey(os, ek.SSkey, N);
+    if (ek.RTOkey != nullptr)
+        WriteEvalKey(os, ek.RTOkey, N1);
+    if (!os)
+        OPENFHE_THROW("failed to write the circuit bootstrapping keys");
+}
+
+RingGSWCirBTKey CirBTSKeyIO::Read(std::istream& is, const std::shared_ptr<CirBTSCryptoParams>& params) {
+    const auto& RGSWParams1 = params->GetRingGSWParams1();
+    if (ReadWord(is) != MAGIC)
+        OPENFHE_THROW("the stream does not contain circuit bootstrapping keys");
+    uint64_t version = ReadWord(is);
+    if (version > VERSION)
+        OPENFHE_THROW("serialized object version " + std::to_string(version) + " is from a later version of the library");
+    if (ReadWord(is) != RGSWParams1->GetN() || ReadWord(is) != RGSWParams1->GetQ().ConvertToInt() ||
+        ReadWord(is) != static_cast<uint64_t>(RGSWParams1->GetMethod()))
+        OPENFHE_THROW("the circuit bootstrapping keys were generated for different parameters");
+    uint64_t mask = ReadWord(is);
+
+    const auto& polyParams1 = RGSWParams1->GetPolyParams();
+    const auto& polyParams  = params->GetRLWEParams()->GetPolyParams();
+    // the header only identifies the ring; the gadgets are checked against the shape of every key
+    auto shapes = GetKeyShapes(params);
+    if ((mask & RTO_KEY) && shapes.rtoRows == 0)
+        OPENFHE_THROW("the circuit bootstrapping keys were generated for different parameters");
+    SeededPolys seeded1, seeded;
+    RingGSWCirBTKey ek{};
+    if (mask & RF_KEY)
+        ek.RFkey = ReadACCKey(is, polyParams1, version, seeded1, shapes.rf);
+    if (mask & HT_KEY)
+        ek.HTkey = ReadACCKey(is, polyParams, version, seeded, shapes.ht);
+    if (mask & SS_KEY)
+        ek.SSkey = ReadEvalKey(is, polyParams, version, seeded, shapes.ssRows);
+    if (mask & RTO_KEY)
+        ek.RTOkey = ReadEvalKey(is, polyParams1, version, seeded1, shapes.rtoRows);
+    seeded1.Expand(polyParams1);
+    seeded.Expand(polyParams);
+    return ek;
+}
+
+namespace {
+
+// the header of a mappable file and the blocks of its data region in file order
+struct MapLayout {
+    std::vector<uint64_t> header;
+    std::vector<std::shared_ptr<const RingGSWEvalKeyImpl>> keys;
+    std::vector<uint32_t> ringDims;
+    uint64_t dataSize = 0;
+
+    void AddEvalKey(ConstRingGSWEvalKey& ek, uint32_t N) {
+        CheckRows(ek);
+        uint64_t rows{ek->GetRowSize()};
+        uint64_t cols{ek->GetColSize()};
+        header.push_back(rows);
+        header.push_back(cols);
+        header.push_back(dataSize);
+        keys.push_back(ek);
+        ringDims.push_back(N);
+        dataSize += rows * cols * N * sizeof(uint64_t);
+    }
+
+    void AddACCKey(ConstRingGSWACCKey& ek, uint32_t N) {
+        const auto& key = ek->GetElements();
+        uint64_t dim2   = key.empty() ? 0 : key[0].size();
+        uint64_t dim3   = dim2 == 0 ? 0 : key[0][0].size();
+        header.push_back(key.size());
+        header.push_back(dim2);
+        header.push_back(dim3);
+        for (const auto& k1 : key) {
+            for (const auto& k2 : k1) {
+                if (k1.size() != dim2 || k2.size() != dim3)
+                    OPENFHE_THROW("the dimensions of an accumulator key must be uniform");
+                for (const auto& k3 : k2) {
+                    header.push_back(k3 != nullptr);
+                    if (k3 != nullptr)
+                        AddEvalKey(k3, N);
+                }
+            }
+        }
+    }
+};
+
+#if defined(__unix__) || defined(__APPLE__)
+// read-only shared mapping of a whole file, unmapped when the last key view is released
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            OPENFHE_THROW("cannot open the circuit bootstrapping key file " + filename);
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            close(fd);
+            OPENFHE_THROW("cannot read the size of the circuit bootstrapping key file " + filename);
+        }
+        m_size = st.st_size;
+        void* addr{mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0)};
+        close(fd);
+        if (addr == MAP_FAILED)
+            OPENFHE_THROW("cannot map the circuit bootstrapping key file " + filename);
+        m_addr = addr;
+    }
+
+    ~MappedFile() {
+        munmap(m_addr, m_size);
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint64_t* GetWords() const {
+        return static_cast<const uint64_t*>(m_addr);
+    }
+
+    size_t GetSize() const {
+        return m_size;
+    }
+
+private:
+    void* m_addr{nullptr};
+    size_t m_size{0};
+};
+
+// walks the header of a mapped file and creates the key views into its data region
+class MapReader {
+public:
+    explicit MapReader(const std::shared_ptr<const MappedFile>& file) : m_file(file) {
+        if (file->GetSize() < 8 * sizeof(uint64_t))
+            OPENFHE_THROW("the file does not contain circuit bootstrapping keys");
+        m_headerWords = 8;
+    }
+
+    uint64_t Next() {
+        if (m_pos >= m_headerWords)
+            OPENFHE_THROW("unexpected end of the header of the circuit bootstrapping key file");
+        return m_file->GetWords()[m_pos++];
+    }
+
+    // the data region is known once the fixed part of the header is read
+    void SetDataRegion(uint64_t dataOffset, uint64_t dataSize) {
+        if (dataOffset % CirBTSKeyIO::MAP_ALIGNMENT != 0 || dataOffset > m_file->GetSize() ||
+            dataSize > m_file->GetSize() - dataOffset)
+            OPENFHE_THROW("the circuit bootstrapping key file is truncated");
+        m_headerWords = dataOffset / sizeof(uint64_t);
+        m_dataOffset  = dataOffset;
+        m_dataSize    = dataSize;
+    }
+
+    // the views have no bounds checks, so the shape is checked before the view is created
+    RingGSWEvalKey NextEvalKey(const std::shared_ptr<ILNativeParams>& polyParams, uint64_t expectedRows) {
+        uint64_t rows{Next()};
+        uint64_t cols{Next()};
+        uint64_t offset{Next()};
+        CheckEvalKeyShape(rows, cols, expectedRows);
+        uint64_t bytes{rows * cols * polyParams->GetRingDimension() * sizeof(uint64_t)};
+        if (offset % sizeof(uint64_t) != 0 || offset > m_dataSize || bytes > m_dataSize - offset)
+            OPENFHE_THROW("invalid key offset in the circuit bootstrapping key file");
+        const auto* data{reinterpret_cast<const NativeInteger*>(m_file->GetWords() +
+                                                               (m_dataOffset + offset) / sizeof(uint64_t))};
+        return std::make_shared<RingGSWEvalKeyImpl>(rows, cols, polyParams, data, m_file);
+    }
+
+    RingGSWACCKey NextACCKey(const std::shared_ptr<ILNativeParams>& polyParams, const ACCShape& shape) {
+        uint64_t dim1 = Next();
+        uint64_t dim2 = Next();
+        uint64_t dim3 = Next();
+        CheckACCKeyShape(dim1, dim2, dim3, shape);
+        auto ek = std::make_shared<RingGSWACCKeyImpl>(dim1, dim2, dim3);
+        for (uint64_t i = 0; i < dim1; ++i) {
+            for (uint64_t j = 0; j < dim2; ++j) {
+                for (uint64_t k = 0; k < dim3; ++k) {
+                    uint64_t rows{shape.GetRows(j, k)};
+                    bool present = Next();
+                    CheckSlot(present, rows);
+                    if (present)
+                        (*ek)[i][j][k] = NextEvalKey(polyParams, rows);
+                }
+            }
+        }
+        return ek;
+    }
+
+private:
+    std::shared_ptr<const MappedFile> m_file;
+    size_t m_pos{0};
+    size_t m_headerWords{0};
+    uint64_t m_dataOffset{0};
+    uint64_t m_dataSize{0};
+};
+#endif
+
+}  // namespace
+
+void CirBTSKeyIO::WriteMappable(std::ostream& os, const std::shared_ptr<CirBTSCryptoParams>& params,
+                                const RingGSWCirBTKey& ek) {
+    const auto& RGSWParams1 = params->GetRingGSWParams1();
+    uint64_t mask           = (ek.RFkey != nullptr ? RF_KEY : 0) | (ek.HTkey != nullptr ? HT_KEY : 0) |
+                    (ek.SSkey != nullptr ? SS_KEY : 0) | (ek.RTOkey != nullptr ? RTO_KEY : 0);
+    uint32_t N1{RGSWParams1->GetN()};
+    uint32_t N{params->GetRLWEParams()->GetN()};
+
+    MapLayout layout;
+    if (ek.RFkey != nullptr)
+        layout.AddACCKey(ek.RFkey, N1);
+    if (ek.HTkey != nullptr)
+        layout.AddACCKey(ek.HTkey, N);
+    if (ek.SSkey != nullptr)
+        layout.AddEvalKey(ek.SSkey, N);
+    if (ek.RTOkey != nullptr)
+        layout.AddEvalKey(ek.RTOkey, N1);
+
+    // the data region starts at a page boundary; the key blocks follow each other in it and are
+    // only aligned to the size of a coefficient
+    uint64_t headerSize{(8 + layout.header.size()) * sizeof(uint64_t)};
+    uint64_t dataOffset{(headerSize + MAP_ALIGNMENT - 1) / MAP_ALIGNMENT * MAP_ALIGNMENT};
+    WriteWord(os, MAP_MAGIC);
+    WriteWord(os, MAP_VERSION);
+    WriteWord(os, N1);
+    WriteWord(os, RGSWParams1->GetQ().ConvertToInt());
+    WriteWord(os, RGSWParams1->GetMethod());
+    WriteWord(os, mask);
+    WriteWord(os, dataOffset);
+    WriteWord(os, layout.dataSize);
+    for (auto w : layout.header)
+        WriteWord(os, w);
+    for (uint64_t pad = headerSize; pad < dataOffset; pad += sizeof(uint64_t))
+        WriteWord(os, 0);
+
+    for (size_t k = 0; k < layout.keys.size(); ++k) {
+        const auto& key = layout.keys[k];
+        uint32_t keyN{layout.ringDims[k]};
+        for (uint32_t i = 0; i < key->GetRowSize(); ++i) {
+            for (uint32_t j = 0; j < key->GetColSize(); ++j) {
+                if (GetElementFormat(key, i, j) == Format::EVALUATION) {
+                    os.write(reinterpret_cast<const char*>(key->GetElementData(i, j)), keyN * sizeof(uint64_t));
+                }
+                else {
+                    NativePoly poly((*key)[i][j]);
+                    poly.SetFormat(Format::EVALUATION);
+                    os.write(reinterpret_cast<const char*>(&poly[0]), keyN * sizeof(uint64_t));
+                }
+            }
+        }
+    }
+    if (!os)
+        OPENFHE_THROW("failed to write the circuit bootstrapping keys");
+}
+
+RingGSWCirBTKey CirBTSKeyIO::Map(const std::string& filename, const std::shared_ptr<CirBTSCryptoParams>& params) {
+#if defined(__unix__) || defined(__APPLE__)
+    const auto& RGSWParams1 = params->GetRingGSWParams1();
+    MapReader reader(std::make_shared<const MappedFile>(filename));
+    if (reader.Next() != MAP_MAGIC)
+        OPENFHE_THROW("the file does not contain mappable circuit bootstrapping keys");
+    uint64_t version = reader.Next();
+    if (version > MAP_VERSION)
+        OPENFHE_THROW("serialized object version " + std::to_string(version) + " is from a later version of the library");
+    if (reader.Next() != RGSWParams1->GetN() || reader.Next() != RGSWParams1->GetQ().ConvertToInt() ||
+        reader.Next() != static_cast<uint64_t>(RGSWParams1->GetMethod()))
+        OPENFHE_THROW("the circuit bootstrapping keys were generated for different parameters");
+    uint64_t mask       = reader.Next();
+    uint64_t dataOffset = reader.Next();
+    reader.SetDataRegion(dataOffset, reader.Next());
+
+    const auto& polyParams1 = RGSWParams1->GetPolyParams();
+    const auto& polyParams  = params->GetRLWEParams()->GetPolyParams();
+    auto shapes = GetKeyShapes(params);
+    if ((mask & RTO_KEY) && shapes.rtoRows == 0)
+        OPENFHE_THROW("the circuit bootstrapping keys were generated for different parameters");
+    RingGSWCirBTKey ek{};
+    if (mask & RF_KEY)
+        ek.RFkey = reader.NextACCKey(polyParams1, shapes.rf);
+    if (mask & HT_KEY)
+        ek.HTkey = reader.NextACCKey(polyParams, shapes.ht);
+    if (mask & SS_KEY)
+        ek.SSkey = reader.NextEvalKey(polyParams, shapes.ssRows);
+    if (mask & RTO_KEY)
+        ek.RTOkey = reader.NextEvalKey(polyParams1, shapes.rtoRows);
+    return ek;
+#else
+    OPENFHE_THROW("memory-mapped circuit bootstrapping keys are not supported on this platform");
+#endif
+}
+
+}  // namespace lbcrypto
@@ -0,0 +1,50 @@
+#include "cirbts-noise.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace lbcrypto {
+
+namespace {
+
+void WriteStats(std::ostream& os, const CirBTSErrorStats& st) {
+    os << "{\"count\":" << st.count << ",\"mean\":" << st.GetMean() << ",\"variance\":" << st.GetVariance()
+       << ",\"stddev_log2\":" << st.GetStdDevBits()
+       << ",\"max_abs_log2\":" << (st.maxAbs > 0.0 ? std::log2(st.maxAbs) : 0.0) << "}";
+}
+
+}  // namespace
+
+void CirBTSNoiseStats::Merge(const CirBTSNoiseStats& other) {
+    logQ = std::max(logQ, other.logQ);
+    numRuns += other.numRuns;
+    mvfbs.Merge(other.mvfbs);
+    if (homtraceLevels.size() < other.homtraceLevels.size())
+        homtraceLevels.resize(other.homtraceLevels.size());
+    for (size_t i = 0; i < other.homtraceLevels.size(); ++i)
+        homtraceLevels[i].Merge(other.homtraceLevels[i]);
+    homtrace.Merge(other.homtrace);
+    schemeSwitch.Merge(other.schemeSwitch);
+    externalProduct.Merge(other.externalProduct);
+}
+
+std::string CirBTSNoiseStats::ToJSON() const {
+    std::ostringstream os;
+    os << std::setprecision(6) << "{\"log2_q\":" << logQ << ",\"runs\":" << numRuns << ",\"mvfbs\":";
+    WriteStats(os, mvfbs);
+    os << ",\"homtrace_levels\":[";
+    for (size_t i = 0; i < homtraceLevels.size(); ++i) {
+        os << (i ? "," : "");
+        WriteStats(os, homtraceLevels[i]);
+    }
+    os << "],\"homtrace\":";
+    WriteStats(os, homtrace);
+    os << ",\"scheme_switch\":";
+    WriteStats(os, schemeSwitch);
+    os << ",\"external_product\":";
+    WriteStats(os, externalProduct);
+    os << "}";
+    return os.str();
+}
+
+}  // namespace lbcrypto
@@ -0,0 +1,246 @@
+#include "cirbts-param-gen.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace lbcrypto {
+
+namespace {
+
+// the window of the LMKCDEY blind rotation in the key size of parameters_gen.py
+constexpr double AUTO_WINDOW = 15;
+
+// the exponent among floor(x) and floor(x) + 1 with the smaller error
+template <typename Error>
+uint32_t ChooseBase(double x, Error error) {
+    auto b1 = static_cast<uint32_t>(std::max(std::floor(x), 1.0));
+    auto b2 = b1 + 1;
+    return error(b1) < error(b2) ? b1 : b2;
+}
+
+}  // namespace
+
+CirBTSErrorModel::CirBTSErrorModel(const CirBTSContextParams& params, BINFHE_METHOD method, uint32_t numAutomorphisms)
+    : m_isAuto(method == LMKCDEY),
+      m_n(params.latticeParam),
+      m_N(params.cyclOrder / 2),
+      m_q(params.mod),
+      m_logQ(params.numberBits),
+      m_sigmaKey(params.stdDev),
+      m_numAuto(numAutomorphisms) {}
+
+double CirBTSErrorModel::Log2Erfc(double x) {
+    if (x < 25.0)
+        return std::log2(std::erfc(x));
+    // asymptotic expansion erfc(x) ~ exp(-x^2) / (x * sqrt(pi)) * (1 - 1 / (2x^2))
+    return (-x * x - std::log(x * std::sqrt(M_PI)) + std::log1p(-0.5 / (x * x))) / std::log(2.0);
+}
+
+double CirBTSErrorModel::GetLog2FailureRate(double sigmaIn2) const {
+    double res = 4 * m_N * m_N * sigmaIn2 / m_q / m_q;
+    return Log2Erfc(m_N / 2 / std::sqrt(2 * res));
+}
+
+double CirBTSErrorModel::GetSigmaIn2(double log2FailureRate) const {
+    // the failure rate is erfc(q / (4 * sqrt(2 * sigmaIn2))); log2 erfc decreases, so x is bisected
+    double lo{0.0};
+    double hi{100.0};
+    for (uint32_t i = 0; i < 200; ++i) {
+        double mid = 0.5 * (lo + hi);
+        if (Log2Erfc(mid) > log2FailureRate)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    double x = 4 * std::sqrt(2.0) * hi / m_q;
+    return 1.0 / (x * x);
+}
+
+double CirBTSErrorModel::RoundingError(uint32_t l, uint32_t b) const {
+    return std::ceil(std::exp2(m_logQ - static_cast<double>(l) * b)) / 2;
+}
+
+double CirBTSErrorModel::ErrorBlindRotation(uint32_t l, uint32_t b) const {
+    // the automorphism keys of LMKCDEY share the gadget of the blind rotation keys
+    double ebr  = RoundingError(l, b);
+    double skey = m_sigmaKey * m_sigmaKey;
+    double temp = m_n * (m_N * l * std::exp2(2.0 * b) / 6 * skey + (m_N + 1) * ebr * ebr / 3);
+    if (!m_isAuto)
+        return 2 * temp;
+    return temp + m_numAuto * (m_N * l * std::exp2(2.0 * b) / 12 * skey + m_N * ebr * ebr / 6);
+}
+
+double CirBTSErrorModel::ErrorTrace(uint32_t l, uint32_t b) const {
+    double ebr = RoundingError(l, b);
+    return (m_N * m_N - 1) / 3 *
+           (m_N * l * std::exp2(2.0 * b) / 12 * m_sigmaKey * m_sigmaKey + m_N * ebr * ebr / 6);
+}
+
+double CirBTSErrorModel::ErrorSchemeSwitch(uint32_t l, uint32_t b) const {
+    double ebr = RoundingError(l, b);
+    return m_N * l * std::exp2(2.0 * b) / 12 * m_sigmaKey * m_sigmaKey + m_N * m_N * ebr * ebr / 12;
+}
+
+double CirBTSErrorModel::NoiseSum(double errSS, uint32_t l, uint32_t b) const {
+    double ebr = RoundingError(l, b);
+    return l * std::exp2(2.0 * b) * errSS * m_N / 6 + (m_N + 1) * ebr * ebr / 3;
+}
+
+double CirBTSErrorModel::MaxDepth(double noise, double sigmaIn2) const {
+    double temp = m_isAuto ? (m_n * m_sigmaKey * m_sigmaKey + 1) / 12 : (m_n + 2) / 24;
+    return (sigmaIn2 - temp) * std::exp2(2 * m_logQ) / m_q / m_q / noise;
+}
+
+uint32_t CirBTSErrorModel::OptimizeBaseBR(uint32_t l) const {
+    double skey = m_sigmaKey * m_sigmaKey;
+    double x    = m_isAuto ? (2 * m_logQ - std::log2(skey * 2)) / 2 / (l + 1) :
+                             (2 * m_logQ + std::log2((m_N + 1) / m_N / skey / 2)) / 2 / (l + 1);
+    return ChooseBase(x, [&](uint32_t b) { return ErrorBlindRotation(l, b); });
+}
+
+uint32_t CirBTSErrorModel::OptimizeBaseTrace(uint32_t l) const {
+    double x = (2 * m_logQ - std::log2(m_sigmaKey * m_sigmaKey * 2)) / 2 / (l + 1);
+    return ChooseBase(x, [&](uint32_t b) { return ErrorTrace(l, b); });
+}
+
+uint32_t CirBTSErrorModel::OptimizeBaseSS(uint32_t l) const {
+    double x = (2 * m_logQ + std::log2(m_N / m_sigmaKey / m_sigmaKey / 4)) / 2 / (l + 1);
+    return ChooseBase(x, [&](uint32_t b) { return ErrorSchemeSwitch(l, b); });
+}
+
+uint32_t CirBTSErrorModel::OptimizeBaseNoise(double errSS, uint32_t l) const {
+    double x = (2 * m_logQ + std::log2((m_N + 1) / errSS / m_N / 2)) / 2 / (l + 1);
+    return ChooseBase(x, [&](uint32_t b) { return NoiseSum(errSS, l, b); });
+}
+
+CirBTSErrorEstimate CirBTSErrorModel::Evaluate(const CirBTSContextParams& params, double sigmaIn2) const {
+    auto bits = [](usint base) { return static_cast<uint32_t>(__builtin_ctz(base)); };
+    uint32_t l1 = params.DigitsEP, l3 = params.DigitsHT, l4 = params.DigitsSS, l5 = params.DigitsCC;
+
+    CirBTSErrorEstimate res;
+    res.errBR    = ErrorBlindRotation(l1, bits(params.BaseEP));
+    res.errTrace = ErrorTrace(l3, bits(params.BaseHT));
+    res.errSS    = ErrorSchemeSwitch(l4, bits(params.BaseSS)) + m_N * 0.5 * res.errTrace + 0.5 * res.errBR;
+    res.noise    = NoiseSum(res.errSS, l5, bits(params.BaseCC));
+    res.maxDepth = MaxDepth(res.noise, sigmaIn2);
+
+    double logN = std::log2(m_N);
+    double nntt1 = 2 * m_n * (l1 + 1) + (m_isAuto ? (m_numAuto + 2) * (l1 + 1) : 0);
+    double nntt2 = std::round(logN * (l3 + 1) + l4 + 1) * l5;
+    res.numNTTs  = static_cast<uint64_t>(nntt1 + nntt2);
+
+    double keyUnit = 2 * m_N * m_logQ / (1 << 23);
+    double ks1     = (2 * m_n * l1 + (m_isAuto ? (AUTO_WINDOW + 2) * l1 : 0)) * keyUnit;
+    double ks2     = (logN * l3 + l4) * keyUnit;
+    res.keySizeMB  = ks1 + ks2;
+    return res;
+}
+
+CirBTSParamsTuner::CirBTSParamsTuner(BINFHE_METHOD method, const CirBTSTunerOptions& options)
+    : CirBTSParamsTuner(method,
+                        CirBTSContext::GetParamSet(method == LMKCDEY ? STD128_CircuitBootstrap_AUTO :
+                                                                       STD128_CircuitBootstrap_CMUX_2),
+                        options) {}
+
+CirBTSParamsTuner::CirBTSParamsTuner(BINFHE_METHOD method, const CirBTSContextParams& base,
+                                     const CirBTSTunerOptions& options)
+    : m_method(method), m_base(base), m_options(options) {
+    if (method != GINX && method != LMKCDEY)
+        OPENFHE_THROW(config_error, "the method must be GINX or LMKCDEY");
+}
+
+std::vector<CirBTSTunedParams> CirBTSParamsTuner::GetCandidates() const {
+    CirBTSErrorModel model(m_base, m_method);
+    double sigmaIn2 = model.GetSigmaIn2(m_options.log2FailureRate);
+    // the bases are usint and the gadgets keep the top digits of Q
+    auto fits = [&](uint32_t l, uint32_t b) { return b < 32 && l * b <= m_base.numberBits; };
+
+    std::vector<CirBTSTunedParams> res;
+    for (uint32_t l1 = 1; l1 <= m_options.maxDigitsEP; ++l1) {
+        uint32_t b1 = model.OptimizeBaseBR(l1);
+        if (!fits(l1, b1))
+            continue;
+        double errBR = model.ErrorBlindRotation(l1, b1);
+        for (uint32_t l3 = 1; l3 <= m_options.maxDigitsHT; ++l3) {
+            uint32_t b3 = model.OptimizeBaseTrace(l3);
+            if (!fits(l3, b3))
+                continue;
+            double errTrace = model.ErrorTrace(l3, b3);
+            for (uint32_t l4 = 1; l4 <= m_options.maxDigitsSS; ++l4) {
+                uint32_t b4 = model.OptimizeBaseSS(l4);
+                if (!fits(l4, b4))
+                    continue;
+                double errSS = model.ErrorSchemeSwitch(l4, b4) + (m_base.cyclOrder / 2) * 0.5 * errTrace + 0.5 * errBR;
+                for (uint32_t l5 = 1; l5 <= m_options.maxDigitsCC; ++l5) {
+                    uint32_t b5 = model.OptimizeBaseNoise(errSS, l5);
+                    if (!fits(l5, b5))
+                        continue;
+                    CirBTSTunedParams candidate{m_base, {}, 0.0};
+                    auto& p    = candidate.params;
+                    p.BaseEP   = 1u << b1;
+                    p.DigitsEP = l1;
+                    p.BaseHT   = 1u << b3;
+                    p.DigitsHT = l3;
+                    p.BaseSS   = 1u << b4;
+                    p.DigitsSS = l4;
+                    p.BaseCC   = 1u << b5;
+                    p.DigitsCC = l5;
+                    candidate.estimate = model.Evaluate(p, sigmaIn2);
+                    if (candidate.estimate.maxDepth >= m_options.targetDepth)
+                        res.push_back(candidate);
+                }
+            }
+        }
+    }
+
+    std::stable_sort(res.begin(), res.end(), [](const CirBTSTunedParams& a, const CirBTSTunedParams& b) {
+        if (a.estimate.numNTTs != b.estimate.numNTTs)
+            return a.estimate.numNTTs < b.estimate.numNTTs;
+        return a.estimate.keySizeMB < b.estimate.keySizeMB;
+    });
+    return res;
+}
+
+void CirBTSParamsTuner::Benchmark(CirBTSTunedParams& candidate) const {
+    CirBTSContext cc;
+    cc.GenerateCirBTSContext(candidate.params, m_method);
+    auto sk  = cc.KeyGen();
+    auto sk2 = cc.RLWEKeyGen();
+    cc.CirBTKeyGen(sk, sk2);
+
+    auto ct = cc.Encrypt(sk, 1);
+    // the first call warms up the caches and the workspaces
+    auto ctGSW = cc.CircuitBootstrapping(ct);
+    auto rlwe  = std::make_shared<RLWECiphertextImpl>(ctGSW->GetElements()[1]);
+    BlindRotationWorkspace ws;
+
+    double best = std::numeric_limits<double>::max();
+    for (uint32_t s = 0; s < std::max(m_options.numSamples, 1u); ++s) {
+        auto start = std::chrono::steady_clock::now();
+        ctGSW      = cc.CircuitBootstrapping(ct);
+        for (uint32_t i = 0; i < m_options.productsPerBootstrap; ++i)
+            cc.EvalExternalProductInPlace(ctGSW, rlwe, ws);
+        auto end = std::chrono::steady_clock::now();
+        best     = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    candidate.latencyMs = best;
+}
+
+CirBTSTunedParams CirBTSParamsTuner::Tune() const {
+    auto candidates = GetCandidates();
+    if (candidates.empty())
+        OPENFHE_THROW(config_error, "no decomposition reaches the target depth at the target failure rate");
+
+    uint32_t numBenchmarked = std::min<uint32_t>(std::max(m_options.numCandidates, 1u), candidates.size());
+    uint32_t fastest{0};
+    for (uint32_t i = 0; i < numBenchmarked; ++i) {
+        Benchmark(candidates[i]);
+        if (candidates[i].latencyMs < candidates[fastest].latencyMs)
+            fastest = i;
+    }
+    return candidates[fastest];
+}
+
+}  // namespace lbcrypto
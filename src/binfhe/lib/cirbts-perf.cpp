@@ -0,0 +1,243 @@
+#include "cirbts-perf.h"
+#include "math/hal/transform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace lbcrypto {
+
+namespace {
+
+// the counters of one thread; only the owner thread writes them, also to clear them after a
+// Reset, so an increment is a relaxed load and store, and the atomics only keep the reads of
+// Collect well defined
+struct StageCounters {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> totalNs{0};
+    std::atomic<uint64_t> minNs{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> maxNs{0};
+    std::array<std::atomic<uint64_t>, CirBTSStageStats::NUM_BUCKETS> histogram{};
+};
+
+struct ThreadCounters {
+    std::array<StageCounters, NUM_CIRBTS_STAGES> stages;
+    std::atomic<uint64_t> allocations{0};
+    // the Reset generation the counters belong to; older counters are not collected
+    std::atomic<uint64_t> generation{0};
+};
+
+inline void Add(std::atomic<uint64_t>& counter, uint64_t v) {
+    counter.store(counter.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+}
+
+void AddTo(const ThreadCounters& counters, CirBTSPerfStats& stats) {
+    for (uint32_t s = 0; s < NUM_CIRBTS_STAGES; ++s) {
+        const auto& c = counters.stages[s];
+        CirBTSStageStats st;
+        st.count   = c.count.load(std::memory_order_relaxed);
+        st.totalNs = c.totalNs.load(std::memory_order_relaxed);
+        st.minNs   = st.count ? c.minNs.load(std::memory_order_relaxed) : 0;
+        st.maxNs   = c.maxNs.load(std::memory_order_relaxed);
+        for (uint32_t b = 0; b < CirBTSStageStats::NUM_BUCKETS; ++b)
+            st.histogram[b] = c.histogram[b].load(std::memory_order_relaxed);
+        stats.stages[s].Merge(st);
+    }
+    stats.numAllocations += counters.allocations.load(std::memory_order_relaxed);
+}
+
+void Clear(ThreadCounters& counters) {
+    for (auto& c : counters.stages) {
+        c.count.store(0, std::memory_order_relaxed);
+        c.totalNs.store(0, std::memory_order_relaxed);
+        c.minNs.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+        c.maxNs.store(0, std::memory_order_relaxed);
+        for (auto& h : c.histogram)
+            h.store(0, std::memory_order_relaxed);
+    }
+    counters.allocations.store(0, std::memory_order_relaxed);
+}
+
+// the counters of the live threads and the sum of those of the exited threads
+struct PerfRegistry {
+    std::mutex mutex;
+    std::vector<ThreadCounters*> threads;
+    CirBTSPerfStats retired;
+    // incremented by every Reset
+    std::atomic<uint64_t> generation{0};
+};
+
+// never destroyed, so that the threads exiting after the static destructors can still retire
+PerfRegistry& GetRegistry() {
+    static auto* registry = new PerfRegistry;
+    return *registry;
+}
+
+// the counters of a thread that have not been cleared since the last Reset hold no current samples
+bool IsCurrent(const ThreadCounters& counters, const PerfRegistry& registry) {
+    return counters.generation.load(std::memory_order_acquire) == registry.generation.load(std::memory_order_relaxed);
+}
+
+struct ThreadSlot {
+    ThreadCounters counters;
+
+    ThreadSlot() {
+        auto& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        counters.generation.store(registry.generation.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        registry.threads.push_back(&counters);
+    }
+
+    ~ThreadSlot() {
+        auto& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (IsCurrent(counters, registry))
+            AddTo(counters, registry.retired);
+        registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), &counters));
+    }
+};
+
+// the counters of the calling thread, which clears them itself after a Reset: the clearing then
+// never races with its increments, and the new generation is only published once they are zero
+ThreadCounters& GetThreadCounters() {
+    thread_local ThreadSlot slot;
+    auto& counters      = slot.counters;
+    uint64_t generation = GetRegistry().generation.load(std::memory_order_acquire);
+    if (counters.generation.load(std::memory_order_relaxed) != generation) {
+        Clear(counters);
+        counters.generation.store(generation, std::memory_order_release);
+    }
+    return counters;
+}
+
+}  // namespace
+
+uint64_t CirBTSStageStats::GetPercentileUs(double p) const {
+    uint64_t samples{0};
+    for (auto h : histogram)
+        samples += h;
+    if (samples == 0)
+        return 0;
+    // the rank of the percentile among the sorted samples, from 1
+    auto rank = static_cast<uint64_t>(std::ceil(std::min(std::max(p, 0.0), 1.0) * samples));
+    rank      = std::max<uint64_t>(rank, 1);
+    uint64_t seen{0};
+    for (uint32_t b = 0; b < NUM_BUCKETS; ++b) {
+        seen += histogram[b];
+        if (seen >= rank)
+            return uint64_t(1) << (b + 1);
+    }
+    return uint64_t(1) << NUM_BUCKETS;
+}
+
+void CirBTSStageStats::Merge(const CirBTSStageStats& other) {
+    if (other.count == 0)
+        return;
+    minNs = count ? std::min(minNs, other.minNs) : other.minNs;
+    maxNs = std::max(maxNs, other.maxNs);
+    count += other.count;
+    totalNs += other.totalNs;
+    for (uint32_t b = 0; b < NUM_BUCKETS; ++b)
+        histogram[b] += other.histogram[b];
+}
+
+std::string CirBTSPerfStats::ToJSON() const {
+    std::ostringstream os;
+    os << "{\"transforms\":" << numTransforms << ",\"allocations\":" << numAllocations << ",\"stages\":{";
+    for (uint32_t s = 0; s < NUM_CIRBTS_STAGES; ++s) {
+        const auto& st = stages[s];
+        os << (s ? "," : "") << "\"" << CirBTSPerf::GetStageName(static_cast<CIRBTS_STAGE>(s)) << "\":{"
+           << "\"count\":" << st.count << ",\"total_ns\":" << st.totalNs << ",\"mean_ns\":"
+           << static_cast<uint64_t>(st.GetMeanNs()) << ",\"min_ns\":" << st.minNs << ",\"max_ns\":" << st.maxNs
+           << ",\"p50_us\":" << st.GetPercentileUs(0.5) << ",\"p99_us\":" << st.GetPercentileUs(0.99)
+           << ",\"histogram_log2_us\":[";
+        // the trailing empty buckets are left out
+        uint32_t last = CirBTSStageStats::NUM_BUCKETS;
+        while (last > 0 && st.histogram[last - 1] == 0)
+            --last;
+        for (uint32_t b = 0; b < last; ++b)
+            os << (b ? "," : "") << st.histogram[b];
+        os << "]}";
+    }
+    os << "}}";
+    return os.str();
+}
+
+void CirBTSPerf::Enable(bool enable) {
+    s_enabled.store(enable, std::memory_order_relaxed);
+    TransformCounter::Enable(enable);
+}
+
+CirBTSPerfStats CirBTSPerf::Collect() {
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    CirBTSPerfStats stats = registry.retired;
+    for (auto* counters : registry.threads) {
+        if (IsCurrent(*counters, registry))
+            AddTo(*counters, stats);
+    }
+    stats.numTransforms = TransformCounter::Get();
+    return stats;
+}
+
+void CirBTSPerf::Reset() {
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.retired = CirBTSPerfStats();
+    // the counters of the threads are left to their owners, see GetThreadCounters
+    registry.generation.fetch_add(1, std::memory_order_release);
+    TransformCounter::Reset();
+}
+
+void CirBTSPerf::Record(CIRBTS_STAGE stage, uint64_t ns, uint64_t numSamples) {
+    if (numSamples == 0)
+        return;
+    auto& c = GetThreadCounters().stages[stage];
+    // the ciphertexts of a batch are counted as samples of the average latency
+    uint64_t sampleNs = ns / numSamples;
+    Add(c.count, numSamples);
+    Add(c.totalNs, ns);
+    if (sampleNs < c.minNs.load(std::memory_order_relaxed))
+        c.minNs.store(sampleNs, std::memory_order_relaxed);
+    if (sampleNs > c.maxNs.load(std::memory_order_relaxed))
+        c.maxNs.store(sampleNs, std::memory_order_relaxed);
+    uint64_t us = sampleNs / 1000;
+    uint32_t bucket = us ? 63 - __builtin_clzll(us) : 0;
+    Add(c.histogram[std::min(bucket, CirBTSStageStats::NUM_BUCKETS - 1)], numSamples);
+}
+
+void CirBTSPerf::AddAllocations(uint64_t numPolys) {
+    Add(GetThreadCounters().allocations, numPolys);
+}
+
+const char* CirBTSPerf::GetStageName(CIRBTS_STAGE stage) {
+    switch (stage) {
+        case STAGE_MODSWITCH:
+            return "modswitch";
+        case STAGE_BLIND_ROTATION:
+            return "blind_rotation";
+        case STAGE_ROUND_TO_ODD:
+            return "round_to_odd";
+        case STAGE_HOMTRACE:
+            return "homtrace";
+        case STAGE_HOMTRACE_LEVEL:
+            return "homtrace_level";
+        case STAGE_SCHEME_SWITCH:
+            return "scheme_switch";
+        case STAGE_CIRCUIT_BOOTSTRAP:
+            return "circuit_bootstrap";
+        case STAGE_EXTERNAL_PRODUCT:
+            return "external_product";
+        case STAGE_CMUX:
+            return "cmux";
+        case STAGE_LUT:
+            return "lut";
+        default:
+            return "unknown";
+    }
+}
+
+}  // namespace lbcrypto
@@ -0,0 +1,148 @@
+#include "cirbts-trace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+namespace lbcrypto {
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    CirBTSTrace::Clock::time_point begin;
+    CirBTSTrace::Clock::time_point end;
+};
+
+// the spans of one thread; the mutex is only contended while the trace is written
+struct ThreadTrace {
+    std::mutex mutex;
+    uint32_t tid{0};
+    uint64_t dropped{0};
+    std::vector<TraceEvent> events;
+};
+
+// the spans of a thread that has exited
+struct RetiredTrace {
+    uint32_t tid;
+    uint64_t dropped;
+    std::vector<TraceEvent> events;
+};
+
+struct TraceRegistry {
+    std::mutex mutex;
+    uint32_t nextTid{0};
+    CirBTSTrace::Clock::time_point epoch{CirBTSTrace::Clock::now()};
+    std::vector<ThreadTrace*> threads;
+    std::vector<RetiredTrace> retired;
+};
+
+// never destroyed, so that the threads exiting after the static destructors can still retire
+TraceRegistry& GetRegistry() {
+    static auto* registry = new TraceRegistry;
+    return *registry;
+}
+
+struct ThreadSlot {
+    ThreadTrace trace;
+
+    ThreadSlot() {
+        auto& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        trace.tid = registry.nextTid++;
+        registry.threads.push_back(&trace);
+    }
+
+    ~ThreadSlot() {
+        auto& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (!trace.events.empty() || trace.dropped)
+            registry.retired.push_back({trace.tid, trace.dropped, std::move(trace.events)});
+        registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), &trace));
+    }
+};
+
+ThreadTrace& GetThreadTrace() {
+    thread_local ThreadSlot slot;
+    return slot.trace;
+}
+
+void WriteThread(std::ostream& os, bool& first, CirBTSTrace::Clock::time_point epoch, uint32_t tid,
+                 const std::vector<TraceEvent>& events) {
+    if (events.empty())
+        return;
+    os << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+       << ",\"args\":{\"name\":\"thread " << tid << "\"}}";
+    first = false;
+    for (const auto& e : events) {
+        // the timestamps are in microseconds
+        double ts  = std::chrono::duration<double, std::micro>(e.begin - epoch).count();
+        double dur = std::chrono::duration<double, std::micro>(e.end - e.begin).count();
+        os << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"cirbts\",\"ph\":\"X\",\"ts\":" << ts << ",\"dur\":" << dur
+           << ",\"pid\":1,\"tid\":" << tid << "}";
+    }
+}
+
+}  // namespace
+
+void CirBTSTrace::Enable(bool enable) {
+    if (enable) {
+        Clear();
+        auto& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.epoch = Clock::now();
+    }
+    s_enabled.store(enable, std::memory_order_relaxed);
+}
+
+void CirBTSTrace::Record(const char* name, Clock::time_point begin, Clock::time_point end) {
+    auto& trace = GetThreadTrace();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    if (trace.events.size() < MAX_EVENTS_PER_THREAD)
+        trace.events.push_back({name, begin, end});
+    else
+        ++trace.dropped;
+}
+
+void CirBTSTrace::Write(std::ostream& os) {
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto flags = os.flags();
+    os << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first{true};
+    uint64_t dropped{0};
+    for (const auto& r : registry.retired) {
+        WriteThread(os, first, registry.epoch, r.tid, r.events);
+        dropped += r.dropped;
+    }
+    for (auto* trace : registry.threads) {
+        std::lock_guard<std::mutex> threadLock(trace->mutex);
+        WriteThread(os, first, registry.epoch, trace->tid, trace->events);
+        dropped += trace->dropped;
+    }
+    os << "\n],\"otherData\":{\"droppedEvents\":" << dropped << "}}\n";
+    os.flags(flags);
+}
+
+bool CirBTSTrace::WriteToFile(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open())
+        return false;
+    Write(file);
+    return file.good();
+}
+
+void CirBTSTrace::Clear() {
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.retired.clear();
+    for (auto* trace : registry.threads) {
+        std::lock_guard<std::mutex> threadLock(trace->mutex);
+        trace->events.clear();
+        trace->dropped = 0;
+    }
+}
+
+}  // namespace lbcrypto
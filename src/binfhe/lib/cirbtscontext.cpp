@@ -1,9 +1,13 @@
 #include "cirbtscontext.h"
+#include "cirbts-key-io.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
 #include <unordered_map>
 
 namespace lbcrypto{ 
 
-void CirBTSContext::GenerateCirBTSContext(CirBTS_PARAMSET set, BINFHE_METHOD method) {
+CirBTSContextParams CirBTSContext::GetParamSet(CirBTS_PARAMSET set) {
     constexpr double STD_DEV = 3.2;
 
     const std::unordered_map<CirBTS_PARAMSET, CirBTSContextParams> CircuitParamsMap({
@@ -11,6 +15,7 @@ void CirBTSContext::GenerateCirBTSContext(CirBTS_PARAMSET set, BINFHE_METHOD met
         { STD128_CircuitBootstrap_CMUX_1, {54,      4096,      571,        1024,  STD_DEV,  1 << 26,   1,    1 << 13,   3,    1 << 28,    1,    1 << 3,  4,   UNIFORM_BINARY, UNIFORM_BINARY} },
         { STD128_CircuitBootstrap_CMUX_2, {54,      4096,      571,        1024,  STD_DEV,  1 << 17,   2,    1 << 13,   3,    1 << 19,    2,    1 << 4,  4,   UNIFORM_BINARY, UNIFORM_BINARY} },
         { STD128_CircuitBootstrap_CMUX_3, {54,      4096,      571,        1024,  STD_DEV,  1 << 17,   2,    1 << 8,   2,    1 << 19,    2,    1 << 5,  4,   UNIFORM_BINARY, UNIFORM_BINARY} },
+        { STD128_CircuitBootstrap_AUTO,   {54,      4096,      458,        1024,  STD_DEV,  1 << 18,   2,    1 << 13,   3,    1 << 19,    2,    1 << 4,  4,   GAUSSIAN,       UNIFORM_BINARY} },
     });
 
     auto search = CircuitParamsMap.find(set);
@@ -18,23 +23,72 @@ void CirBTSContext::GenerateCirBTSContext(CirBTS_PARAMSET set, BINFHE_METHOD met
         std::string errMsg("ERROR: Unknown parameter set [" + std::to_string(set) + "] for circuitbootstrap");
         OPENFHE_THROW(config_error, errMsg);
     }
+    return search->second;
+}
 
-    CirBTSContextParams params = search->second;
+void CirBTSContext::GenerateCirBTSContext(CirBTS_PARAMSET set, BINFHE_METHOD method, EXTPROD_BACKEND backend) {
+    auto params = GetParamSet(set);
+    if (set == STD128_CircuitBootstrap_AUTO && method != LMKCDEY)
+        OPENFHE_THROW(config_error, "STD128_CircuitBootstrap_AUTO requires the LMKCDEY method");
+    GenerateCirBTSContext(params, method, backend);
+}
+
+void CirBTSContext::GenerateCirBTSContext(const CirBTSContextParams& params, BINFHE_METHOD method,
+                                          EXTPROD_BACKEND backend) {
+    if (params.cyclOrder < 4 || (params.cyclOrder & (params.cyclOrder - 1)) != 0)
+        OPENFHE_THROW(config_error, "the cyclotomic order must be a power of two");
+    //the gadgets are decomposed with shifts and keep the top digits of Q
+    const std::pair<usint, usint> gadgets[] = {{params.BaseEP, params.DigitsEP}, {params.BaseHT, params.DigitsHT},
+                                               {params.BaseSS, params.DigitsSS}, {params.BaseCC, params.DigitsCC}};
+    for (const auto& gadget : gadgets) {
+        if (gadget.first < 2 || (gadget.first & (gadget.first - 1)) != 0)
+            OPENFHE_THROW(config_error, "the gadget bases must be powers of two");
+        if (gadget.second == 0 || gadget.second * static_cast<usint>(__builtin_ctz(gadget.first)) > params.numberBits)
+            OPENFHE_THROW(config_error, "digits * log2(base) of a gadget must be in [1, numberBits]");
+    }
 
     //level 2 prime modulus 
     NativeInteger Q(LastPrime<NativeInteger>(params.numberBits, params.cyclOrder));
 
     usint ringDim = params.cyclOrder / 2;
+    //the modulus switched a of the MV-FBS is a multiple of numLUT (and even for LMKCDEY)
+    uint32_t logStep = std::max(static_cast<uint32_t>(std::ceil(std::log2(params.DigitsCC))), 1u);
+    uint32_t numAutoKeys = method == LMKCDEY ? RingGSWCryptoParams::ChooseNumAutoKeys(ringDim, params.latticeParam, logStep) : 10;
     auto lweparams = std::make_shared<LWECryptoParams>(params.latticeParam, ringDim, params.mod, Q, params.mod,
                                                         params.stdDev, 1, params.keyDist0);
-    auto rgswparams1 = std::make_shared<RingGSWCryptoParams>(ringDim, Q, params.mod, params.BaseEP, params.mod,
-                                                             method, params.stdDev, params.DigitsEP, params.keyDist2, false, 10);
+    //the blind rotation consumes vectors modulus switched to 2N
+    auto rgswparams1 = std::make_shared<RingGSWCryptoParams>(ringDim, Q, NativeInteger(2 * ringDim), params.BaseEP, params.mod,
+                                                             method, params.stdDev, params.DigitsEP, params.keyDist2, false, numAutoKeys);
     auto rlweparams = std::make_shared<RLWECryptoParams>(params.cyclOrder, ringDim, Q, params.stdDev, params.BaseHT,
                                                         params.DigitsHT, params.BaseSS, params.DigitsSS, params.keyDist2);
     auto rgswparams2 = std::make_shared<RingGSWCryptoParams>(ringDim, Q, params.mod, params.BaseCC, params.mod,
-                                                             method, params.stdDev, params.DigitsCC, params.keyDist2, false, 10);
+                                                             method, params.stdDev, params.DigitsCC, params.keyDist2, false, numAutoKeys);
     m_params = std::make_shared<CirBTSCryptoParams>(lweparams, rgswparams1, rlweparams, rgswparams2);
     m_cirbtsscheme = std::make_shared<CirBTSScheme>(method);
+    SetProductBackend(backend);
+}
+
+void CirBTSContext::SetProductBackend(EXTPROD_BACKEND backend) {
+    if (m_params == nullptr)
+        OPENFHE_THROW(config_error, "the parameters have not been generated. Please call GenerateCirBTSContext first");
+    if (backend == FFT_BACKEND) {
+        const auto& RGSWParams1 = m_params->GetRingGSWParams1();
+        if (RGSWParams1->GetMethod() != GINX)
+            OPENFHE_THROW(config_error, "the FFT backend is only supported for the GINX method");
+        if (RGSWParams1->GetFFTNumLimbs() == 0)
+            OPENFHE_THROW(config_error, "the gadget of the MV-FBS is too large for the failure rate of the FFT backend");
+        if (m_BTKey.RFkey != nullptr && m_BTKey.FFTkey == nullptr)
+            m_BTKey.FFTkey = m_cirbtsscheme->KeyGenFFT(m_params, m_BTKey.RFkey);
+    }
+    m_params->SetProductBackend(backend);
+}
+
+void CirBTSContext::SetKeyUnrollFactor(uint32_t unroll) {
+    if (m_params == nullptr)
+        OPENFHE_THROW(config_error, "the parameters have not been generated. Please call GenerateCirBTSContext first");
+    if (m_BTKey.RFkey != nullptr)
+        OPENFHE_THROW(config_error, "the key unroll factor should be set before calling CirBTKeyGen");
+    m_params->GetRingGSWParams1()->SetKeyUnrollFactor(unroll);
 }
 
 RLWEPrivateKey CirBTSContext::RLWEKeyGen() const{
@@ -71,11 +125,97 @@ void CirBTSContext::Decrypt(ConstLWEPrivateKey& sk, ConstLWECiphertext& ct, LWEP
 }
 
 void CirBTSContext::CirBTKeyGen(ConstLWEPrivateKey& sk, ConstRLWEPrivateKey skNTT, KEYGEN_MODE keygenMode){
-    m_BTKey           = m_cirbtsscheme->KeyGen(m_params, sk, skNTT, keygenMode);
+    CirBTKeyGen(sk, skNTT, SeededUniformGenerator::GenerateSeed(), keygenMode);
+}
+
+void CirBTSContext::CirBTKeyGen(ConstLWEPrivateKey& sk, ConstRLWEPrivateKey skNTT, const PolySeed& seed,
+                                KEYGEN_MODE keygenMode){
+    m_BTKey           = m_cirbtsscheme->KeyGen(m_params, sk, skNTT, keygenMode, seed);
+}
+
+void CirBTSContext::BTKeyLoad(const RingGSWCirBTKey& key){
+    m_BTKey = key;
+    m_BTKey.FFTkey.reset();
+    if (m_params->GetProductBackend() == FFT_BACKEND && m_BTKey.RFkey != nullptr)
+        m_BTKey.FFTkey = m_cirbtsscheme->KeyGenFFT(m_params, m_BTKey.RFkey);
+}
+
+void CirBTSContext::SerializeBTKey(std::ostream& os) const{
+    CirBTSKeyIO::Write(os, m_params, m_BTKey);
+}
+
+void CirBTSContext::DeserializeBTKey(std::istream& is){
+    BTKeyLoad(CirBTSKeyIO::Read(is, m_params));
+}
+
+bool CirBTSContext::SerializeBTKeyToFile(const std::string& filename) const{
+    std::ofstream file(filename, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+        return false;
+    SerializeBTKey(file);
+    return true;
+}
+
+bool CirBTSContext::DeserializeBTKeyFromFile(const std::string& filename){
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return false;
+    DeserializeBTKey(file);
+    return true;
+}
+
+bool CirBTSContext::SerializeBTKeyToMappableFile(const std::string& filename) const{
+    std::ofstream file(filename, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+        return false;
+    CirBTSKeyIO::WriteMappable(file, m_params, m_BTKey);
+    return true;
+}
+
+void CirBTSContext::MapBTKeyFromFile(const std::string& filename){
+    BTKeyLoad(CirBTSKeyIO::Map(filename, m_params));
 }
 
 RGSWCiphertext CirBTSContext::CircuitBootstrapping(ConstLWECiphertext& ct) const{
     return m_cirbtsscheme->CircuitBootstrap(m_params, m_BTKey, ct);
 }
 
+std::vector<RGSWCiphertext> CirBTSContext::CircuitBootstrapBatch(const std::vector<LWECiphertext>& ct) const{
+    return m_cirbtsscheme->CircuitBootstrapBatch(m_params, m_BTKey, ct);
+}
+
+CirBTSNoiseStats CirBTSContext::MeasureNoise(ConstLWEPrivateKey& sk, ConstRLWEPrivateKey& skNTT, uint32_t numRuns) const{
+    return m_cirbtsscheme->MeasureNoise(m_params, m_BTKey, sk, skNTT, numRuns);
+}
+
+RLWECiphertext CirBTSContext::EvalExternalProduct(ConstRGSWCiphertext& ctGSW, ConstRLWECiphertext& ct) const{
+    auto res = std::make_shared<RLWECiphertextImpl>(*ct);
+    BlindRotationWorkspace ws;
+    m_cirbtsscheme->EvalExternalProductInPlace(m_params, ctGSW, res, ws);
+    return res;
+}
+
+void CirBTSContext::EvalExternalProductInPlace(ConstRGSWCiphertext& ctGSW, RLWECiphertext& ct,
+                                               BlindRotationWorkspace& ws) const{
+    m_cirbtsscheme->EvalExternalProductInPlace(m_params, ctGSW, ct, ws);
+}
+
+RLWECiphertext CirBTSContext::EvalCMux(ConstRGSWCiphertext& sel, ConstRLWECiphertext& ct0,
+                                       ConstRLWECiphertext& ct1) const{
+    auto res = std::make_shared<RLWECiphertextImpl>(*ct0);
+    BlindRotationWorkspace ws;
+    m_cirbtsscheme->EvalCMuxInPlace(m_params, sel, res, ct1, ws);
+    return res;
+}
+
+void CirBTSContext::EvalCMuxInPlace(ConstRGSWCiphertext& sel, RLWECiphertext& ct0, ConstRLWECiphertext& ct1,
+                                    BlindRotationWorkspace& ws) const{
+    m_cirbtsscheme->EvalCMuxInPlace(m_params, sel, ct0, ct1, ws);
+}
+
+RLWECiphertext CirBTSContext::EvalLUT(const std::vector<RGSWCiphertext>& sel, const std::vector<uint64_t>& table,
+                                      uint32_t numOutputBits) const{
+    return m_cirbtsscheme->EvalLUT(m_params, sel, table, numOutputBits);
+}
+
 }
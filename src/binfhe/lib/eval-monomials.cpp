@@ -0,0 +1,86 @@
+#include "eval-monomials.h"
+
+#include <unordered_map>
+
+namespace lbcrypto {
+
+EvalMonomials::EvalMonomials(const std::shared_ptr<ILNativeParams>& polyParams) : m_polyParams(polyParams) {
+    uint32_t N{polyParams->GetRingDimension()};
+    uint32_t M{N << 1};
+    if (polyParams->GetCyclotomicOrder() != M || (M & (M - 1)))
+        OPENFHE_THROW("EvalMonomials requires a power-of-two cyclotomic ring");
+    m_mask = M - 1;
+
+    const NativeInteger& Q{polyParams->GetModulus()};
+    const NativeInteger& psi{polyParams->GetRootOfUnity()};
+    constexpr NativeInteger one{1};
+
+    // psi^t for 0 <= t < 2N
+    m_powers.resize(M);
+    m_powersPrecon.resize(M);
+    m_powersMinusOne.resize(M);
+    m_powersMinusOnePrecon.resize(M);
+    std::unordered_map<BasicInteger, uint32_t> logPsi;
+    logPsi.reserve(M);
+    NativeInteger power{1};
+    for (uint32_t t = 0; t < M; ++t) {
+        m_powers[t]               = power;
+        m_powersPrecon[t]         = power.PrepModMulConst(Q);
+        m_powersMinusOne[t]       = power.ModSubFast(one, Q);
+        m_powersMinusOnePrecon[t] = m_powersMinusOne[t].PrepModMulConst(Q);
+        logPsi[power.ConvertToInt<BasicInteger>()] = t;
+        power = power.ModMulFast(psi, Q);
+    }
+
+    // one forward NTT of X tells which power of psi every slot holds
+    NativePoly x(polyParams, Format::COEFFICIENT, true);
+    x[1] = one;
+    x.SetFormat(Format::EVALUATION);
+    m_exps.resize(N);
+    for (uint32_t j = 0; j < N; ++j) {
+        auto it = logPsi.find(x[j].ConvertToInt<BasicInteger>());
+        if (it == logPsi.end())
+            OPENFHE_THROW("EvalMonomials: slot is not a power of the root of unity");
+        m_exps[j] = it->second;
+    }
+}
+
+NativePoly EvalMonomials::GetMonomial(uint32_t k) const {
+    NativePoly result(m_polyParams, Format::EVALUATION, true);
+    uint32_t N{static_cast<uint32_t>(m_exps.size())};
+    for (uint32_t j = 0; j < N; ++j)
+        result[j] = m_powers[(m_exps[j] * k) & m_mask];
+    return result;
+}
+
+NativePoly EvalMonomials::GetMonomialMinusOne(uint32_t k) const {
+    NativePoly result(m_polyParams, Format::EVALUATION, true);
+    uint32_t N{static_cast<uint32_t>(m_exps.size())};
+    for (uint32_t j = 0; j < N; ++j)
+        result[j] = m_powersMinusOne[(m_exps[j] * k) & m_mask];
+    return result;
+}
+
+void EvalMonomials::MultiplyByMonomial(NativePoly& poly, uint32_t k) const {
+    if ((k & m_mask) == 0)
+        return;
+    MultiplyByTable(poly, k, m_powers, m_powersPrecon);
+}
+
+void EvalMonomials::MultiplyByMonomialMinusOne(NativePoly& poly, uint32_t k) const {
+    MultiplyByTable(poly, k, m_powersMinusOne, m_powersMinusOnePrecon);
+}
+
+void EvalMonomials::MultiplyByTable(NativePoly& poly, uint32_t k, const std::vector<NativeInteger>& table,
+                                    const std::vector<NativeInteger>& precon) const {
+    if (poly.GetFormat() != Format::EVALUATION)
+        OPENFHE_THROW("EvalMonomials: polynomial is not in Format::EVALUATION");
+    const NativeInteger& Q{m_polyParams->GetModulus()};
+    uint32_t N{static_cast<uint32_t>(m_exps.size())};
+    for (uint32_t j = 0; j < N; ++j) {
+        uint32_t t{(m_exps[j] * k) & m_mask};
+        poly[j].ModMulFastConstEq(table[t], Q, precon[t]);
+    }
+}
+
+}  // namespace lbcrypto
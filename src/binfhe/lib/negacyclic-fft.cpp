@@ -0,0 +1,188 @@
+#include "negacyclic-fft.h"
+
+#include "utils/exception.h"
+
+#include <cmath>
+#include <cstring>
+
+// the butterflies and the pointwise products are plain loops over split real and imaginary
+// arrays, so the FMA and AVX-512 clones are vectorized by the compiler
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(__clang__) && !defined(__MINGW64__)
+    #define FFT_TARGET_CLONES __attribute__((target_clones("arch=skylake-avx512", "arch=haswell", "default")))
+#else
+    #define FFT_TARGET_CLONES
+#endif
+
+namespace lbcrypto {
+
+namespace {
+
+// folds X^{N/2} = i and twists by exp(i*pi*j/N)
+FFT_TARGET_CLONES
+void FoldAndTwist(const double* __restrict in, const double* __restrict twistRe, const double* __restrict twistIm,
+                  double* __restrict re, double* __restrict im, uint32_t M) {
+    for (uint32_t j = 0; j < M; ++j) {
+        double xRe{in[j]};
+        double xIm{in[j + M]};
+        re[j] = xRe * twistRe[j] - xIm * twistIm[j];
+        im[j] = xRe * twistIm[j] + xIm * twistRe[j];
+    }
+}
+
+// the same with the coefficients mod Q centered in (-Q/2, Q/2]
+FFT_TARGET_CLONES
+void FoldAndTwistCentered(const uint64_t* __restrict in, uint64_t Q, const double* __restrict twistRe,
+                          const double* __restrict twistIm, double* __restrict re, double* __restrict im,
+                          uint32_t M) {
+    const uint64_t QHalf{Q >> 1};
+    for (uint32_t j = 0; j < M; ++j) {
+        // centered in the integers, as Q itself need not be representable as a double
+        double xRe{static_cast<double>(static_cast<int64_t>(in[j] - (in[j] > QHalf ? Q : 0)))};
+        double xIm{static_cast<double>(static_cast<int64_t>(in[j + M] - (in[j + M] > QHalf ? Q : 0)))};
+        re[j] = xRe * twistRe[j] - xIm * twistIm[j];
+        im[j] = xRe * twistIm[j] + xIm * twistRe[j];
+    }
+}
+
+// Gentleman-Sande butterflies: natural order in, bit-reversed order out
+FFT_TARGET_CLONES
+void ForwardButterflies(double* __restrict re, double* __restrict im, const double* __restrict rootRe,
+                        const double* __restrict rootIm, uint32_t M) {
+    for (uint32_t h = M >> 1; h >= 1; h >>= 1) {
+        const double* wRe = rootRe + h;
+        const double* wIm = rootIm + h;
+        for (uint32_t s = 0; s < M; s += 2 * h) {
+            double* xRe = re + s;
+            double* xIm = im + s;
+            double* yRe = re + s + h;
+            double* yIm = im + s + h;
+            for (uint32_t j = 0; j < h; ++j) {
+                double dRe{xRe[j] - yRe[j]};
+                double dIm{xIm[j] - yIm[j]};
+                xRe[j] += yRe[j];
+                xIm[j] += yIm[j];
+                yRe[j] = dRe * wRe[j] - dIm * wIm[j];
+                yIm[j] = dRe * wIm[j] + dIm * wRe[j];
+            }
+        }
+    }
+}
+
+// Cooley-Tukey butterflies with the conjugate twiddles: bit-reversed order in, natural order out
+FFT_TARGET_CLONES
+void InverseButterflies(double* __restrict re, double* __restrict im, const double* __restrict rootRe,
+                        const double* __restrict rootIm, uint32_t M) {
+    for (uint32_t h = 1; h < M; h <<= 1) {
+        const double* wRe = rootRe + h;
+        const double* wIm = rootIm + h;
+        for (uint32_t s = 0; s < M; s += 2 * h) {
+            double* xRe = re + s;
+            double* xIm = im + s;
+            double* yRe = re + s + h;
+            double* yIm = im + s + h;
+            for (uint32_t j = 0; j < h; ++j) {
+                double vRe{yRe[j] * wRe[j] + yIm[j] * wIm[j]};
+                double vIm{yIm[j] * wRe[j] - yRe[j] * wIm[j]};
+                yRe[j] = xRe[j] - vRe;
+                yIm[j] = xIm[j] - vIm;
+                xRe[j] += vRe;
+                xIm[j] += vIm;
+            }
+        }
+    }
+}
+
+// untwists, scales by 1/M and unfolds; adding 1.5 * 2^52 rounds to the nearest integer in the
+// low mantissa bits, which is exact and branch-free for |x| < 2^51
+FFT_TARGET_CLONES
+void UntwistAndRound(const double* __restrict re, const double* __restrict im, const double* __restrict twistRe,
+                     const double* __restrict twistIm, int64_t* __restrict out, uint32_t M) {
+    constexpr double ROUND_SHIFT{6755399441055744.0};
+    constexpr int64_t ROUND_SHIFT_BITS{0x4338000000000000};
+    double scale{1.0 / M};
+    for (uint32_t j = 0; j < M; ++j) {
+        double xRe{re[j] * scale};
+        double xIm{im[j] * scale};
+        double lo{xRe * twistRe[j] + xIm * twistIm[j] + ROUND_SHIFT};
+        double hi{xIm * twistRe[j] - xRe * twistIm[j] + ROUND_SHIFT};
+        int64_t loBits;
+        int64_t hiBits;
+        std::memcpy(&loBits, &lo, sizeof(double));
+        std::memcpy(&hiBits, &hi, sizeof(double));
+        out[j]     = loBits - ROUND_SHIFT_BITS;
+        out[j + M] = hiBits - ROUND_SHIFT_BITS;
+    }
+}
+
+FFT_TARGET_CLONES
+void MultiplyAddKernel(double* __restrict accRe, double* __restrict accIm, const double* __restrict aRe,
+                       const double* __restrict aIm, const double* __restrict bRe, const double* __restrict bIm,
+                       uint32_t M) {
+    for (uint32_t k = 0; k < M; ++k) {
+        accRe[k] += aRe[k] * bRe[k] - aIm[k] * bIm[k];
+        accIm[k] += aRe[k] * bIm[k] + aIm[k] * bRe[k];
+    }
+}
+
+}  // namespace
+
+NegacyclicFFT::NegacyclicFFT(uint32_t N) : m_N(N) {
+    if (N < 2 || (N & (N - 1)))
+        OPENFHE_THROW("NegacyclicFFT requires a power-of-two ring dimension");
+    uint32_t M{N >> 1};
+    // the angles are evaluated in long double so that the tables are correctly rounded
+    const long double pi{std::acos(-1.0L)};
+
+    m_twistRe.resize(M);
+    m_twistIm.resize(M);
+    for (uint32_t j = 0; j < M; ++j) {
+        long double angle{pi * j / N};
+        m_twistRe[j] = static_cast<double>(std::cos(angle));
+        m_twistIm[j] = static_cast<double>(std::sin(angle));
+    }
+
+    m_rootRe.resize(M);
+    m_rootIm.resize(M);
+    for (uint32_t h = 1; h < M; h <<= 1) {
+        for (uint32_t j = 0; j < h; ++j) {
+            long double angle{-pi * j / h};
+            m_rootRe[h + j] = static_cast<double>(std::cos(angle));
+            m_rootIm[h + j] = static_cast<double>(std::sin(angle));
+        }
+    }
+}
+
+void NegacyclicFFT::Forward(const double* in, FFTPoly& out) const {
+    uint32_t M{m_N >> 1};
+    out.resize(m_N);
+    double* re = out.data();
+    double* im = re + M;
+    FoldAndTwist(in, m_twistRe.data(), m_twistIm.data(), re, im, M);
+    ForwardButterflies(re, im, m_rootRe.data(), m_rootIm.data(), M);
+}
+
+void NegacyclicFFT::Forward(const uint64_t* in, uint64_t Q, FFTPoly& out) const {
+    uint32_t M{m_N >> 1};
+    out.resize(m_N);
+    double* re = out.data();
+    double* im = re + M;
+    FoldAndTwistCentered(in, Q, m_twistRe.data(), m_twistIm.data(), re, im, M);
+    ForwardButterflies(re, im, m_rootRe.data(), m_rootIm.data(), M);
+}
+
+void NegacyclicFFT::Inverse(FFTPoly& in, int64_t* out) const {
+    uint32_t M{m_N >> 1};
+    if (in.size() != m_N)
+        OPENFHE_THROW("the FFT polynomial does not match the ring dimension");
+    double* re = in.data();
+    double* im = re + M;
+    InverseButterflies(re, im, m_rootRe.data(), m_rootIm.data(), M);
+    UntwistAndRound(re, im, m_twistRe.data(), m_twistIm.data(), out, M);
+}
+
+void NegacyclicFFT::MultiplyAdd(FFTPoly& acc, const FFTPoly& a, const FFTPoly& b) {
+    uint32_t M = acc.size() >> 1;
+    MultiplyAddKernel(acc.data(), acc.data() + M, a.data(), a.data() + M, b.data(), b.data() + M, M);
+}
+
+}  // namespace lbcrypto
@@ -1,33 +1,151 @@
 #include "rgsw-acc-cggi-binary.h"
+#include "signed-digit-decompose.h"
+#include "cirbts-trace.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <string>
 
 namespace lbcrypto {
 
+// largest number of keys per group, for the key unroll factor 3
+constexpr uint32_t MAX_UNROLL_PATTERNS = 7;
+
 // Key generation as described in Section 4 of https://eprint.iacr.org/2014/816
+// With key unrolling the secret is split into groups of u bits; the key k - 1 of a group encrypts
+// the indicator [s_group = k] for every nonzero bit pattern k, as in https://eprint.iacr.org/2017/430
 RingGSWACCKey RingGSWAccumulatorCGGI2::KeyGenAcc(const std::shared_ptr<RingGSWCryptoParams>& params,
                                                 const NativePoly& skNTT, ConstLWEPrivateKey& LWEsk) const {
     auto sv    = LWEsk->GetElement();
     uint32_t n = sv.GetLength();
-    auto ek    = std::make_shared<RingGSWACCKeyImpl>(1, 1, n);
-    auto& ek00 = (*ek)[0][0];
-
-    // handles binary secret
-#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(n))
-    for (uint32_t i = 0; i < n; ++i) {
-        auto s  = sv[i].ConvertToInt();
-        ek00[i] = KeyGenCGGI(params, skNTT, s);
+    uint32_t unroll{params->GetKeyUnrollFactor()};
+    uint32_t numGroups{(n + unroll - 1) / unroll};
+    uint32_t numPatterns{(1u << unroll) - 1};
+    auto ek    = std::make_shared<RingGSWACCKeyImpl>(1, numPatterns, numGroups);
+    auto& ek0  = (*ek)[0];
+
+    // handles binary secret; every group draws its samples from its own stream
+    auto seed = PRNGStream::Current();
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(numGroups))
+    for (uint32_t g = 0; g < numGroups; ++g) {
+        PRNGStream stream(seed, g);
+        // bit j of the pattern of the group is the coefficient g * u + j, zero past the end
+        uint32_t pattern{0};
+        for (uint32_t j = 0; j < unroll && g * unroll + j < n; ++j)
+            pattern |= static_cast<uint32_t>(sv[g * unroll + j].ConvertToInt() & 0x1) << j;
+        for (uint32_t k = 1; k <= numPatterns; ++k)
+            ek0[k - 1][g] = KeyGenCGGI(params, skNTT, pattern == k);
     }
     return ek;
 }
 
 void RingGSWAccumulatorCGGI2::EvalAcc(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCKey& ek,
                                      RLWECiphertext& acc, const NativeVector& a) const {
-    size_t n{a.GetLength()};
-    auto mod{a.GetModulus()};
-    auto MbyMod{NativeInteger(2 * params->GetN()) / mod};
-    for (size_t i = 0; i < n; ++i) {
-        AddToAccCGGI(params, (*ek)[0][0][i], a[i] * MbyMod, acc);
+    BlindRotationWorkspace ws;
+    EvalAcc(params, ek, acc, a, ws);
+}
+
+void RingGSWAccumulatorCGGI2::EvalAcc(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCKey& ek,
+                                     RLWECiphertext& acc, const NativeVector& a, BlindRotationWorkspace& ws) const {
+    uint32_t numGroups{CheckUnrolledKey(params, (*ek)[0].size(), (*ek)[0][0].size(), a.GetLength())};
+    std::vector<uint32_t> exps;
+    for (uint32_t g = 0; g < numGroups; ++g) {
+        GroupExponents(params, a, g, exps);
+        AddToAccCGGI(params, (*ek)[0], g, exps, acc, ws);
+    }
+}
+
+void RingGSWAccumulatorCGGI2::EvalAccBatch(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCKey& ek,
+                                           std::vector<RLWECiphertext>& acc, const std::vector<NativeVector>& a) const {
+    if (acc.size() != a.size())
+        OPENFHE_THROW("the number of accumulators and LWE vectors should be the same");
+    uint32_t numAcc = acc.size();
+    if (numAcc == 0)
+        return;
+    uint32_t numGroups{CheckUnrolledKey(params, (*ek)[0].size(), (*ek)[0][0].size(), a[0].GetLength())};
+    const auto& ek0 = (*ek)[0];
+    // the static schedule keeps every accumulator on the same thread for all steps and
+    // the implicit barrier of the omp for keeps the threads in lockstep on key group g
+#pragma omp parallel num_threads(OpenFHEParallelControls.GetThreadLimit(numAcc)) if (!omp_in_parallel())
+    {
+        BlindRotationWorkspace ws;
+        std::vector<uint32_t> exps;
+        for (uint32_t g = 0; g < numGroups; ++g) {
+#pragma omp for schedule(static)
+            for (uint32_t j = 0; j < numAcc; ++j) {
+                GroupExponents(params, a[j], g, exps);
+                AddToAccCGGI(params, ek0, g, exps, acc[j], ws);
+            }
+        }
+    }
+}
+
+void RingGSWAccumulatorCGGI2::EvalAccFFT(const std::shared_ptr<RingGSWCryptoParams>& params,
+                                         ConstRingGSWACCFFTKey& ek, RLWECiphertext& acc, const NativeVector& a,
+                                         BlindRotationWorkspace& ws) const {
+    uint32_t numGroups{CheckUnrolledKey(params, ek->GetNumPatterns(), ek->size() / ek->GetNumPatterns(), a.GetLength())};
+    std::vector<uint32_t> exps;
+    acc->SetFormat(Format::COEFFICIENT);
+    for (uint32_t g = 0; g < numGroups; ++g) {
+        GroupExponents(params, a, g, exps);
+        AddToAccCGGIFFT(params, *ek, g, exps, acc, ws);
+    }
+    acc->SetFormat(Format::EVALUATION);
+}
+
+void RingGSWAccumulatorCGGI2::EvalAccBatchFFT(const std::shared_ptr<RingGSWCryptoParams>& params,
+                                              ConstRingGSWACCFFTKey& ek, std::vector<RLWECiphertext>& acc,
+                                              const std::vector<NativeVector>& a) const {
+    if (acc.size() != a.size())
+        OPENFHE_THROW("the number of accumulators and LWE vectors should be the same");
+    uint32_t numAcc = acc.size();
+    if (numAcc == 0)
+        return;
+    uint32_t numGroups{
+        CheckUnrolledKey(params, ek->GetNumPatterns(), ek->size() / ek->GetNumPatterns(), a[0].GetLength())};
+#pragma omp parallel num_threads(OpenFHEParallelControls.GetThreadLimit(numAcc)) if (!omp_in_parallel())
+    {
+        BlindRotationWorkspace ws;
+        std::vector<uint32_t> exps;
+#pragma omp for schedule(static)
+        for (uint32_t j = 0; j < numAcc; ++j)
+            acc[j]->SetFormat(Format::COEFFICIENT);
+        for (uint32_t g = 0; g < numGroups; ++g) {
+#pragma omp for schedule(static)
+            for (uint32_t j = 0; j < numAcc; ++j) {
+                GroupExponents(params, a[j], g, exps);
+                AddToAccCGGIFFT(params, *ek, g, exps, acc[j], ws);
+            }
+        }
+#pragma omp for schedule(static)
+        for (uint32_t j = 0; j < numAcc; ++j)
+            acc[j]->SetFormat(Format::EVALUATION);
+    }
+}
+
+uint32_t RingGSWAccumulatorCGGI2::CheckUnrolledKey(const std::shared_ptr<RingGSWCryptoParams>& params,
+                                                   uint32_t numPatterns, uint32_t numGroups, uint32_t n) const {
+    uint32_t unroll{params->GetKeyUnrollFactor()};
+    if (numPatterns != (1u << unroll) - 1 || numGroups != (n + unroll - 1) / unroll)
+        OPENFHE_THROW("the refresh key was not generated for the key unroll factor " + std::to_string(unroll));
+    return numGroups;
+}
+
+void RingGSWAccumulatorCGGI2::GroupExponents(const std::shared_ptr<RingGSWCryptoParams>& params, const NativeVector& a,
+                                             uint32_t g, std::vector<uint32_t>& exps) const {
+    uint32_t n{static_cast<uint32_t>(a.GetLength())};
+    uint32_t unroll{params->GetKeyUnrollFactor()};
+    uint32_t M{2 * params->GetN()};
+    uint32_t MbyMod{M / a.GetModulus().ConvertToInt<uint32_t>()};
+    exps.assign((1u << unroll) - 1, 0);
+    // exps[k - 1] = sum of a_{g * u + j} * 2N / q over the bits j set in k, mod 2N
+    for (uint32_t j = 0; j < unroll && g * unroll + j < n; ++j) {
+        uint32_t aj{(a[g * unroll + j].ConvertToInt<uint32_t>() * MbyMod) & (M - 1)};
+        for (uint32_t k = 1; k <= exps.size(); ++k) {
+            if ((k >> j) & 0x1)
+                exps[k - 1] = (exps[k - 1] + aj) & (M - 1);
+        }
     }
 }
 
@@ -37,115 +155,219 @@ RingGSWEvalKey RingGSWAccumulatorCGGI2::KeyGenCGGI(const std::shared_ptr<RingGSW
     const auto& Gpow       = params->GetAGPower();
     const auto& polyParams = params->GetPolyParams();
 
-    DiscreteUniformGeneratorImpl<NativeVector> dug;
     NativeInteger Q{params->GetQ()};
 
     // approximate gadget decomposition is used
     uint32_t digits = params->GetDigitsGA();
     uint32_t digitsG2{digits << 1};
 
-    std::vector<NativePoly> tempA(digitsG2, NativePoly(dug, polyParams, Format::COEFFICIENT));
+    // the uniform part of every row is generated from a seed, so the message of the even rows
+    // cannot be added to it; (a + mG, as + e) is the same encryption as (a, as + e - mGs)
     RingGSWEvalKeyImpl result(digitsG2, 2);
+    std::vector<PolySeed> seeds(digitsG2);
 
     for (uint32_t i = 0; i < digitsG2; ++i) {
-        result[i][0] = tempA[i];
-        tempA[i].SetFormat(Format::EVALUATION);
+        seeds[i]     = SeededUniformGenerator::GenerateSeed();
+        result[i][0] = SeededUniformGenerator::Expand(polyParams, seeds[i]);
         result[i][1] = NativePoly(params->GetDgg(), polyParams, Format::COEFFICIENT);
-        if (m)
-            result[i][i & 0x1][0].ModAddFastEq(Gpow[i >> 1], Q);
-        result[i][0].SetFormat(Format::EVALUATION);
+        if (m && (i & 0x1))
+            result[i][1][0].ModAddFastEq(Gpow[i >> 1], Q);
         result[i][1].SetFormat(Format::EVALUATION);
-        result[i][1] += (tempA[i] *= skNTT);
+        result[i][1] += result[i][0] * skNTT;
+        if (m && !(i & 0x1))
+            result[i][1] -= skNTT * Gpow[i >> 1];
     }
+    result.SetSeeds(std::move(seeds));
     return std::make_shared<RingGSWEvalKeyImpl>(result);
 }
 
 // CGGI Accumulation as described in https://eprint.iacr.org/2020/086
 // We optimize the algorithm by multiplying the monomial after the external product
 // This reduces the number of polynomial multiplications which further reduces the runtime
-void RingGSWAccumulatorCGGI2::AddToAccCGGI(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWEvalKey& ek,
-                                             const NativeInteger& a, RLWECiphertext& acc) const {
-    std::vector<NativePoly> ct(acc->GetElements());
-    ct[0].SetFormat(Format::COEFFICIENT);
-    ct[1].SetFormat(Format::COEFFICIENT);
-   
+// All intermediate polynomials live in the workspace, so the update does not allocate
+// With key unrolling, acc += sum_k (X^exps[k] - 1) * (dct * ek_k): the decomposition and its forward
+// NTTs are shared by all the keys of the group and the keys with X^0 - 1 = 0 are skipped
+void RingGSWAccumulatorCGGI2::AddToAccCGGI(const std::shared_ptr<RingGSWCryptoParams>& params,
+                                           const std::vector<std::vector<RingGSWEvalKey>>& ek, uint32_t g,
+                                           const std::vector<uint32_t>& exps, RLWECiphertext& acc,
+                                           BlindRotationWorkspace& ws) const {
+    CirBTSTraceScope span("AddToAccCGGI");
+    // one product per RLWE component and bit pattern with a nonzero monomial
+    uint32_t numPatterns = exps.size();
+    std::array<uint32_t, 2 * MAX_UNROLL_PATTERNS> tasks;
+    uint32_t numTasks{0};
+    for (uint32_t k = 0; k < numPatterns; ++k) {
+        if (exps[k] != 0) {
+            tasks[numTasks++] = k << 1;
+            tasks[numTasks++] = (k << 1) | 0x1;
+        }
+    }
+    if (numTasks == 0)
+        return;
+
     // approximate gadget decomposition is used
     uint32_t digitsG2{(params->GetDigitsGA()) << 1};
-    std::vector<NativePoly> dct(digitsG2, NativePoly(params->GetPolyParams(), Format::COEFFICIENT, true));
-
-    SignedDigitDecompose2(params, ct, dct);
-
-#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(digitsG2))
-    for (uint32_t i = 0; i < digitsG2; ++i)
-        dct[i].SetFormat(Format::EVALUATION);
-
-    // obtain monomial(index)
-    uint32_t indexPos{a.ConvertToInt<uint32_t>()};
-    const NativePoly& monomial = params->GetMonomial(indexPos);
-
-    // acc = acc + dct * ek * monomial;
-    // uses in-place * operators for the last call to dct[i] to gain performance
-    // improvement. 
-    // TODO (dsuponit): benchmark cases with operator*() and operator*=(). Make a copy of dct?
-
-    const std::vector<std::vector<NativePoly>>& ev(ek->GetElements());
-    NativePoly tmp(dct[0] * ev[0][0]);
-    for (uint32_t i = 1; i < digitsG2; ++i)
-        tmp += (dct[i] * ev[i][0]);
-    acc->GetElements()[0] += (tmp *= monomial);
-    tmp = (dct[0] * ev[0][1]);
-    for (uint32_t i = 1; i < digitsG2; ++i)
-        tmp += (dct[i] * ev[i][1]);
-    acc->GetElements()[1] += (tmp *= monomial);
+    ws.Reserve(params->GetPolyParams(), digitsG2, numTasks);
+
+    auto& ct = ws.GetCt();
+    ct[0] = acc->GetElements()[0];
+    ct[1] = acc->GetElements()[1];
+    ct[0].SetFormat(Format::COEFFICIENT);
+    ct[1].SetFormat(Format::COEFFICIENT);
+
+    // every digit is overwritten by the decomposition
+    auto& dct = ws.GetDigits();
+    SignedDigitDecompose2(params, ct, dct, Format::EVALUATION);
+
+    // monomial(index) = X^index - 1 is applied as a pointwise multiply
+    const auto& monomials = params->GetMonomials();
+
+    // prod[t] = dct * ek_k[., c] * monomial_k for the task t = (k, c), accumulated in place; the
+    // tasks are independent, so a single accumulator spreads them over the threads, while a
+    // batch (already parallel over the ciphertexts) runs them serially
+    auto& prod = ws.GetProducts();
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(numTasks)) if (!omp_in_parallel())
+    for (uint32_t t = 0; t < numTasks; ++t) {
+        CirBTSTraceScope taskSpan("AddToAccCGGI.product");
+        uint32_t k{tasks[t] >> 1};
+        uint32_t c{tasks[t] & 0x1};
+        const auto& ev{*ek[k][g]};
+        auto& p = prod[t];
+        p       = dct[0];
+        MultiplyKeyElement(p, ev.GetElementData(0, c));
+        for (uint32_t i = 1; i < digitsG2; ++i)
+            MultiplyAddKeyElement(dct[i], ev.GetElementData(i, c), p);
+        monomials.MultiplyByMonomialMinusOne(p, exps[k]);
+    }
+
+    // acc = acc + dct * ek * monomial
+    for (uint32_t t = 0; t < numTasks; ++t)
+        acc->GetElements()[tasks[t] & 0x1] += prod[t];
 }
 
-void RingGSWAccumulatorCGGI2::SignedDigitDecompose2(const std::shared_ptr<RingGSWCryptoParams>& params, const std::vector<NativePoly>& input,
-                              std::vector<NativePoly>& output) const{
-    auto Q{params->GetQ()};
-    auto Q_int{Q.ConvertToInt<NativeInteger::SignedNativeInt>()};
-    auto QHalf = Q.ConvertToInt<BasicInteger>() >> 1;
-    auto base = params->GetBaseG();
-    auto gBits{static_cast<NativeInteger::SignedNativeInt>(__builtin_ctz(base))};
+static_assert(sizeof(NativeInteger) == sizeof(uint64_t), "NativeInteger is expected to wrap a single uint64_t");
 
-    //the length of approximate decomposition
-    auto digits = params->GetDigitsGA();
-    //the bits should be ignored
-    uint32_t ignore_bits = 54 - digits * gBits;
-    //the bits should be remained
-    auto gBitsMaxBits{static_cast<NativeInteger::SignedNativeInt>(NativeInteger::MaxBits() - ignore_bits)};
-    // approximate gadget decomposition is used;
-    uint32_t digitsG2{digits << 1};
-    uint32_t N{params->GetN()};
+// x + y mod q for x < q and y <= q, written so that it compiles to a conditional move
+static inline uint64_t ModAddBranchless(uint64_t x, uint64_t y, uint64_t q) {
+    uint64_t s{x + y};
+    return s >= q ? s - q : s;
+}
 
-    auto gBitsMaxBits0{static_cast<NativeInteger::SignedNativeInt>(NativeInteger::MaxBits() - gBits)};
+// CGGI Accumulation with the external product in the double-precision FFT domain. The key
+// coefficients are split into limbs small enough that the whole blind rotation rounds the
+// products of the limbs to the right integers except with probability below 2^-40 (see
+// RingGSWACCFFTKeyImpl), and the limbs are recombined mod Q; the monomial X^a - 1 is applied
+// to the coefficients directly.
+// The forward FFTs of the digits are shared by all the keys of the group
+void RingGSWAccumulatorCGGI2::AddToAccCGGIFFT(const std::shared_ptr<RingGSWCryptoParams>& params,
+                                              const RingGSWACCFFTKeyImpl& ek, uint32_t g,
+                                              const std::vector<uint32_t>& exps, RLWECiphertext& acc,
+                                              BlindRotationWorkspace& ws) const {
+    CirBTSTraceScope span("AddToAccCGGIFFT");
+    // one product per RLWE component and bit pattern with a nonzero monomial
+    uint32_t numPatterns = exps.size();
+    std::array<uint32_t, 2 * MAX_UNROLL_PATTERNS> tasks;
+    uint32_t numTasks{0};
+    for (uint32_t k = 0; k < numPatterns; ++k) {
+        if (exps[k] != 0) {
+            tasks[numTasks++] = k << 1;
+            tasks[numTasks++] = (k << 1) | 0x1;
+        }
+    }
+    if (numTasks == 0)
+        return;
 
-    for (uint32_t k{0}; k < N; ++k) {
-        auto t0{input[0][k].ConvertToInt<BasicInteger>()};
-        auto d0{static_cast<NativeInteger::SignedNativeInt>(t0 < QHalf ? t0 : t0 - Q_int)};
-        auto t1{input[1][k].ConvertToInt<BasicInteger>()};
-        auto d1{static_cast<NativeInteger::SignedNativeInt>(t1 < QHalf ? t1 : t1 - Q_int)};
+    uint32_t digitsG2{(params->GetDigitsGA()) << 1};
+    uint32_t numLimbs{params->GetFFTNumLimbs()};
+    uint32_t N{params->GetN()};
+    const auto& fft = params->GetFFT();
+    const NativeInteger& Q{params->GetQ()};
+    uint64_t q{Q.ConvertToInt<uint64_t>()};
+    bool smallQ{q <= (uint64_t(1) << 51)};
+    ws.Reserve(params->GetPolyParams(), digitsG2);
+    ws.ReserveFFT(N, digitsG2, numLimbs, 2 * MAX_UNROLL_PATTERNS);
 
-        auto r0 = (d0 << gBitsMaxBits) >> gBitsMaxBits;
-        d0 = (d0 - r0) >> ignore_bits;
+    auto& elements = acc->GetElements();
+    auto& dct      = ws.GetDigits();
+    SignedDigitDecompose2(params, elements, dct);
 
-        auto r1 = (d1 << gBitsMaxBits) >> gBitsMaxBits;
-        d1 = (d1 - r1) >> ignore_bits;
+    // centered digits to the FFT domain
+    auto& fdct = ws.GetFFTDigits();
+    for (uint32_t d = 0; d < digitsG2; ++d)
+        fft.Forward(reinterpret_cast<const uint64_t*>(&dct[d][0]), q, fdct[d]);
 
+    // 2^(l * limbBits) for the recombination of the limbs
+    const auto& w       = params->GetFFTLimbPowers();
+    const auto& wPrecon = params->GetFFTLimbPowersPrecon();
 
-        for (uint32_t d{0}; d < digitsG2; d += 2) {
-            r0 = (d0 << gBitsMaxBits0) >> gBitsMaxBits0;
-            d0 = (d0 - r0) >> gBits;
-            if (r0 < 0)
-                r0 += Q_int;
-            output[d + 0][k] += r0;
+    // the product of task t = (k, c) is written over its first limb; as in AddToAccCGGI the
+    // tasks are spread over the threads only for a single accumulator
+    auto& fprod = ws.GetFFTProducts();
+    auto& limbs = ws.GetLimbs();
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(numTasks)) if (!omp_in_parallel())
+    for (uint32_t t = 0; t < numTasks; ++t) {
+        CirBTSTraceScope taskSpan("AddToAccCGGIFFT.product");
+        uint32_t k{tasks[t] >> 1};
+        uint32_t c{tasks[t] & 0x1};
+        const auto& ekk = ek[g * numPatterns + k];
+        int64_t* tlimbs = limbs.data() + t * numLimbs * N;
+        for (uint32_t l = 0; l < numLimbs; ++l) {
+            auto& fp = fprod[t * numLimbs + l];
+            std::fill(fp.begin(), fp.end(), 0.0);
+            for (uint32_t d = 0; d < digitsG2; ++d)
+                NegacyclicFFT::MultiplyAdd(fp, fdct[d], ekk[(2 * d + c) * numLimbs + l]);
+            fft.Inverse(fp, tlimbs + l * N);
+        }
 
-            r1 = (d1 << gBitsMaxBits0) >> gBitsMaxBits0;
-            d1 = (d1 - r1) >> gBits;
-            if (r1 < 0)
-                r1 += Q_int;
-            output[d + 1][k] += r1;
+        // prod = sum_l limb_l * 2^(l * limbBits) mod Q; the rounded limbs are below 2^51,
+        // so a single conditional add of Q centers them for Q > 2^51
+        auto* prod = reinterpret_cast<uint64_t*>(tlimbs);
+        for (uint32_t i = 0; i < N; ++i) {
+            uint64_t sum{0};
+            for (uint32_t l = 0; l < numLimbs; ++l) {
+                int64_t v{tlimbs[l * N + i]};
+                if (smallQ)
+                    v %= static_cast<int64_t>(q);
+                uint64_t r{static_cast<uint64_t>(v) + (v < 0 ? q : 0)};
+                if (l > 0)
+                    r = NativeInteger(r).ModMulFastConst(w[l], Q, wPrecon[l]).ConvertToInt<uint64_t>();
+                sum += r;
+                sum = sum >= q ? sum - q : sum;
+            }
+            prod[i] = sum;
         }
-    }                                
+    }
+
+    // acc += prod * X^exps[k] - prod; the coefficients wrapping around X^N change sign
+    for (uint32_t t = 0; t < numTasks; ++t) {
+        uint32_t k{tasks[t] >> 1};
+        uint32_t c{tasks[t] & 0x1};
+        const auto* prod = reinterpret_cast<const uint64_t*>(limbs.data() + t * numLimbs * N);
+        auto* e          = reinterpret_cast<uint64_t*>(&elements[c][0]);
+        uint32_t shift{exps[k] & (N - 1)};
+        bool negate{exps[k] >= N};
+        uint64_t negLow{negate ? q : 0};
+        uint64_t negHigh{negate ? 0 : q};
+        for (uint32_t i = 0; i < N - shift; ++i)
+            e[i + shift] = ModAddBranchless(e[i + shift], negLow ? negLow - prod[i] : prod[i], q);
+        for (uint32_t i = N - shift; i < N; ++i)
+            e[i + shift - N] = ModAddBranchless(e[i + shift - N], negHigh ? negHigh - prod[i] : prod[i], q);
+        for (uint32_t i = 0; i < N; ++i)
+            e[i] = ModAddBranchless(e[i], q - prod[i], q);
+    }
+}
+
+void RingGSWAccumulatorCGGI2::SignedDigitDecompose2(const std::shared_ptr<RingGSWCryptoParams>& params, const std::vector<NativePoly>& input,
+                              std::vector<NativePoly>& output, Format format) const{
+    auto gBits{static_cast<uint32_t>(__builtin_ctz(params->GetBaseG()))};
+
+    //the length of approximate decomposition
+    auto digits = params->GetDigitsGA();
+    //the bits should be ignored
+    uint32_t ignore_bits = params->GetIgnoreBitsGA();
+
+    DecomposeSignedDigits(input[0], params->GetQ(), gBits, ignore_bits, digits, output, 0, 2, format);
+    DecomposeSignedDigits(input[1], params->GetQ(), gBits, ignore_bits, digits, output, 1, 2, format);
 }
 
 };  // namespace lbcrypto
@@ -109,20 +109,14 @@ void RingGSWAccumulatorCGGI::AddToAccCGGI(const std::shared_ptr<RingGSWCryptoPar
     uint32_t digitsG2{(params->GetDigitsG() - 1) << 1};
     std::vector<NativePoly> dct(digitsG2, NativePoly(params->GetPolyParams(), Format::COEFFICIENT, true));
 
-    SignedDigitDecompose(params, ct, dct);
+    SignedDigitDecompose(params, ct, dct, Format::EVALUATION);
 
-#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(digitsG2))
-    for (uint32_t i = 0; i < digitsG2; ++i)
-        dct[i].SetFormat(Format::EVALUATION);
-
-    // obtain both monomial(index) for sk = 1 and monomial(-index) for sk = -1
-    // index is in range [0,m] - so we need to adjust the edge case when index == m to index = 0
-    uint32_t MInt{2 * params->GetN()};
-    NativeInteger M{MInt};
+    // both monomial(index) for sk = 1 and monomial(-index) for sk = -1 are applied
+    // as pointwise multiplies; the exponents are taken mod m so index == m needs no adjustment
+    NativeInteger M{2 * params->GetN()};
     uint32_t indexPos{a.ConvertToInt<uint32_t>()};
-    const NativePoly& monomial = params->GetMonomial(indexPos == MInt ? 0 : indexPos);
     uint32_t indexNeg{NativeInteger(0).ModSubFast(a, M).ConvertToInt<uint32_t>()};
-    const NativePoly& monomialNeg = params->GetMonomial(indexNeg == MInt ? 0 : indexNeg);
+    const auto& monomials = params->GetMonomials();
 
     // acc = acc + dct * ek1 * monomial + dct * ek2 * negative_monomial;
     // uses in-place * operators for the last call to dct[i] to gain performance
@@ -133,21 +127,25 @@ void RingGSWAccumulatorCGGI::AddToAccCGGI(const std::shared_ptr<RingGSWCryptoPar
     NativePoly tmp(dct[0] * ev1[0][0]);
     for (uint32_t i = 1; i < digitsG2; ++i)
         tmp += (dct[i] * ev1[i][0]);
-    acc->GetElements()[0] += (tmp *= monomial);
+    monomials.MultiplyByMonomialMinusOne(tmp, indexPos);
+    acc->GetElements()[0] += tmp;
     tmp = (dct[0] * ev1[0][1]);
     for (uint32_t i = 1; i < digitsG2; ++i)
         tmp += (dct[i] * ev1[i][1]);
-    acc->GetElements()[1] += (tmp *= monomial);
+    monomials.MultiplyByMonomialMinusOne(tmp, indexPos);
+    acc->GetElements()[1] += tmp;
 
     const std::vector<std::vector<NativePoly>>& ev2(ek2->GetElements());
     tmp = (dct[0] * ev2[0][0]);
     for (uint32_t i = 1; i < digitsG2; ++i)
         tmp += (dct[i] * ev2[i][0]);
-    acc->GetElements()[0] += (tmp *= monomialNeg);
+    monomials.MultiplyByMonomialMinusOne(tmp, indexNeg);
+    acc->GetElements()[0] += tmp;
     tmp = (dct[0] * ev2[0][1]);
     for (uint32_t i = 1; i < digitsG2; ++i)
         tmp += (dct[i] *= ev2[i][1]);
-    acc->GetElements()[1] += (tmp *= monomialNeg);
+    monomials.MultiplyByMonomialMinusOne(tmp, indexNeg);
+    acc->GetElements()[1] += tmp;
 }
 
 };  // namespace lbcrypto
@@ -125,11 +125,7 @@ void RingGSWAccumulatorDM::AddToAccDM(const std::shared_ptr<RingGSWCryptoParams>
     uint32_t digitsG2{(params->GetDigitsG() - 1) << 1};
     std::vector<NativePoly> dct(digitsG2, NativePoly(params->GetPolyParams(), Format::COEFFICIENT, true));
 
-    SignedDigitDecompose(params, ct, dct);
-
-#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(digitsG2))
-    for (uint32_t j = 0; j < digitsG2; ++j)
-        dct[j].SetFormat(Format::EVALUATION);
+    SignedDigitDecompose(params, ct, dct, Format::EVALUATION);
 
     // acc = dct * ek (matrix product);
     // uses in-place * operators for the last call to dct[i] to gain performance improvement
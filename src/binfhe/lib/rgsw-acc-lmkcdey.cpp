@@ -30,6 +30,7 @@
 //==================================================================================
 
 #include "rgsw-acc-lmkcdey.h"
+#include "cirbts-trace.h"
 
 #include <string>
 
@@ -50,111 +51,128 @@ RingGSWACCKey RingGSWAccumulatorLMKCDEY::KeyGenAcc(const std::shared_ptr<RingGSW
     // allocates (n - w) more memory for pointer (not critical for performance)
     RingGSWACCKey ek = std::make_shared<RingGSWACCKeyImpl>(1, 2, n);
 
-#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(n))
-    for (size_t i = 0; i < n; ++i) {
-        auto s{sv[i].ConvertToInt<int32_t>()};
-        (*ek)[0][0][i] = KeyGenLMKCDEY(params, skNTT, s > modHalf ? s - mod : s);
+    // the n keys of X^{s_i}, the key of -5 and the automorphism keys for 5^i (1 <= i <= numAutoKeys,
+    // see RingGSWCryptoParams::ChooseNumAutoKeys) are generated as one list of tasks, every task
+    // drawing its samples from its own stream
+    const auto& genPow = params->GetGenPowers();
+    uint32_t numTasks  = n + 1 + numAutoKeys;
+    auto seed          = PRNGStream::Current();
+#pragma omp parallel for schedule(dynamic) num_threads(OpenFHEParallelControls.GetThreadLimit(numTasks))
+    for (uint32_t t = 0; t < numTasks; ++t) {
+        PRNGStream stream(seed, t);
+        if (t < n) {
+            auto s{sv[t].ConvertToInt<int32_t>()};
+            (*ek)[0][0][t] = KeyGenLMKCDEY(params, skNTT, s > modHalf ? s - mod : s);
+        }
+        else {
+            uint32_t i     = t - n;
+            (*ek)[0][1][i] = KeyGenAuto(params, skNTT, i == 0 ? 2 * N - 5 : genPow[i]);
+        }
     }
-
-    NativeInteger gen = NativeInteger(5);
-
-    (*ek)[0][1][0] = KeyGenAuto(params, skNTT, 2 * N - gen.ConvertToInt());
-
-    // m_window: window size, consider parameterization in the future
-#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(numAutoKeys))
-    for (uint32_t i = 1; i <= numAutoKeys; ++i)
-        (*ek)[0][1][i] = KeyGenAuto(params, skNTT, gen.ModExp(i, 2 * N).ConvertToInt<LWEPlaintext>());
     return ek;
 }
 
 void RingGSWAccumulatorLMKCDEY::EvalAcc(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCKey& ek,
                                         RLWECiphertext& acc, const NativeVector& a) const {
     // assume a is all-odd ciphertext (using round-to-odd technique)
-    size_t n             = a.GetLength();
-    uint32_t Nh          = params->GetN() / 2;
-    uint32_t M           = 2 * params->GetN();
-    uint32_t numAutoKeys = params->GetNumAutoKeys();
+    uint32_t n  = a.GetLength();
+    uint32_t N  = params->GetN();
+    uint32_t Nh = N / 2;
+    uint32_t M  = 2 * N;
 
     NativeInteger MNative(M);
 
-    auto logGen = params->GetLogGen();
-    std::unordered_map<int32_t, std::vector<int32_t>> permuteMap;
-
-    for (size_t i = 0; i < n; i++) {  // put ail a_i in the permuteMap
+    // counting sort of the indices by the discrete log of -a_i: bucket i < Nh holds 5^i,
+    // bucket Nh holds -1 and bucket Nh + i holds -5^i
+    const auto& logGen = params->GetLogGen();
+    std::vector<uint32_t> bucket(n);
+    std::vector<uint32_t> offsets(N + 1, 0);
+    for (uint32_t i = 0; i < n; i++) {
         // make it odd; round-to-odd(https://eprint.iacr.org/2022/198) will improve error.
         int32_t aIOdd = NativeInteger(0).ModSubFast(a[i], MNative).ConvertToInt<uint32_t>() | 0x1;
         int32_t index = logGen[aIOdd];
-
-        if (permuteMap.find(index) == permuteMap.end()) {
-            std::vector<int32_t> indexVec;
-            permuteMap[index] = indexVec;
-        }
-        auto& indexVec = permuteMap[index];
-        indexVec.push_back(i);
+        bucket[i]     = index == static_cast<int32_t>(M) ? Nh : (index >= 0 ? index : Nh - index);
+        ++offsets[bucket[i] + 1];
     }
-
-    NativeInteger gen(5);
-    uint32_t genInt       = 5;
-    uint32_t nSkips       = 0;
-    acc->GetElements()[1] = (acc->GetElements()[1]).AutomorphismTransform(M - genInt);
+    for (uint32_t b = 0; b < N; b++)
+        offsets[b + 1] += offsets[b];
+    std::vector<uint32_t> order(n);
+    std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+    for (uint32_t i = 0; i < n; i++)
+        order[next[bucket[i]]++] = i;
+
+    BlindRotationWorkspace ws;
+    // an acc (0, b) stays trivial until the first product, so its automorphisms need no key
+    // switching; any other acc is key switched from the start
+    const auto& a0 = acc->GetElements()[0].GetValues();
+    bool isTrivial{true};
+    for (uint32_t i = 0; i < a0.GetLength() && isTrivial; ++i)
+        isTrivial = a0[i] == 0;
+    uint32_t genInt = 5;
+    Automorphism(params, M - genInt, (*ek)[0][1][0], acc, ws, isTrivial);
 
     // for a_j = -5^i
-    for (uint32_t i = Nh - 1; i > 0; i--) {
-        if (permuteMap.find(-i) != permuteMap.end()) {
-            if (nSkips != 0) {  // Rotation by 5^nSkips
-                Automorphism(params, gen.ModExp(nSkips, M), (*ek)[0][1][nSkips], acc);
-                nSkips = 0;
-            }
-            auto& indexVec = permuteMap[-i];
-            for (size_t j = 0; j < indexVec.size(); j++) {
-                AddToAccLMKCDEY(params, (*ek)[0][0][indexVec[j]], acc);
-            }
-        }
-        nSkips++;
-
-        if (nSkips == numAutoKeys || i == 1) {
-            Automorphism(params, gen.ModExp(nSkips, M), (*ek)[0][1][nSkips], acc);
-            nSkips = 0;
-        }
-    }
+    EvalSweep(params, ek, order, offsets.data() + Nh, acc, ws, isTrivial);
 
     // for -1
-    if (permuteMap.find(M) != permuteMap.end()) {
-        auto& indexVec = permuteMap[M];
-        for (size_t j = 0; j < indexVec.size(); j++) {
-            AddToAccLMKCDEY(params, (*ek)[0][0][indexVec[j]], acc);
-        }
+    for (uint32_t j = offsets[Nh]; j < offsets[Nh + 1]; j++) {
+        AddToAccLMKCDEY(params, (*ek)[0][0][order[j]], acc, ws);
+        isTrivial = false;
     }
 
-    Automorphism(params, NativeInteger(M - genInt), (*ek)[0][1][0], acc);
+    Automorphism(params, M - genInt, (*ek)[0][1][0], acc, ws, isTrivial);
     // for a_j = 5^i
-    for (size_t i = Nh - 1; i > 0; i--) {
-        if (permuteMap.find(i) != permuteMap.end()) {
+    EvalSweep(params, ek, order, offsets.data(), acc, ws, isTrivial);
+
+    // for 0
+    for (uint32_t j = offsets[0]; j < offsets[1]; j++)
+        AddToAccLMKCDEY(params, (*ek)[0][0][order[j]], acc, ws);
+}
+
+void RingGSWAccumulatorLMKCDEY::EvalSweep(const std::shared_ptr<RingGSWCryptoParams>& params, ConstRingGSWACCKey& ek,
+                                          const std::vector<uint32_t>& order, const uint32_t* offsets,
+                                          RLWECiphertext& acc, BlindRotationWorkspace& ws, bool& isTrivial) const {
+    uint32_t Nh          = params->GetN() / 2;
+    uint32_t numAutoKeys = params->GetNumAutoKeys();
+    const auto& genPow   = params->GetGenPowers();
+    uint32_t nSkips      = 0;
+    for (uint32_t i = Nh - 1; i > 0; i--) {
+        if (offsets[i] != offsets[i + 1]) {
             if (nSkips != 0) {  // Rotation by 5^nSkips
-                Automorphism(params, gen.ModExp(nSkips, M), (*ek)[0][1][nSkips], acc);
+                Automorphism(params, genPow[nSkips], (*ek)[0][1][nSkips], acc, ws, isTrivial);
                 nSkips = 0;
             }
-
-            auto& indexVec = permuteMap[i];
-            for (size_t j = 0; j < indexVec.size(); j++) {
-                AddToAccLMKCDEY(params, (*ek)[0][0][indexVec[j]], acc);
-            }
+            for (uint32_t j = offsets[i]; j < offsets[i + 1]; j++)
+                AddToAccLMKCDEY(params, (*ek)[0][0][order[j]], acc, ws);
+            isTrivial = false;
         }
         nSkips++;
 
         if (nSkips == numAutoKeys || i == 1) {
-            Automorphism(params, gen.ModExp(nSkips, M), (*ek)[0][1][nSkips], acc);
+            Automorphism(params, genPow[nSkips], (*ek)[0][1][nSkips], acc, ws, isTrivial);
             nSkips = 0;
         }
     }
+}
 
-    // for 0
-    if (permuteMap.find(0) != permuteMap.end()) {
-        auto& indexVec = permuteMap[0];
-        for (size_t j = 0; j < indexVec.size(); j++) {
-            AddToAccLMKCDEY(params, (*ek)[0][0][indexVec[j]], acc);
-        }
+// For an even a_i the round-to-odd in EvalAcc uses 1 - a_i, so the rotation is off by sum_i s_i
+RingGSWEvalKey RingGSWAccumulatorLMKCDEY::KeyGenRoundToOdd(const std::shared_ptr<RingGSWCryptoParams>& params,
+                                                           const NativePoly& skNTT, ConstLWEPrivateKey& LWEsk) const {
+    auto sv{LWEsk->GetElement()};
+    auto mod{sv.GetModulus().ConvertToInt<int64_t>()};
+    auto modHalf{mod >> 1};
+    int64_t sum{0};
+    for (size_t i = 0; i < sv.GetLength(); ++i) {
+        auto s{sv[i].ConvertToInt<int64_t>()};
+        sum += s > modHalf ? s - mod : s;
     }
+    return KeyGenLMKCDEY(params, skNTT, -sum);
+}
+
+void RingGSWAccumulatorLMKCDEY::EvalRoundToOdd(const std::shared_ptr<RingGSWCryptoParams>& params,
+                                               ConstRingGSWEvalKey& ek, RLWECiphertext& acc) const {
+    BlindRotationWorkspace ws;
+    AddToAccLMKCDEY(params, ek, acc, ws);
 }
 
 // Encryption as described in Section 5 of https://eprint.iacr.org/2022/198
@@ -165,7 +183,6 @@ RingGSWEvalKey RingGSWAccumulatorLMKCDEY::KeyGenLMKCDEY(const std::shared_ptr<Ri
     auto polyParams = params->GetPolyParams();
     auto Gpow       = params->GetGPower();
 
-    DiscreteUniformGeneratorImpl<NativeVector> dug;
     NativeInteger Q{params->GetQ()};
 
     // Reduce mod q (dealing with negative number as well)
@@ -180,23 +197,33 @@ RingGSWEvalKey RingGSWAccumulatorLMKCDEY::KeyGenLMKCDEY(const std::shared_ptr<Ri
 
     // approximate gadget decomposition is used; the first digit is ignored
     uint32_t digitsG2{(params->GetDigitsG() - 1) << 1};
-    std::vector<NativePoly> tempA(digitsG2, NativePoly(dug, polyParams, Format::COEFFICIENT));
     RingGSWEvalKeyImpl result(digitsG2, 2);
+    std::vector<PolySeed> seeds(digitsG2);
 
+    // the uniform part of every row is generated from a seed, so the message X^m*G of the even
+    // rows is moved to the second column: (a + X^m*G, as + e) is the same as (a, as + e - X^m*G*s)
+    NativePoly mono(polyParams, Format::COEFFICIENT, true);
     for (uint32_t i = 0; i < digitsG2; ++i) {
-        result[i][0] = tempA[i];
-        tempA[i].SetFormat(Format::EVALUATION);
+        seeds[i]     = SeededUniformGenerator::GenerateSeed();
+        result[i][0] = SeededUniformGenerator::Expand(polyParams, seeds[i]);
         result[i][1] = NativePoly(params->GetDgg(), polyParams, Format::COEFFICIENT);
-        if (!isReducedMM)
-            result[i][i & 0x1][mm].ModAddFastEq(Gpow[(i >> 1) + 1],
-                                                Q);  // (i even) Add G Multiple, (i odd) [a,as+e] + X^m*G
-        else
-            result[i][i & 0x1][mm].ModSubFastEq(Gpow[(i >> 1) + 1],
-                                                Q);  // (i even) Sub G Multiple, (i odd) [a,as+e] - X^m*G
-        result[i][0].SetFormat(Format::EVALUATION);
+        if (i & 0x1) {
+            if (!isReducedMM)
+                result[i][1][mm].ModAddFastEq(Gpow[(i >> 1) + 1], Q);  // [a,as+e] + X^m*G
+            else
+                result[i][1][mm].ModSubFastEq(Gpow[(i >> 1) + 1], Q);  // [a,as+e] - X^m*G
+        }
         result[i][1].SetFormat(Format::EVALUATION);
-        result[i][1] += (tempA[i] *= skNTT);
+        result[i][1] += result[i][0] * skNTT;
+        if (!(i & 0x1)) {
+            mono.SetValuesToZero();
+            mono.OverrideFormat(Format::COEFFICIENT);
+            mono[mm] = isReducedMM ? Q - Gpow[(i >> 1) + 1] : Gpow[(i >> 1) + 1];
+            mono.SetFormat(Format::EVALUATION);
+            result[i][1] -= (mono *= skNTT);
+        }
     }
+    result.SetSeeds(std::move(seeds));
     return std::make_shared<RingGSWEvalKeyImpl>(result);
 }
 
@@ -206,84 +233,91 @@ RingGSWEvalKey RingGSWAccumulatorLMKCDEY::KeyGenAuto(const std::shared_ptr<RingG
     auto polyParams{params->GetPolyParams()};
     auto Gpow{params->GetGPower()};
 
-    DiscreteUniformGeneratorImpl<NativeVector> dug;
-    NativeInteger Q{params->GetQ()};
-
     auto skAuto{skNTT.AutomorphismTransform(k)};
 
     // approximate gadget decomposition is used; the first digit is ignored
     uint32_t digitsG{params->GetDigitsG() - 1};
     RingGSWEvalKeyImpl result(digitsG, 2);
+    std::vector<PolySeed> seeds(digitsG);
 
     for (uint32_t i = 0; i < digitsG; ++i) {
-        result[i][0] = NativePoly(dug, polyParams, EVALUATION);
+        seeds[i]     = SeededUniformGenerator::GenerateSeed();
+        result[i][0] = SeededUniformGenerator::Expand(polyParams, seeds[i]);
         result[i][1] = NativePoly(params->GetDgg(), polyParams, EVALUATION) - skAuto * Gpow[i + 1];
         result[i][1] += result[i][0] * skNTT;
     }
+    result.SetSeeds(std::move(seeds));
     return std::make_shared<RingGSWEvalKeyImpl>(result);
 }
 
 // LMKCDEY Accumulation as described in https://eprint.iacr.org/2022/198
 // Same as AP, but multiplied once
 void RingGSWAccumulatorLMKCDEY::AddToAccLMKCDEY(const std::shared_ptr<RingGSWCryptoParams>& params,
-                                                ConstRingGSWEvalKey& ek, RLWECiphertext& acc) const {
-    std::vector<NativePoly> ct(acc->GetElements());
-    ct[0].SetFormat(Format::COEFFICIENT);
-    ct[1].SetFormat(Format::COEFFICIENT);
-
+                                                ConstRingGSWEvalKey& ek, RLWECiphertext& acc,
+                                                BlindRotationWorkspace& ws) const {
+    CirBTSTraceScope span("AddToAccLMKCDEY");
     // approximate gadget decomposition is used; the first digit is ignored
     uint32_t digitsG2{(params->GetDigitsG() - 1) << 1};
+    ws.Reserve(params->GetPolyParams(), digitsG2);
 
-    std::vector<NativePoly> dct(digitsG2, NativePoly(params->GetPolyParams(), Format::COEFFICIENT, true));
-
-    SignedDigitDecompose(params, ct, dct);
+    auto& ct = ws.GetCt();
+    ct[0]    = acc->GetElements()[0];
+    ct[1]    = acc->GetElements()[1];
+    ct[0].SetFormat(Format::COEFFICIENT);
+    ct[1].SetFormat(Format::COEFFICIENT);
 
-    // calls digitsG2 NTTs
-#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(digitsG2))
-    for (uint32_t d = 0; d < digitsG2; ++d)
-        dct[d].SetFormat(Format::EVALUATION);
+    // every digit is overwritten by the decomposition
+    auto& dct = ws.GetDigits();
+    SignedDigitDecompose(params, ct, dct, Format::EVALUATION);
 
     // acc = dct * ek (matrix product);
-    const std::vector<std::vector<NativePoly>>& ev = ek->GetElements();
-    acc->GetElements()[0]                          = (dct[0] * ev[0][0]);
+    const auto& ev{*ek};
+    auto& acc0 = acc->GetElements()[0];
+    acc0       = dct[0];
+    MultiplyKeyElement(acc0, ev.GetElementData(0, 0));
     for (uint32_t d = 1; d < digitsG2; ++d)
-        acc->GetElements()[0] += (dct[d] * ev[d][0]);
-    acc->GetElements()[1] = (dct[0] *= ev[0][1]);
+        MultiplyAddKeyElement(dct[d], ev.GetElementData(d, 0), acc0);
+    auto& acc1 = acc->GetElements()[1];
+    acc1       = dct[0];
+    MultiplyKeyElement(acc1, ev.GetElementData(0, 1));
     for (uint32_t d = 1; d < digitsG2; ++d)
-        acc->GetElements()[1] += (dct[d] *= ev[d][1]);
+        MultiplyAddKeyElement(dct[d], ev.GetElementData(d, 1), acc1);
 }
 
 // Automorphism
-void RingGSWAccumulatorLMKCDEY::Automorphism(const std::shared_ptr<RingGSWCryptoParams>& params, const NativeInteger& a,
-                                             ConstRingGSWEvalKey& ak, RLWECiphertext& acc) const {
-    // precompute bit reversal for the automorphism into vec
-    uint32_t N{params->GetN()};
-    std::vector<usint> vec(N);
-    PrecomputeAutoMap(N, a.ConvertToInt<usint>(), &vec);
-
-    acc->GetElements()[1] = acc->GetElements()[1].AutomorphismTransform(a.ConvertToInt<usint>(), vec);
-
-    NativePoly cta(acc->GetElements()[0]);
-    acc->GetElements()[0].SetValuesToZero();
-    cta = cta.AutomorphismTransform(a.ConvertToInt<usint>(), vec);
-    cta.SetFormat(COEFFICIENT);
+void RingGSWAccumulatorLMKCDEY::Automorphism(const std::shared_ptr<RingGSWCryptoParams>& params, uint32_t a,
+                                             ConstRingGSWEvalKey& ak, RLWECiphertext& acc, BlindRotationWorkspace& ws,
+                                             bool isTrivial) const {
+    CirBTSTraceScope span("LMKCDEY.Automorphism");
+    // the evaluation-domain permutation is precomputed in params
+    const auto& plan = params->GetAutoPlan(a);
+    plan.Apply(acc->GetElements()[1]);
+    if (isTrivial)
+        return;
 
     // approximate gadget decomposition is used; the first digit is ignored
     uint32_t digitsG{params->GetDigitsG() - 1};
-    std::vector<NativePoly> dcta(digitsG, NativePoly(params->GetPolyParams(), Format::COEFFICIENT, true));
+    ws.Reserve(params->GetPolyParams(), digitsG << 1);
 
-    SignedDigitDecompose(params, cta, dcta);
+    // acc becomes (0, b) once the products are accumulated into it below
+    auto& cta = ws.GetCt()[0];
+    std::swap(cta, acc->GetElements()[0]);
+    plan.Apply(cta);
+    cta.SetFormat(COEFFICIENT);
 
-#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(digitsG))
-    for (uint32_t d = 0; d < digitsG; ++d)
-        dcta[d].SetFormat(Format::EVALUATION);
+    // only the first digitsG digits are used
+    auto& dcta = ws.GetDigits();
+    SignedDigitDecompose(params, cta, dcta, Format::EVALUATION);
 
     // acc = dct * input (matrix product);
-    const std::vector<std::vector<NativePoly>>& ev = ak->GetElements();
-    for (uint32_t d = 0; d < digitsG; ++d)
-        acc->GetElements()[0] += (dcta[d] * ev[d][0]);
+    const auto& ev{*ak};
+    auto& acc0 = acc->GetElements()[0];
+    acc0       = dcta[0];
+    MultiplyKeyElement(acc0, ev.GetElementData(0, 0));
+    for (uint32_t d = 1; d < digitsG; ++d)
+        MultiplyAddKeyElement(dcta[d], ev.GetElementData(d, 0), acc0);
     for (uint32_t d = 0; d < digitsG; ++d)
-        acc->GetElements()[1] += (dcta[d] *= ev[d][1]);
+        MultiplyAddKeyElement(dcta[d], ev.GetElementData(d, 1), acc->GetElements()[1]);
 }
 
 };  // namespace lbcrypto
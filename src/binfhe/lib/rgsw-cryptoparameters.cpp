@@ -31,6 +31,9 @@
 
 #include "rgsw-cryptoparameters.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace lbcrypto {
 
 void RingGSWCryptoParams::PreCompute(bool signEval) {
@@ -73,8 +76,17 @@ void RingGSWCryptoParams::PreCompute(bool signEval) {
         }
     }
 
+    // The approximate decomposition keeps the digitsGA most significant digits of the
+    // bit length of Q, so the gadget is 2^ignoreBits * baseG^i for any modulus size
+    uint32_t logQ{m_Q.GetMSB()};
+    uint32_t gBits{static_cast<uint32_t>(__builtin_ctz(m_baseG))};
+    if (m_digitsGA * gBits > logQ)
+        OPENFHE_THROW("digitsGA * log2(baseG) exceeds the bit length of Q");
+    m_ignoreBitsGA = logQ - m_digitsGA * gBits;
+
+    m_AGpower.clear();
     m_AGpower.reserve(m_digitsGA);
-    NativeInteger vTemp = NativeInteger(static_cast<BasicInteger>(std::ceil(m_Q.ConvertToDouble() / m_Gpower[m_digitsGA].ConvertToDouble())));
+    NativeInteger vTemp = NativeInteger(1) << m_ignoreBitsGA;
     for (uint32_t i = 0; i < m_digitsGA; ++i) {
         m_AGpower.push_back(vTemp);
         vTemp = vTemp.ModMulFast(NativeInteger(m_baseG), m_Q);
@@ -97,40 +109,169 @@ void RingGSWCryptoParams::PreCompute(bool signEval) {
         NativeInteger(2) * (m_q >> 3)    // XNOR_FAST
     };
 
-    // Computes polynomials X^m - 1 that are needed in the accumulator for the
-    // CGGI bootstrapping
+    // Precomputes the powers of the root of unity from which the polynomials
+    // X^m - 1 needed in the accumulator for the CGGI bootstrapping are generated
     if (m_method == BINFHE_METHOD::GINX) {
-        constexpr NativeInteger one{1};
-        m_monomials.reserve(2 * m_N);
-        for (uint32_t i = 0; i < m_N; ++i) {
-            NativePoly aPoly(m_polyParams, Format::COEFFICIENT, true);
-            aPoly[0].ModSubFastEq(one, m_Q);  // -1
-            aPoly[i].ModAddFastEq(one, m_Q);  // X^m
-            aPoly.SetFormat(Format::EVALUATION);
-            m_monomials.push_back(std::move(aPoly));
+        m_monomials = EvalMonomials(m_polyParams);
+
+        // A product of a digit (|d| <= baseG/2) and a key limb (|l| <= 2^(limbBits-1)) summed over
+        // the 2*digitsGA rows and N coefficients has a magnitude near
+        // 2^(gBits - 1 + limbBits - 1) * sqrt(2*digitsGA*N), and at N = 2048 the FFT rounding error
+        // of a coefficient was measured with a standard deviation of 2^-52.6 times that magnitude
+        // (2^-52.5 is used). A wrong rounding of limb l adds +-2^(l * limbBits) to the accumulator,
+        // so the limbs are sized for a failure rate per blind rotation: the largest limbs whose
+        // rounding fails with probability below 2^FFT_LOG2_FAILURE_RATE over all the rounded
+        // coefficients of a blind rotation, bounded with n <= N steps and the largest key
+        // unrolling, i.e., 2 * (7/3) * N * numLimbs * N coefficients. The limbs are then balanced,
+        // which keeps their number and only lowers the failure rate.
+        // No limb split exists when the digits alone exceed the target (numLimbs = 0)
+        constexpr double FFT_LOG2_FAILURE_RATE{-40};
+        constexpr double FFT_LOG2_ERROR_SCALE{-52.5};
+        constexpr uint32_t FFT_MAX_LIMB_BITS{50};
+        double log2Growth{0.5 * std::log2(2.0 * std::max(m_digitsGA, 1u) * m_N)};
+        auto log2FailureRate = [&](uint32_t limbBits) {
+            uint32_t numLimbs{(logQ + limbBits - 1) / limbBits};
+            double sigma{std::exp2(gBits - 1 + limbBits - 1 + log2Growth + FFT_LOG2_ERROR_SCALE)};
+            double numCoefficients{2.0 * 7.0 / 3.0 * m_N * numLimbs * m_N};
+            // log2 erfc(x), with its asymptotic expansion once erfc underflows
+            double x{0.5 / (sigma * std::sqrt(2.0))};
+            double rate{std::erfc(x)};
+            double log2Rate{rate > 0 ? std::log2(rate) : -x * x / std::log(2.0) - std::log2(x * std::sqrt(M_PI))};
+            return log2Rate + std::log2(numCoefficients);
+        };
+        m_fftLimbBits        = 0;
+        m_fftNumLimbs        = 0;
+        m_fftLog2FailureRate = 0;
+        if (m_digitsGA > 0) {
+            for (uint32_t limbBits = std::min(logQ, FFT_MAX_LIMB_BITS); limbBits > 0; --limbBits) {
+                if (log2FailureRate(limbBits) <= FFT_LOG2_FAILURE_RATE) {
+                    m_fftNumLimbs        = (logQ + limbBits - 1) / limbBits;
+                    m_fftLimbBits        = (logQ + m_fftNumLimbs - 1) / m_fftNumLimbs;
+                    m_fftLog2FailureRate = log2FailureRate(m_fftLimbBits);
+                    break;
+                }
+            }
         }
-        for (uint32_t i = 0; i < m_N; ++i) {
-            NativePoly aPoly(m_polyParams, Format::COEFFICIENT, true);
-            aPoly[0].ModSubFastEq(one, m_Q);  // -1
-            aPoly[i].ModSubFastEq(one, m_Q);  // -X^m
-            aPoly.SetFormat(Format::EVALUATION);
-            m_monomials.push_back(std::move(aPoly));
+        m_fftLimbPowers.resize(m_fftNumLimbs);
+        m_fftLimbPowersPrecon.resize(m_fftNumLimbs);
+        for (uint32_t l = 0; l < m_fftNumLimbs; ++l) {
+            m_fftLimbPowers[l]       = NativeInteger(1) << (l * m_fftLimbBits);
+            m_fftLimbPowersPrecon[l] = m_fftLimbPowers[l].PrepModMulConst(m_Q);
         }
+        m_fft = NegacyclicFFT(m_N);
     }
 
     if (m_method == LMKCDEY) {
         constexpr uint32_t gen{5};
-        m_logGen.clear();
         uint32_t M{2 * m_N};
+        uint32_t Nh{m_N / 2};
+        if (m_numAutoKeys >= Nh)
+            OPENFHE_THROW("numAutoKeys should be smaller than N/2.");
+        m_genPowers.resize(Nh);
+        m_genPowers[0] = 1;
+        for (uint32_t i = 1; i < Nh; ++i)
+            m_genPowers[i] = (m_genPowers[i - 1] * gen) % M;
+
+        m_logGen.clear();
         m_logGen.resize(M);
-        uint32_t gPow{1};
-        m_logGen[M - gPow] = M;  // for -1
-        for (uint32_t i = 1; i < m_N / 2; ++i) {
-            gPow               = (gPow * gen) % M;
-            m_logGen[gPow]     = i;
-            m_logGen[M - gPow] = -i;
+        m_logGen[M - 1] = M;  // for -1
+        for (uint32_t i = 1; i < Nh; ++i) {
+            m_logGen[m_genPowers[i]]     = i;
+            m_logGen[M - m_genPowers[i]] = -i;
+        }
+
+        // automorphism plans for 5^i (1 <= i <= numAutoKeys) and -5
+        m_autoPlans.clear();
+        m_autoPlans.emplace(M - gen, AutomorphismPlan(m_N, M - gen));
+        for (uint32_t i = 1; i <= m_numAutoKeys; ++i)
+            m_autoPlans.emplace(m_genPowers[i], AutomorphismPlan(m_N, m_genPowers[i]));
+    }
+}
+
+// Expected number of key switching automorphisms of the LMKCDEY schedule in
+// RingGSWAccumulatorLMKCDEY::EvalAcc for a window of w keys. The discrete log i of 5^i is
+// occupied with probability occ[i] (odd -a_i = +-5^i), independently of the other logs; the
+// state of the schedule is the number of pending skips and whether the accumulator is still
+// trivial (0, b), in which case the automorphisms need no key switching
+static double ExpectedAutomorphisms(uint32_t Nh, const std::vector<double>& occNeg, const std::vector<double>& occPos,
+                                    uint32_t w) {
+    // prob[t][k]: probability of k pending skips with trivial (t = 1) or nontrivial (t = 0) acc
+    std::vector<double> prob[2] = {std::vector<double>(w + 1, 0.0), std::vector<double>(w + 1, 0.0)};
+    std::vector<double> next[2] = {std::vector<double>(w + 1, 0.0), std::vector<double>(w + 1, 0.0)};
+    prob[1][0] = 1.0;
+    double count{0.0};
+    for (const auto* occ : {&occNeg, &occPos}) {
+        for (uint32_t i = Nh - 1; i > 0; --i) {
+            double p{(*occ)[i]};
+            std::fill(next[0].begin(), next[0].end(), 0.0);
+            std::fill(next[1].begin(), next[1].end(), 0.0);
+            for (uint32_t t = 0; t < 2; ++t) {
+                for (uint32_t k = 0; k < w; ++k) {
+                    double pr{prob[t][k]};
+                    if (pr == 0.0)
+                        continue;
+                    // occupied: the pending automorphism is applied, then the products
+                    if (k != 0 && t == 0)
+                        count += pr * p;
+                    next[0][1] += pr * p;
+                    next[t][k + 1] += pr * (1.0 - p);
+                }
+            }
+            // the window is full or the sweep ends
+            for (uint32_t t = 0; t < 2; ++t) {
+                for (uint32_t k = 1; k <= w; ++k) {
+                    if (k == w || i == 1) {
+                        if (t == 0)
+                            count += next[t][k];
+                        next[t][0] += next[t][k];
+                        next[t][k] = 0.0;
+                    }
+                }
+            }
+            std::swap(prob, next);
+        }
+        // the automorphism by -5 between both sweeps
+        if (occ == &occNeg) {
+            double pNeg1{occNeg[0]};
+            count += prob[0][0] + prob[1][0] * pNeg1;
+            prob[0][0] += prob[1][0] * pNeg1;
+            prob[1][0] *= 1.0 - pNeg1;
+        }
+    }
+    return count;
+}
+
+uint32_t RingGSWCryptoParams::ChooseNumAutoKeys(uint32_t N, uint32_t n, uint32_t logStep, double keyCost,
+                                                uint32_t maxKeys) {
+    uint32_t Nh{N / 2};
+    maxKeys = std::min(maxKeys, Nh - 1);
+    // occupation of the discrete logs, index 0 of occNeg stands for -1
+    std::vector<double> occNeg(Nh, 0.0);
+    std::vector<double> occPos(Nh, 0.0);
+    if (logStep <= 1) {
+        // every odd value is equally likely
+        double p{1.0 - std::pow(1.0 - 1.0 / N, n)};
+        std::fill(occNeg.begin(), occNeg.end(), p);
+        std::fill(occPos.begin(), occPos.end(), p);
+    }
+    else {
+        // 1 + 2^logStep * k = 5^i with i a multiple of 2^(logStep - 2)
+        uint32_t period{std::min(1u << (logStep - 2), Nh)};
+        double p{1.0 - std::pow(1.0 - static_cast<double>(period) / Nh, n)};
+        for (uint32_t i = 0; i < Nh; i += period)
+            occPos[i] = p;
+    }
+
+    uint32_t best{1};
+    double bestCost{ExpectedAutomorphisms(Nh, occNeg, occPos, 1) + keyCost};
+    for (uint32_t w = 2; w <= maxKeys; ++w) {
+        double cost{ExpectedAutomorphisms(Nh, occNeg, occPos, w) + keyCost * w};
+        if (cost < bestCost) {
+            best     = w;
+            bestCost = cost;
         }
     }
+    return best;
 }
 
 };  // namespace lbcrypto
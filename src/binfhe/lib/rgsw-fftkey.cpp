@@ -0,0 +1,54 @@
+#include "rgsw-fftkey.h"
+
+namespace lbcrypto {
+
+RingGSWACCFFTKeyImpl::RingGSWACCFFTKeyImpl(const std::shared_ptr<RingGSWCryptoParams>& params,
+                                           ConstRingGSWACCKey& ek)
+    : m_numLimbs(params->GetFFTNumLimbs()) {
+    if (m_numLimbs == 0)
+        OPENFHE_THROW(config_error, "the gadget of the refresh key is too large for the FFT backend");
+
+    const auto& ek0 = (*ek)[0];
+    m_numPatterns   = ek0.size();
+    uint32_t n{static_cast<uint32_t>(ek0.size() * ek0[0].size())};
+    uint32_t N{params->GetN()};
+    uint32_t limbBits{params->GetFFTLimbBits()};
+    uint64_t Q{params->GetQ().ConvertToInt<uint64_t>()};
+    uint64_t QHalf{Q >> 1};
+    const auto& fft = params->GetFFT();
+
+    m_key.resize(n);
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(n))
+    for (uint32_t i = 0; i < n; ++i) {
+        const auto& ev{*ek0[i % m_numPatterns][i / m_numPatterns]};
+        uint32_t rows{ev.GetRowSize()};
+        auto& keyi    = m_key[i];
+        keyi.resize(2 * rows * m_numLimbs);
+
+        std::vector<std::vector<double>> limbs(m_numLimbs, std::vector<double>(N));
+        for (uint32_t r = 0; r < rows; ++r) {
+            for (uint32_t c = 0; c < 2; ++c) {
+                NativePoly poly(params->GetPolyParams(), Format::EVALUATION, true);
+                const NativeInteger* data{ev.GetElementData(r, c)};
+                std::copy(data, data + N, &poly[0]);
+                poly.SetFormat(Format::COEFFICIENT);
+                for (uint32_t k = 0; k < N; ++k) {
+                    uint64_t v{poly[k].ConvertToInt<uint64_t>()};
+                    int64_t x{v > QHalf ? -static_cast<int64_t>(Q - v) : static_cast<int64_t>(v)};
+                    // balanced limbs in [-2^(limbBits-1), 2^(limbBits-1)), the last one takes the rest
+                    for (uint32_t l = 0; l + 1 < m_numLimbs; ++l) {
+                        int64_t low{static_cast<int64_t>(static_cast<uint64_t>(x) << (64 - limbBits)) >>
+                                    (64 - limbBits)};
+                        limbs[l][k] = static_cast<double>(low);
+                        x           = (x - low) >> limbBits;
+                    }
+                    limbs[m_numLimbs - 1][k] = static_cast<double>(x);
+                }
+                for (uint32_t l = 0; l < m_numLimbs; ++l)
+                    fft.Forward(limbs[l].data(), keyi[(2 * r + c) * m_numLimbs + l]);
+            }
+        }
+    }
+}
+
+}  // namespace lbcrypto
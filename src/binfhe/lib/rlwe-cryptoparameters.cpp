@@ -2,6 +2,13 @@
 
 namespace lbcrypto{
 void RLWECryptoParams::PreCompute(bool signEval) {
+    auto lnQ{log(m_Q.ConvertToDouble())};
+    m_EXdigitsHT = static_cast<uint32_t>(std::ceil(lnQ / log(static_cast<double>(m_baseHT))));
+    m_EXdigitsSS = static_cast<uint32_t>(std::ceil(lnQ / log(static_cast<double>(m_baseSS))));
+    m_HTpower.clear();
+    m_AHTpower.clear();
+    m_SSpower.clear();
+    m_ASSpower.clear();
 
     //Computes baseHT^i
     if (signEval){
@@ -15,8 +22,20 @@ void RLWECryptoParams::PreCompute(bool signEval) {
         }
     }
 
+    //The approximate decompositions keep the top digits of the bit length of Q,
+    //so their gadgets are 2^ignoreBits * base^i for any modulus size
+    uint32_t logQ{m_Q.GetMSB()};
+    uint32_t gBitsHT{static_cast<uint32_t>(__builtin_ctz(m_baseHT))};
+    uint32_t gBitsSS{static_cast<uint32_t>(__builtin_ctz(m_baseSS))};
+    if (m_digitsHT * gBitsHT > logQ)
+        OPENFHE_THROW(config_error, "digitsHT * log2(baseHT) exceeds the bit length of Q");
+    if (m_digitsSS * gBitsSS > logQ)
+        OPENFHE_THROW(config_error, "digitsSS * log2(baseSS) exceeds the bit length of Q");
+    m_ignoreBitsHT = logQ - m_digitsHT * gBitsHT;
+    m_ignoreBitsSS = logQ - m_digitsSS * gBitsSS;
+
     m_AHTpower.reserve(m_digitsHT);
-    NativeInteger vTemp = NativeInteger(static_cast<BasicInteger>(std::ceil(m_Q.ConvertToDouble() / m_HTpower[m_digitsHT].ConvertToDouble())));
+    NativeInteger vTemp = NativeInteger(1) << m_ignoreBitsHT;
     for(uint32_t i = 0; i < m_digitsHT; ++i){
         m_AHTpower.push_back(vTemp);
         vTemp = vTemp.ModMulFast(NativeInteger(m_baseHT), m_Q);
@@ -35,11 +54,18 @@ void RLWECryptoParams::PreCompute(bool signEval) {
     }
 
     m_ASSpower.reserve(m_digitsSS);
-    vTemp = NativeInteger(static_cast<BasicInteger>(std::ceil(m_Q.ConvertToDouble() / m_SSpower[m_digitsSS].ConvertToDouble())));
-    for(uint32_t i = 0; i < m_digitsHT; ++i){
+    vTemp = NativeInteger(1) << m_ignoreBitsSS;
+    for(uint32_t i = 0; i < m_digitsSS; ++i){
         m_ASSpower.push_back(vTemp);
         vTemp = vTemp.ModMulFast(NativeInteger(m_baseSS), m_Q);
     }
 
+    //Automorphism plans for the homtrace levels
+    m_autoPlans.clear();
+    uint32_t numAuto = static_cast<uint32_t>(log2(m_N));
+    for(uint32_t i = 0; i < numAuto; ++i){
+        uint32_t k = (m_N >> i) + 1;
+        m_autoPlans.emplace(k, AutomorphismPlan(m_N, k));
+    }
 }
 }
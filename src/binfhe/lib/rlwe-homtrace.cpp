@@ -1,4 +1,6 @@
 #include "rlwe-homtrace.h"
+#include "signed-digit-decompose.h"
+#include "cirbts-perf.h"
 
 namespace lbcrypto{
 RLWEHomTraceKey RingLWEHomTrace::KeyGenHT(const std::shared_ptr<RLWECryptoParams>& params,
@@ -10,7 +12,11 @@ RLWEHomTraceKey RingLWEHomTrace::KeyGenHT(const std::shared_ptr<RLWECryptoParams
 
     //Homtarce key is composed with numAuto Auto keys and each Auto key is a RGSW ciphertext
     RLWEHomTraceKey ek = std::make_shared<RLWEHomTraceKeyImpl>(1, 1, numAuto);
+    //every automorphism key draws its samples from its own stream
+    auto seed = PRNGStream::Current();
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(numAuto))
     for (usint i = 0; i < numAuto; i++){
+        PRNGStream stream(seed, i);
         (*ek)[0][0][i] = KeyGenAuto(params, skNTT, (N >> i) + 1);
     }
     return ek;
@@ -23,53 +29,67 @@ void RingLWEHomTrace::EvalHT(const std::shared_ptr<RLWECryptoParams>& params, Co
     //the number of automorphism
     uint32_t numAuto = static_cast<uint32_t>(log2(N));
 
+    CirBTSPerfScope perf(STAGE_HOMTRACE);
     for (uint32_t i = 0; i < numAuto; i++){
-        //copy ct
-        std::vector<NativePoly> ct_identity(ct->GetElements());
-        //automorphism of ct
-        Automorphism(params, (N >> i) + 1, (*ek)[0][0][i], ct);
-        ct->GetElements()[0] += ct_identity[0];
-        ct->GetElements()[1] += ct_identity[1];
+        CirBTSPerfScope perfLevel(STAGE_HOMTRACE_LEVEL);
+        EvalHTLevel(params, ek, i, ct);
+    }
+}
+
+void RingLWEHomTrace::EvalHTLevel(const std::shared_ptr<RLWECryptoParams>& params, ConstRLWEHomTraceKey& ek,
+                                  uint32_t level, RLWECiphertext& ct) const {
+    auto N = params->GetN();
+    //copy ct
+    std::vector<NativePoly> ct_identity(ct->GetElements());
+    //automorphism of ct
+    Automorphism(params, (N >> level) + 1, (*ek)[0][0][level], ct);
+    ct->GetElements()[0] += ct_identity[0];
+    ct->GetElements()[1] += ct_identity[1];
+}
+
+void RingLWEHomTrace::EvalHTBatch(const std::shared_ptr<RLWECryptoParams>& params, ConstRLWEHomTraceKey& ek,
+                                  std::vector<RLWECiphertext>& ct) const {
+    auto N = params->GetN();
+    uint32_t numCt = ct.size();
+    if (numCt == 0)
+        return;
+    //the number of automorphism
+    uint32_t numAuto = static_cast<uint32_t>(log2(N));
+
+    CirBTSPerfScope perf(STAGE_HOMTRACE);
+    //the implicit barrier of the omp for keeps all ciphertexts at the same level
+#pragma omp parallel num_threads(OpenFHEParallelControls.GetThreadLimit(numCt)) if (!omp_in_parallel())
+    for (uint32_t i = 0; i < numAuto; i++){
+        //the first thread times the level, which ends at the barrier
+#ifdef PARALLEL
+        CirBTSPerfScope perfLevel(STAGE_HOMTRACE_LEVEL, omp_get_thread_num() == 0);
+#else
+        CirBTSPerfScope perfLevel(STAGE_HOMTRACE_LEVEL);
+#endif
+        ConstRingGSWEvalKey ak = (*ek)[0][0][i];
+#pragma omp for schedule(static)
+        for (uint32_t j = 0; j < numCt; j++){
+            //copy ct
+            std::vector<NativePoly> ct_identity(ct[j]->GetElements());
+            //automorphism of ct
+            Automorphism(params, (N >> i) + 1, ak, ct[j]);
+            ct[j]->GetElements()[0] += ct_identity[0];
+            ct[j]->GetElements()[1] += ct_identity[1];
+        }
     }
 }
 
 void RingLWEHomTrace::SignedDigitDecompose(const std::shared_ptr<RLWECryptoParams>& params, const NativePoly& input,
-                                           std::vector<NativePoly>& output) const {
-    auto Q = params->GetQ(); 
-    auto Q_int{Q.ConvertToInt<NativeInteger::SignedNativeInt>()};
-    auto QHalf = Q.ConvertToInt<BasicInteger>() >> 1;
-    auto baseHT = params->GetBaseHT();
+                                           std::vector<NativePoly>& output, Format format) const {
     //the bits of each digit
-    auto gBits{static_cast<NativeInteger::SignedNativeInt>(__builtin_ctz(baseHT))};
+    auto gBits{static_cast<uint32_t>(__builtin_ctz(params->GetBaseHT()))};
     //approximate length of homtrace
     uint32_t digitsHT{params->GetDigitsHTA()};
 
     //ignore bits
-    uint32_t ignore_bits = 54 - gBits * digitsHT;
-    //the number of bits of approximate decomposition remain
-    auto gBitsMaxBits{static_cast<NativeInteger::SignedNativeInt>(NativeInteger::MaxBits() - ignore_bits)};
-    uint32_t N{params->GetN()};
-    
-    auto gBitsMaxBits0{static_cast<NativeInteger::SignedNativeInt>(NativeInteger::MaxBits() - gBits)};
-
-    for (uint32_t k{0}; k < N; ++k){
-        auto t0{input[k].ConvertToInt<BasicInteger>()};
-        auto d0{static_cast<NativeInteger::SignedNativeInt>(t0 < QHalf ? t0 : t0 - Q_int)};
-        
-        //the bits should ignore
-        auto r0 = d0;
-    
-        r0 = (d0 << gBitsMaxBits) >> gBitsMaxBits;
-        d0 = (d0 - r0) >> ignore_bits;
-        
-        for (uint32_t d{0}; d < digitsHT; ++d){
-            r0 = (d0 << gBitsMaxBits0) >> gBitsMaxBits0;
-            d0 = (d0 - r0) >> gBits;
-            if (r0 < 0)
-                r0 += Q_int;
-            output[d + 0][k] += r0;
-        }
-    }
+    uint32_t ignore_bits = params->GetIgnoreBitsHT();
+
+    DecomposeSignedDigits(input, params->GetQ(), gBits, ignore_bits, digitsHT, output, 0, 1, format);
 }
 
 RingGSWEvalKey RingLWEHomTrace::KeyGenAuto(const std::shared_ptr<RLWECryptoParams>& params, const NativePoly& skNTT,
@@ -89,13 +109,16 @@ RingGSWEvalKey RingLWEHomTrace::KeyGenAuto(const std::shared_ptr<RLWECryptoParam
 
     auto polyparams = params->GetPolyParams();
 
-    DiscreteUniformGeneratorImpl<NativeVector> dug;
+    //the uniform polynomials are stored as seeds
+    std::vector<PolySeed> seeds(digitsHT);
 
     for (uint32_t i = 0; i < digitsHT; ++i){
-        result[i][0] = NativePoly(dug, polyparams, EVALUATION);
+        seeds[i] = SeededUniformGenerator::GenerateSeed();
+        result[i][0] = SeededUniformGenerator::Expand(polyparams, seeds[i]);
         result[i][1] = NativePoly(params->GetHTDgg(), polyparams, EVALUATION) - skAuto * HTpow[i];
         result[i][1] += (result[i][0] * skNTT);
     }
+    result.SetSeeds(std::move(seeds));
 
     return std::make_shared<RingGSWEvalKeyImpl>(result);
 }
@@ -103,34 +126,30 @@ RingGSWEvalKey RingLWEHomTrace::KeyGenAuto(const std::shared_ptr<RLWECryptoParam
 
 void RingLWEHomTrace::Automorphism(const std::shared_ptr<RLWECryptoParams>& params, const uint32_t& a,
                                    ConstRingGSWEvalKey& ak, RLWECiphertext& ct) const {
-    uint32_t N{params->GetN()};
-    std::vector<usint> vec(N);
-    PrecomputeAutoMap(N, a, &vec);
-    ct->GetElements()[1] = ct->GetElements()[1].AutomorphismTransform(a, vec); //auto of b
+    CirBTSTraceScope span("HomTrace.Automorphism");
+    const auto& plan = params->GetAutoPlan(a);
+    plan.Apply(ct->GetElements()[1]); //auto of b
 
-    NativePoly cta(ct->GetElements()[0]);
-    cta = cta.AutomorphismTransform(a, vec);//cta is evaluation format
+    //ct becomes (0,b) once the products are accumulated into it below
+    NativePoly cta(std::move(ct->GetElements()[0]));
+    plan.Apply(cta);//cta is evaluation format
     cta.SetFormat(COEFFICIENT);
 
-    ct->GetElements()[0].SetValuesToZero();//now ct is (0,b)
-
     auto polyparams = params->GetPolyParams();
     uint32_t digitsHT{(params->GetDigitsHTA())};
     std::vector<NativePoly> dcta(digitsHT, NativePoly(polyparams, Format::COEFFICIENT, true));
-    SignedDigitDecompose(params, cta, dcta);
-#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(digitsHT))
-    for(uint32_t d = 0; d < digitsHT; ++d){
-        dcta[d].SetFormat(Format::EVALUATION);
-    }
+    SignedDigitDecompose(params, cta, dcta, Format::EVALUATION);
 
     //ct = (0,b) + dct * ak (matric product)
-    const std::vector<std::vector<NativePoly>>& ev = ak->GetElements();
-    for (uint32_t d = 0; d < digitsHT; ++d){
-        ct->GetElements()[0] += (dcta[d] * ev[d][0]);
+    const auto& ev{*ak};
+    ct->GetElements()[0] = dcta[0];
+    MultiplyKeyElement(ct->GetElements()[0], ev.GetElementData(0, 0));
+    for (uint32_t d = 1; d < digitsHT; ++d){
+        MultiplyAddKeyElement(dcta[d], ev.GetElementData(d, 0), ct->GetElements()[0]);
     }
     
     for (uint32_t d = 0; d < digitsHT; ++d){
-        ct->GetElements()[1] += (dcta[d] * ev[d][1]);
+        MultiplyAddKeyElement(dcta[d], ev.GetElementData(d, 1), ct->GetElements()[1]);
     }
 }
 }  // namespace lbcrypto
\ No newline at end of file
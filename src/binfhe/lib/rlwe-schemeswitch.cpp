@@ -1,4 +1,6 @@
 #include "rlwe-schemeswitch.h"
+#include "signed-digit-decompose.h"
+#include "cirbts-trace.h"
 
 namespace lbcrypto{
 RLWESchemeSwitchKey RingLWESchemeSwitch::KeyGenSS(const std::shared_ptr<RLWECryptoParams>& params,
@@ -15,19 +17,23 @@ RLWESchemeSwitchKey RingLWESchemeSwitch::KeyGenSS(const std::shared_ptr<RLWECryp
 
     RLWESchemeSwitchKeyImpl result(digitsSS, 2);
 
-    DiscreteUniformGeneratorImpl<NativeVector> dug;
+    //the uniform polynomials are stored as seeds
+    std::vector<PolySeed> seeds(digitsSS);
 
     for (uint32_t i = 0; i < digitsSS; i++){
-        result[i][0] = NativePoly(dug, polyparams, Format::EVALUATION);
+        seeds[i] = SeededUniformGenerator::GenerateSeed();
+        result[i][0] = SeededUniformGenerator::Expand(polyparams, seeds[i]);
         result[i][1] = NativePoly(params->GetSSDgg(), polyparams, EVALUATION) + sk2 * SSpow[i];
         result[i][1] += (result[i][0] * skNTT);
     }
+    result.SetSeeds(std::move(seeds));
 
     return std::make_shared<RLWESchemeSwitchKeyImpl>(result);
 }
 
 void RingLWESchemeSwitch::EvalSS(const std::shared_ptr<RLWECryptoParams>& params, ConstRLWESchemeSwitchKey& ek,
                                  RLWECiphertext& ct) const {
+    CirBTSTraceScope span("EvalSS");
     NativePoly cta = ct->GetElements()[0];
     NativePoly ctb = ct->GetElements()[1];
     cta.SetFormat(COEFFICIENT);
@@ -40,62 +46,30 @@ void RingLWESchemeSwitch::EvalSS(const std::shared_ptr<RLWECryptoParams>& params
 
     auto digitsSS{params->GetDigitsSSA()};
     std::vector<NativePoly> dcta(digitsSS, NativePoly(polyparams, Format::COEFFICIENT, true));
-    SignedDigitDecompose(params, cta, dcta);
+    SignedDigitDecompose(params, cta, dcta, Format::EVALUATION);
 
-#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(digitsSS))
-    for(uint32_t d = 0; d < digitsSS; ++d){
-        dcta[d].SetFormat(Format::EVALUATION);
-    }
-
-    const std::vector<std::vector<NativePoly>>& ev = ek->GetElements();
+    const auto& ev{*ek};
     for (uint32_t d = 0; d < digitsSS; ++d){
-        ct->GetElements()[0] += (dcta[d] * ev[d][0]);
+        MultiplyAddKeyElement(dcta[d], ev.GetElementData(d, 0), ct->GetElements()[0]);
     }
 
     for (uint32_t d = 0; d < digitsSS; ++d){
-        ct->GetElements()[1] += (dcta[d] * ev[d][1]);
+        MultiplyAddKeyElement(dcta[d], ev.GetElementData(d, 1), ct->GetElements()[1]);
     }
 
 }
 
 void RingLWESchemeSwitch::SignedDigitDecompose(const std::shared_ptr<RLWECryptoParams>& params, const NativePoly& input,
-                                               std::vector<NativePoly>& output) const {
-    auto QHalf{params->GetQ().ConvertToInt<BasicInteger>() >> 1};
-    auto Q_int{params->GetQ().ConvertToInt<NativeInteger::SignedNativeInt>()};
-    auto baseSS = params->GetBaseSS();
+                                               std::vector<NativePoly>& output, Format format) const {
     //the bits of each digit
-    auto gBits{static_cast<NativeInteger::SignedNativeInt>(__builtin_ctz(baseSS))};
+    auto gBits{static_cast<uint32_t>(__builtin_ctz(params->GetBaseSS()))};
 
     //approximate length of scheme switch
     uint32_t digitsSS{params->GetDigitsSSA()};
 
     //ignore bits
-    uint32_t ignore_bits = 54 - digitsSS * gBits;
-    //the number of bits of approximate decomposition remain
-    auto gBitsMaxBits{static_cast<NativeInteger::SignedNativeInt>(NativeInteger::MaxBits() - ignore_bits)};
-    
-    uint32_t N{params->GetN()};
-    
-    auto gBitsMaxBits0{static_cast<NativeInteger::SignedNativeInt>(NativeInteger::MaxBits() - gBits)};
-
-    for (uint32_t k{0}; k < N; ++k){
-        auto t0{input[k].ConvertToInt<BasicInteger>()};
-        auto d0{static_cast<NativeInteger::SignedNativeInt>(t0 < QHalf ? t0 : t0 - Q_int)};
-        //the bits should ignore
-        auto r0 = d0;
-        if (ignore_bits != 0){
-            r0 = (d0 << gBitsMaxBits) >> gBitsMaxBits;
-            d0 = (d0 - r0) >> ignore_bits;
-        }
-
-        for (uint32_t d{0}; d < digitsSS; ++d){
-            r0 = (d0 << gBitsMaxBits0) >> gBitsMaxBits0;
-            d0 = (d0 - r0) >> gBits;
-            if (r0 < 0)
-                r0 += Q_int;
-            output[d + 0][k] += r0;
-        }
-    }
+    uint32_t ignore_bits = params->GetIgnoreBitsSS();
 
+    DecomposeSignedDigits(input, params->GetQ(), gBits, ignore_bits, digitsSS, output, 0, 1, format);
 }
 }  // namespace lbcrypto
\ No newline at end of file
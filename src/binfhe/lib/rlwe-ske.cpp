@@ -1,4 +1,5 @@
 #include "rlwe-ske.h"
+#include "signed-digit-decompose.h"
 
 #include <memory>
 
@@ -74,50 +75,17 @@ void RLWEEncryptionScheme::Decrypt(const std::shared_ptr<RLWECryptoParams>& para
 
 void RLWEEncryptionScheme::SignedDigitDecompose(const std::shared_ptr<RLWECryptoParams>& params,
                                                 ConstRLWECiphertext& input, const uint32_t base, const uint32_t digits,
-                                                std::vector<NativePoly>& output) const {
-    auto Q{params->GetQ()};
-    auto Q_int{Q.ConvertToInt<NativeInteger::SignedNativeInt>()};
-    auto QHalf = Q.ConvertToInt<BasicInteger>() >> 1;
-    auto gBits{static_cast<NativeInteger::SignedNativeInt>(__builtin_ctz(base))};
+                                                std::vector<NativePoly>& output, Format format) const {
+    auto gBits{static_cast<uint32_t>(__builtin_ctz(base))};
 
-    //the bits should be ignored
-    uint32_t ignore_bits = 54 - digits * gBits;
-    //the bits should be remained
-    auto gBitsMaxBits{static_cast<NativeInteger::SignedNativeInt>(NativeInteger::MaxBits() - ignore_bits)};
-    // approximate gadget decomposition is used;
-    uint32_t digitsG2{digits << 1};
-    uint32_t N{params->GetN()};
+    //the bits should be ignored: the digits cover the top of the bit length of Q
+    uint32_t logQ{params->GetQ().GetMSB()};
+    if (digits * gBits > logQ)
+        OPENFHE_THROW(config_error, "digits * log2(base) exceeds the bit length of Q");
+    uint32_t ignore_bits = logQ - digits * gBits;
 
-    auto gBitsMaxBits0{static_cast<NativeInteger::SignedNativeInt>(NativeInteger::MaxBits() - gBits)};
-    
-    auto cta = input->GetElements()[0];
-    auto ctb = input->GetElements()[1];
-
-    for (uint32_t k{0}; k < N; ++k) {
-        auto t0{cta[k].ConvertToInt<BasicInteger>()};
-        auto d0{static_cast<NativeInteger::SignedNativeInt>(t0 < QHalf ? t0 : t0 - Q_int)};
-        auto t1{ctb[k].ConvertToInt<BasicInteger>()};
-        auto d1{static_cast<NativeInteger::SignedNativeInt>(t1 < QHalf ? t1 : t1 - Q_int)};
-        
-        auto r0 = (d0 << gBitsMaxBits) >> gBitsMaxBits;
-        d0 = (d0 - r0) >> ignore_bits;
-        auto r1 = (d1 << gBitsMaxBits) >> gBitsMaxBits;
-        d1 = (d1 - r1) >> ignore_bits;
-
-        for (uint32_t d{0}; d < digitsG2; d += 2) {
-            r0 = (d0 << gBitsMaxBits0) >> gBitsMaxBits0;
-            d0 = (d0 - r0) >> gBits;
-            if (r0 < 0)
-                r0 += Q_int;
-            output[d + 0][k] += r0;
-
-            r1 = (d1 << gBitsMaxBits0) >> gBitsMaxBits0;
-            d1 = (d1 - r1) >> gBits;
-            if (r1 < 0)
-                r1 += Q_int;
-            output[d + 1][k] += r1; 
-        }
-    }                                               
+    DecomposeSignedDigits(input->GetElements()[0], params->GetQ(), gBits, ignore_bits, digits, output, 0, 2, format);
+    DecomposeSignedDigits(input->GetElements()[1], params->GetQ(), gBits, ignore_bits, digits, output, 1, 2, format);
 }
 
 } // namespace lbcrypto
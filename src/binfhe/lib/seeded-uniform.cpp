@@ -0,0 +1,77 @@
+#include "seeded-uniform.h"
+
+#include <string>
+
+namespace lbcrypto {
+
+PolySeed SeededUniformGenerator::GenerateSeed() {
+    auto& prng = PseudoRandomNumberGenerator::GetPRNG();
+    PolySeed seed;
+    for (auto& w : seed)
+        w = prng();
+    return seed;
+}
+
+PolySeed SeededUniformGenerator::DeriveSeed(const PolySeed& parent, uint32_t index) {
+    Blake2Engine engine(parent, index);
+    PolySeed seed;
+    for (auto& w : seed)
+        w = engine();
+    return seed;
+}
+
+NativePoly SeededUniformGenerator::Expand(const std::shared_ptr<ILNativeParams>& polyParams, const PolySeed& seed) {
+    NativePoly poly(polyParams, Format::EVALUATION, true);
+    Expand(seed, poly);
+    return poly;
+}
+
+void SeededUniformGenerator::Expand(const PolySeed& seed, NativePoly& poly) {
+    const auto& Q = poly.GetModulus();
+    uint64_t q{Q.ConvertToInt<uint64_t>()};
+    uint64_t mask{Q.GetMSB() >= 64 ? ~uint64_t(0) : (uint64_t(1) << Q.GetMSB()) - 1};
+    Blake2Engine engine(seed);
+
+    // rejection sampling on the bit length of Q keeps the coefficients exactly uniform
+    uint32_t N{poly.GetRingDimension()};
+    for (uint32_t i = 0; i < N; ++i) {
+        uint64_t v;
+        do {
+            uint64_t hi{engine()};
+            v = ((hi << 32) | engine()) & mask;
+        } while (v >= q);
+        poly[i] = v;
+    }
+    poly.OverrideFormat(Format::EVALUATION);
+}
+
+// seed of the stream of the calling thread
+static thread_local std::shared_ptr<const PolySeed> currentStream;
+
+PRNGStream::PRNGStream(const std::shared_ptr<const PolySeed>& parent, uint32_t index) {
+    if (parent == nullptr)
+        return;
+    if (index == SAMPLING_INDEX)
+        OPENFHE_THROW("the index of a PRNG stream must be smaller than " + std::to_string(SAMPLING_INDEX));
+    auto seed = std::make_shared<const PolySeed>(SeededUniformGenerator::DeriveSeed(*parent, index));
+    // the samples of the task come from a separate child of its seed, so the seeds of the nested
+    // streams are independent of the samples, which may be public like the seeds of the keys
+    auto engine   = std::make_shared<PRNG>(SeededUniformGenerator::DeriveSeed(*seed, SAMPLING_INDEX));
+    m_active      = true;
+    m_prevPRNG    = PseudoRandomNumberGenerator::ExchangePRNG(std::move(engine));
+    m_prevSeed    = std::move(currentStream);
+    currentStream = std::move(seed);
+}
+
+PRNGStream::~PRNGStream() {
+    if (!m_active)
+        return;
+    PseudoRandomNumberGenerator::ExchangePRNG(std::move(m_prevPRNG));
+    currentStream = std::move(m_prevSeed);
+}
+
+std::shared_ptr<const PolySeed> PRNGStream::Current() {
+    return currentStream;
+}
+
+}  // namespace lbcrypto
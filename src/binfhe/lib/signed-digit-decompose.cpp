@@ -0,0 +1,97 @@
+#include "signed-digit-decompose.h"
+
+#include <algorithm>
+
+// function multiversioning gives the runtime dispatch with the baseline as scalar fallback
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(__clang__) && !defined(__MINGW64__)
+    #define DECOMPOSE_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+    #define DECOMPOSE_TARGET_CLONES
+#endif
+
+namespace lbcrypto {
+
+static_assert(sizeof(NativeInteger) == sizeof(uint64_t), "NativeInteger is expected to wrap a single uint64_t");
+
+namespace {
+
+// upper bound on the number of digits, so that the output pointers fit on the stack
+constexpr uint32_t DECOMPOSE_MAX_DIGITS = 64;
+
+// arithmetic shift pair that keeps the low (64 - shift) bits as a signed value
+inline int64_t LowSigned(int64_t x, uint32_t shift) {
+    return static_cast<int64_t>(static_cast<uint64_t>(x) << shift) >> shift;
+}
+
+// centers the coefficients in (-Q/2, Q/2] and rounds away the ignored low bits
+DECOMPOSE_TARGET_CLONES
+void CenterAndRound(const uint64_t* in, uint32_t N, uint64_t Q, uint32_t ignoreBits, uint64_t* state) {
+    const uint64_t QHalf{Q >> 1};
+    for (uint32_t k = 0; k < N; ++k)
+        state[k] = in[k] < QHalf ? in[k] : in[k] - Q;
+
+    if (ignoreBits != 0) {
+        const uint32_t shift{64 - ignoreBits};
+        for (uint32_t k = 0; k < N; ++k) {
+            int64_t x{static_cast<int64_t>(state[k])};
+            state[k] = static_cast<uint64_t>((x - LowSigned(x, shift)) >> ignoreBits);
+        }
+    }
+}
+
+// replaces the remaining value in digit by its lowest signed digit mod Q; the quotient
+// goes to next, which is the buffer of the following digit (nullptr for the last one)
+DECOMPOSE_TARGET_CLONES
+void ExtractDigit(uint64_t* digit, uint64_t* next, uint32_t N, uint64_t Q, uint32_t gBits) {
+    const uint32_t shift{64 - gBits};
+    if (next != nullptr) {
+        for (uint32_t k = 0; k < N; ++k) {
+            int64_t x{static_cast<int64_t>(digit[k])};
+            int64_t r{LowSigned(x, shift)};
+            next[k]  = static_cast<uint64_t>((x - r) >> gBits);
+            digit[k] = static_cast<uint64_t>(r) + (r < 0 ? Q : 0);
+        }
+    }
+    else {
+        for (uint32_t k = 0; k < N; ++k) {
+            int64_t r{LowSigned(static_cast<int64_t>(digit[k]), shift)};
+            digit[k] = static_cast<uint64_t>(r) + (r < 0 ? Q : 0);
+        }
+    }
+}
+
+}  // namespace
+
+void DecomposeSignedDigits(const NativePoly& input, const NativeInteger& Q, uint32_t gBits, uint32_t ignoreBits,
+                           uint32_t digits, std::vector<NativePoly>& output, uint32_t offset, uint32_t stride,
+                           Format format) {
+    if (gBits == 0 || gBits >= 64 || ignoreBits >= 64)
+        OPENFHE_THROW("DecomposeSignedDigits: invalid digit size");
+    if (digits > DECOMPOSE_MAX_DIGITS)
+        OPENFHE_THROW("DecomposeSignedDigits: too many digits");
+    if (digits == 0)
+        return;
+    if (output.size() < offset + (digits - 1) * stride + 1)
+        OPENFHE_THROW("DecomposeSignedDigits: not enough output polynomials");
+
+    const uint32_t N{input.GetRingDimension()};
+    const uint64_t* in = reinterpret_cast<const uint64_t*>(&input.GetValues()[0]);
+    uint64_t* out[DECOMPOSE_MAX_DIGITS];
+    for (uint32_t i = 0; i < digits; ++i) {
+        auto& poly = output[offset + i * stride];
+        poly.OverrideFormat(Format::COEFFICIENT);
+        out[i] = reinterpret_cast<uint64_t*>(&poly[0]);
+    }
+
+    // digits are produced one at a time over the whole polynomial, carrying the quotient in
+    // the buffer of the next digit; each finished digit is transformed while it is still in cache
+    const uint64_t q{Q.ConvertToInt<uint64_t>()};
+    CenterAndRound(in, N, q, ignoreBits, out[0]);
+    for (uint32_t i = 0; i < digits; ++i) {
+        ExtractDigit(out[i], i + 1 < digits ? out[i + 1] : nullptr, N, q, gBits);
+        if (format == Format::EVALUATION)
+            output[offset + i * stride].SetFormat(Format::EVALUATION);
+    }
+}
+
+}  // namespace lbcrypto
@@ -0,0 +1,913 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/*
+  This code runs unit tests for the circuit bootstrapping methods of the OpenFHE lattice encryption library
+ */
+
+#include "automorphism-plan.h"
+#include "cirbts-circuit.h"
+#include "cirbts-param-gen.h"
+#include "cirbtscontext.h"
+#include "rgsw-acc-lmkcdey.h"
+#include "rlwe-ske.h"
+#include "signed-digit-decompose.h"
+#include "utils/parallel.h"
+#include "UnitTestCirBTSUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <tuple>
+
+using namespace lbcrypto;
+
+// ---------------  TESTING CIRCUIT BOOTSTRAPPING ---------------
+TEST(UnitTestCirBTS, CircuitBootstrapBatch) {
+    auto [cc, sk, sk2] = GenerateCirBTSTestContext(STD128_CircuitBootstrap_CMUX_2, GINX);
+
+    const std::vector<LWEPlaintext> bits{0, 1, 1, 0, 1};
+    std::vector<LWECiphertext> ct;
+    for (auto bit : bits)
+        ct.push_back(cc.Encrypt(sk, bit));
+
+    auto ctGSW = cc.CircuitBootstrapBatch(ct);
+    ASSERT_EQ(ctGSW.size(), bits.size());
+    for (size_t i = 0; i < bits.size(); ++i)
+        CheckRGSW(cc, sk2, ctGSW[i], bits[i], "CircuitBootstrapBatch failed for ciphertext " + std::to_string(i));
+
+    EXPECT_TRUE(cc.CircuitBootstrapBatch({}).empty());
+}
+
+TEST(UnitTestCirBTS, ExternalProductCMux) {
+    auto [cc, sk, sk2] = GenerateCirBTSTestContext(STD128_CircuitBootstrap_CMUX_2, GINX);
+
+    auto& rlweParams = cc.GetParams()->GetRLWEParams();
+    auto polyParams  = rlweParams->GetPolyParams();
+    auto N           = polyParams->GetRingDimension();
+    RLWEEncryptionScheme rlwe;
+    BinaryUniformGeneratorImpl<NativeVector> bug;
+    NativePoly m0(bug, polyParams, COEFFICIENT);
+    NativePoly m1(bug, polyParams, COEFFICIENT);
+    auto ct0 = rlwe.Encrypt(rlweParams, sk2, m0, 2, polyParams->GetModulus());
+    auto ct1 = rlwe.Encrypt(rlweParams, sk2, m1, 2, polyParams->GetModulus());
+
+    BlindRotationWorkspace ws;
+    for (LWEPlaintext bit : {0, 1}) {
+        auto sel        = cc.CircuitBootstrapping(cc.Encrypt(sk, bit));
+        std::string msg = "selector bit " + std::to_string(bit) + ": ";
+
+        // the kernel computes the same sum of products as the reference
+        auto ct = cc.EvalExternalProduct(sel, ct0);
+        EXPECT_EQ(*ct, *ExternalProduct(cc, sel, ct0)) << msg << "external product mismatch";
+        auto ctInPlace = std::make_shared<RLWECiphertextImpl>(*ct0);
+        cc.EvalExternalProductInPlace(sel, ctInPlace, ws);
+        EXPECT_EQ(*ctInPlace, *ct) << msg << "in-place external product mismatch";
+
+        NativePoly result(polyParams, COEFFICIENT, true);
+        auto cmux = cc.EvalCMux(sel, ct0, ct1);
+        rlwe.Decrypt(rlweParams, sk2, cmux, &result, 2);
+        const auto& expected = bit ? m1 : m0;
+        for (uint32_t i = 0; i < N; ++i)
+            ASSERT_EQ(result[i], expected[i]) << msg << "CMux coefficient " << i;
+
+        auto cmuxInPlace = std::make_shared<RLWECiphertextImpl>(*ct0);
+        cc.EvalCMuxInPlace(sel, cmuxInPlace, ct1, ws);
+        EXPECT_EQ(*cmuxInPlace, *cmux) << msg << "in-place CMux mismatch";
+    }
+}
+
+TEST(UnitTestCirBTS, EvalLUT) {
+    auto [cc, sk, sk2] = GenerateCirBTSTestContext(STD128_CircuitBootstrap_CMUX_2, GINX);
+    auto& rlweParams = cc.GetParams()->GetRLWEParams();
+
+    // 64 output bits leave N / 64 entries per polynomial: the 2 high bits of the 7-bit index
+    // go through a CMux tree and the 5 low bits through the blind rotation
+    const uint32_t k{7};
+    std::vector<uint64_t> table(1 << k);
+    std::mt19937_64 prng(42);
+    for (auto& entry : table)
+        entry = prng();
+
+    RLWEEncryptionScheme rlwe;
+    for (uint64_t x : {0x5bu, 0x26u}) {
+        std::vector<LWECiphertext> bits;
+        for (uint32_t i = 0; i < k; ++i)
+            bits.push_back(cc.Encrypt(sk, (x >> i) & 0x1));
+        auto ct = cc.EvalLUT(cc.CircuitBootstrapBatch(bits), table, 64);
+
+        NativePoly result(rlweParams->GetPolyParams(), COEFFICIENT, true);
+        rlwe.Decrypt(rlweParams, sk2, ct, &result, 2);
+        for (uint32_t t = 0; t < 64; ++t)
+            ASSERT_EQ(result[t].ConvertToInt(), (table[x] >> t) & 0x1) << "input " << x << " output bit " << t;
+    }
+
+    // a short table on many selector bits only encrypts the polynomials holding its entries
+    auto zero = cc.CircuitBootstrapping(cc.Encrypt(sk, 0));
+    auto one  = cc.CircuitBootstrapping(cc.Encrypt(sk, 1));
+    const std::vector<uint64_t> small{5, 3, 6};
+    for (uint64_t x : {1u, 2u}) {
+        std::vector<RGSWCiphertext> sel(40, zero);
+        sel[0] = x & 0x1 ? one : zero;
+        sel[1] = x & 0x2 ? one : zero;
+        NativePoly result(rlweParams->GetPolyParams(), COEFFICIENT, true);
+        rlwe.Decrypt(rlweParams, sk2, cc.EvalLUT(sel, small, 3), &result, 2);
+        for (uint32_t t = 0; t < 3; ++t)
+            ASSERT_EQ(result[t].ConvertToInt(), (small[x] >> t) & 0x1) << "small table input " << x << " output bit " << t;
+        // a high selector bit moves the input past the end of the table
+        sel[39] = one;
+        rlwe.Decrypt(rlweParams, sk2, cc.EvalLUT(sel, small, 3), &result, 2);
+        for (uint32_t t = 0; t < 3; ++t)
+            ASSERT_EQ(result[t].ConvertToInt(), 0u) << "missing entry output bit " << t;
+    }
+
+    std::vector<RGSWCiphertext> sel(2);
+    EXPECT_THROW(cc.EvalLUT(sel, std::vector<uint64_t>(5)), config_error);
+    // the selectors are checked before the parallel regions
+    sel = {zero, nullptr};
+    EXPECT_THROW(cc.EvalLUT(sel, std::vector<uint64_t>(3)), config_error);
+    sel = {zero, std::make_shared<RGSWCiphertextImpl>(1, 2)};
+    EXPECT_THROW(cc.EvalLUT(sel, std::vector<uint64_t>(3)), config_error);
+}
+
+TEST(UnitTestCirBTS, Circuit) {
+    auto [cc, sk, sk2] = GenerateCirBTSTestContext(STD128_CircuitBootstrap_CMUX_2, GINX);
+    auto& rlweParams = cc.GetParams()->GetRLWEParams();
+    auto polyParams  = rlweParams->GetPolyParams();
+
+    // the wire a feeds four gates, the wire d only feeds a gate that no output depends on
+    CirBTSCircuit circuit;
+    auto a  = circuit.AddLWEInput();
+    auto b  = circuit.AddLWEInput();
+    auto c  = circuit.AddLWEInput();
+    auto d  = circuit.AddLWEInput();
+    auto r0 = circuit.AddRLWEInput();
+    auto r1 = circuit.AddRLWEInput();
+    auto g1 = circuit.AddCMux(a, r0, r1);
+    auto g2 = circuit.AddCMux(b, g1, r1);
+    auto g3 = circuit.AddExternalProduct(a, r1);
+    const std::vector<uint64_t> table{3, 1, 4, 1, 5, 9, 2, 6};
+    auto g4 = circuit.AddLUT({a, b, c}, table, 4);
+    auto g5 = circuit.AddCMux(a, g2, g3);
+    circuit.AddCMux(d, r0, g5);
+    circuit.MarkOutput(g5);
+    circuit.MarkOutput(g1);
+    circuit.MarkOutput(g4);
+    EXPECT_EQ(circuit.GetNumBootstraps(), 3u);
+    EXPECT_THROW(circuit.AddCMux(r0, r0, r1), config_error);
+    EXPECT_THROW(circuit.AddCMux(a, b, r1), config_error);
+
+    RLWEEncryptionScheme rlwe;
+    BinaryUniformGeneratorImpl<NativeVector> bug;
+    NativePoly m0(bug, polyParams, COEFFICIENT);
+    NativePoly m1(bug, polyParams, COEFFICIENT);
+    NativePoly zero(polyParams, COEFFICIENT, true);
+    std::vector<RLWECiphertext> cts{rlwe.Encrypt(rlweParams, sk2, m0, 2, polyParams->GetModulus()),
+                                    rlwe.Encrypt(rlweParams, sk2, m1, 2, polyParams->GetModulus())};
+    for (auto bits : {std::array<LWEPlaintext, 3>{1, 0, 1}, std::array<LWEPlaintext, 3>{0, 1, 1}}) {
+        std::vector<LWECiphertext> lwe;
+        for (auto bit : bits)
+            lwe.push_back(cc.Encrypt(sk, bit));
+        lwe.push_back(cc.Encrypt(sk, 0));
+        auto res = circuit.Evaluate(cc, lwe, cts);
+        ASSERT_EQ(res.size(), 3u);
+
+        const auto& e1 = bits[0] ? m1 : m0;
+        const auto& e2 = bits[1] ? m1 : e1;
+        const auto& e3 = bits[0] ? m1 : zero;
+        const auto& e5 = bits[0] ? e3 : e2;
+        uint64_t x{static_cast<uint64_t>(bits[0] + 2 * bits[1] + 4 * bits[2])};
+        NativePoly result(polyParams, COEFFICIENT, true);
+        rlwe.Decrypt(rlweParams, sk2, res[0], &result, 2);
+        EXPECT_EQ(result, e5) << "output g5";
+        rlwe.Decrypt(rlweParams, sk2, res[1], &result, 2);
+        EXPECT_EQ(result, e1) << "output g1";
+        rlwe.Decrypt(rlweParams, sk2, res[2], &result, 2);
+        for (uint32_t t = 0; t < 4; ++t)
+            EXPECT_EQ(result[t].ConvertToInt(), (table[x] >> t) & 0x1) << "output g4 bit " << t;
+    }
+}
+
+TEST(UnitTestCirBTS, FFTBackend) {
+    auto [cc, sk, sk2] = GenerateCirBTSTestContext(STD128_CircuitBootstrap_CMUX_2, GINX, FFT_BACKEND);
+    ASSERT_EQ(cc.GetProductBackend(), FFT_BACKEND);
+
+    for (LWEPlaintext bit : {0, 1}) {
+        auto ctGSW = cc.CircuitBootstrapping(cc.Encrypt(sk, bit));
+        CheckRGSW(cc, sk2, ctGSW, bit, "CircuitBootstrapping with the FFT backend failed for bit " + std::to_string(bit));
+    }
+
+    const std::vector<LWEPlaintext> bits{1, 0, 1};
+    std::vector<LWECiphertext> ct;
+    for (auto bit : bits)
+        ct.push_back(cc.Encrypt(sk, bit));
+    auto ctGSW = cc.CircuitBootstrapBatch(ct);
+    for (size_t i = 0; i < bits.size(); ++i)
+        CheckRGSW(cc, sk2, ctGSW[i], bits[i], "CircuitBootstrapBatch with the FFT backend failed for ciphertext " + std::to_string(i));
+
+    // switching back uses the refresh key in the NTT domain
+    cc.SetProductBackend(NTT_BACKEND);
+    CheckRGSW(cc, sk2, cc.CircuitBootstrapping(cc.Encrypt(sk, 1)), 1, "CircuitBootstrapping after switching back failed");
+
+    // the limbs are sized for the failure rate of a blind rotation, also for the wide gadget of CMUX_1
+    for (auto set : {STD128_CircuitBootstrap_CMUX_1, STD128_CircuitBootstrap_CMUX_2, STD128_CircuitBootstrap_CMUX_3}) {
+        auto ccSet = CirBTSContext();
+        ccSet.GenerateCirBTSContext(set, GINX, FFT_BACKEND);
+        const auto& RGSWParams1 = ccSet.GetParams()->GetRingGSWParams1();
+        uint32_t logQ           = RGSWParams1->GetQ().GetMSB();
+        EXPECT_GT(RGSWParams1->GetFFTNumLimbs(), 0u) << "parameter set " << set;
+        EXPECT_GE(RGSWParams1->GetFFTNumLimbs() * RGSWParams1->GetFFTLimbBits(), logQ) << "parameter set " << set;
+        EXPECT_LE(RGSWParams1->GetFFTLog2FailureRate(), -40.0) << "parameter set " << set;
+    }
+}
+
+TEST(UnitTestCirBTS, AutomorphismParamSet) {
+    EXPECT_THROW(CirBTSContext().GenerateCirBTSContext(STD128_CircuitBootstrap_AUTO, GINX), config_error);
+    auto [cc, sk, sk2] = GenerateCirBTSTestContext(STD128_CircuitBootstrap_AUTO, LMKCDEY);
+
+    for (LWEPlaintext bit : {0, 1}) {
+        auto ctGSW = cc.CircuitBootstrapping(cc.Encrypt(sk, bit));
+        CheckRGSW(cc, sk2, ctGSW, bit, "CircuitBootstrapping with LMKCDEY failed for bit " + std::to_string(bit));
+    }
+
+    const std::vector<LWEPlaintext> bits{1, 1, 0};
+    std::vector<LWECiphertext> ct;
+    for (auto bit : bits)
+        ct.push_back(cc.Encrypt(sk, bit));
+    auto ctGSW = cc.CircuitBootstrapBatch(ct);
+    for (size_t i = 0; i < bits.size(); ++i)
+        CheckRGSW(cc, sk2, ctGSW[i], bits[i], "CircuitBootstrapBatch with LMKCDEY failed for ciphertext " + std::to_string(i));
+}
+
+TEST(UnitTestCirBTS, AutomorphismSchedule) {
+    uint32_t N{2048};
+    RingGSWCryptoParams params(N, LastPrime<NativeInteger>(54, 2 * N), 2 * N, 1 << 18, 1024, LMKCDEY, 3.2, 2,
+                               UNIFORM_BINARY, false, 11);
+    const auto& genPow = params.GetGenPowers();
+    const auto& logGen = params.GetLogGen();
+    ASSERT_EQ(genPow.size(), N / 2);
+    for (uint32_t i = 1; i < N / 2; ++i) {
+        ASSERT_EQ(genPow[i], NativeInteger(5).ModExp(i, 2 * N).ConvertToInt<uint32_t>()) << "5^" << i;
+        ASSERT_EQ(logGen[genPow[i]], static_cast<int32_t>(i)) << "log of 5^" << i;
+        ASSERT_EQ(logGen[2 * N - genPow[i]], -static_cast<int32_t>(i)) << "log of -5^" << i;
+    }
+
+    // cheaper keys never shrink the window
+    uint32_t prev{N};
+    for (double keyCost : {0.25, 1.0, 4.0, 64.0}) {
+        uint32_t numAutoKeys{RingGSWCryptoParams::ChooseNumAutoKeys(N, 458, 2, keyCost)};
+        EXPECT_GE(numAutoKeys, 1u);
+        EXPECT_LE(numAutoKeys, prev) << "key cost " << keyCost;
+        prev = numAutoKeys;
+    }
+}
+
+TEST(UnitTestCirBTS, KeyUnrolling) {
+    for (auto backend : {NTT_BACKEND, FFT_BACKEND}) {
+        for (uint32_t unroll : {2u, 3u}) {
+            auto cc = CirBTSContext();
+            cc.GenerateCirBTSContext(STD128_CircuitBootstrap_CMUX_2, GINX, backend);
+            cc.SetKeyUnrollFactor(unroll);
+            auto sk  = cc.KeyGen();
+            auto sk2 = cc.RLWEKeyGen();
+            cc.CirBTKeyGen(sk, sk2);
+            std::string config = " (backend " + std::to_string(backend) + ", unroll factor " + std::to_string(unroll) + ")";
+
+            const std::vector<LWEPlaintext> bits{1, 0};
+            std::vector<LWECiphertext> ct;
+            for (auto bit : bits)
+                ct.push_back(cc.Encrypt(sk, bit));
+            auto ctGSW = cc.CircuitBootstrapBatch(ct);
+            for (size_t i = 0; i < bits.size(); ++i)
+                CheckRGSW(cc, sk2, ctGSW[i], bits[i], "CircuitBootstrapBatch failed for ciphertext " + std::to_string(i) + config);
+            CheckRGSW(cc, sk2, cc.CircuitBootstrapping(ct[0]), bits[0], "CircuitBootstrapping failed" + config);
+        }
+    }
+}
+
+TEST(UnitTestCirBTS, RawKeySerialization) {
+    const std::array<std::tuple<CirBTS_PARAMSET, BINFHE_METHOD, EXTPROD_BACKEND>, 2> configs{
+        std::make_tuple(STD128_CircuitBootstrap_AUTO, LMKCDEY, NTT_BACKEND),
+        std::make_tuple(STD128_CircuitBootstrap_CMUX_2, GINX, FFT_BACKEND)};
+    for (const auto& config : configs) {
+        auto [cc1, sk, sk2] = GenerateCirBTSTestContext(std::get<0>(config), std::get<1>(config));
+        std::string msg = "raw key serialization failed for method " + std::to_string(std::get<1>(config)) + ": ";
+
+        std::stringstream s;
+        cc1.SerializeBTKey(s);
+
+        // the keys are loaded in a fresh context, the refresh key in the FFT domain is derived on load
+        auto cc2 = CirBTSContext();
+        cc2.GenerateCirBTSContext(std::get<0>(config), std::get<1>(config), std::get<2>(config));
+        cc2.DeserializeBTKey(s);
+        EXPECT_EQ(*cc2.GetRefreshKey(), *cc1.GetRefreshKey()) << msg << "refresh key mismatch";
+        EXPECT_EQ(*cc2.GetHomTraceKey(), *cc1.GetHomTraceKey()) << msg << "homtrace key mismatch";
+        EXPECT_EQ(*cc2.GetSchemeSwitchingKey(), *cc1.GetSchemeSwitchingKey()) << msg << "scheme switching key mismatch";
+        EXPECT_EQ(cc2.GetCirBTSKey().RTOkey == nullptr, cc1.GetCirBTSKey().RTOkey == nullptr) << msg << "round-to-odd key mismatch";
+        EXPECT_EQ(cc2.GetCirBTSKey().FFTkey != nullptr, std::get<2>(config) == FFT_BACKEND) << msg << "FFT key mismatch";
+
+        for (LWEPlaintext bit : {0, 1})
+            CheckRGSW(cc2, sk2, cc2.CircuitBootstrapping(cc2.Encrypt(sk, bit)), bit, msg + "bit " + std::to_string(bit));
+    }
+
+    // keys of other parameters are rejected
+    auto cc1 = CirBTSContext();
+    cc1.GenerateCirBTSContext(STD128_CircuitBootstrap_CMUX_2, GINX);
+    cc1.CirBTKeyGen(cc1.KeyGen(), cc1.RLWEKeyGen());
+    std::stringstream s;
+    cc1.SerializeBTKey(s);
+    auto cc2 = CirBTSContext();
+    cc2.GenerateCirBTSContext(STD128_CircuitBootstrap_AUTO, LMKCDEY);
+    EXPECT_THROW(cc2.DeserializeBTKey(s), OpenFHEException);
+
+    // the same ring with other gadgets: the refresh key of CMUX_1 has fewer rows than CMUX_2 reads
+    auto cc3 = CirBTSContext();
+    cc3.GenerateCirBTSContext(STD128_CircuitBootstrap_CMUX_1, GINX);
+    cc3.CirBTKeyGen(cc3.KeyGen(), cc3.RLWEKeyGen());
+    std::stringstream s3;
+    cc3.SerializeBTKey(s3);
+    auto cc4 = CirBTSContext();
+    cc4.GenerateCirBTSContext(STD128_CircuitBootstrap_CMUX_2, GINX);
+    EXPECT_THROW(cc4.DeserializeBTKey(s3), OpenFHEException);
+}
+
+TEST(UnitTestCirBTS, MappedKeys) {
+    const std::array<std::tuple<CirBTS_PARAMSET, BINFHE_METHOD, EXTPROD_BACKEND>, 2> configs{
+        std::make_tuple(STD128_CircuitBootstrap_AUTO, LMKCDEY, NTT_BACKEND),
+        std::make_tuple(STD128_CircuitBootstrap_CMUX_2, GINX, FFT_BACKEND)};
+    for (const auto& config : configs) {
+        auto [cc1, sk, sk2] = GenerateCirBTSTestContext(std::get<0>(config), std::get<1>(config), std::get<2>(config));
+        std::string msg = "mapped keys failed for method " + std::to_string(std::get<1>(config)) + ": ";
+
+        std::string filename = TempFileName("cirbts-key-map-" + std::to_string(std::get<1>(config)) + ".bin");
+        ASSERT_TRUE(cc1.SerializeBTKeyToMappableFile(filename)) << msg << "could not write " << filename;
+        auto cc2 = CirBTSContext();
+        cc2.GenerateCirBTSContext(std::get<0>(config), std::get<1>(config), std::get<2>(config));
+        cc2.MapBTKeyFromFile(filename);
+        // the mapping stays valid after the file is unlinked
+        std::remove(filename.c_str());
+
+        EXPECT_TRUE(cc2.GetSchemeSwitchingKey()->IsView()) << msg << "the keys are not views of the mapping";
+        EXPECT_EQ(*cc2.GetRefreshKey(), *cc1.GetRefreshKey()) << msg << "refresh key mismatch";
+        EXPECT_EQ(*cc2.GetHomTraceKey(), *cc1.GetHomTraceKey()) << msg << "homtrace key mismatch";
+        EXPECT_EQ(*cc2.GetSchemeSwitchingKey(), *cc1.GetSchemeSwitchingKey()) << msg << "scheme switching key mismatch";
+        if (std::get<1>(config) == LMKCDEY)
+            EXPECT_EQ(*cc2.GetCirBTSKey().RTOkey, *cc1.GetCirBTSKey().RTOkey) << msg << "round-to-odd key mismatch";
+
+        for (LWEPlaintext bit : {0, 1})
+            CheckRGSW(cc2, sk2, cc2.CircuitBootstrapping(cc2.Encrypt(sk, bit)), bit, msg + "bit " + std::to_string(bit));
+
+        // views are written like owned keys
+        std::stringstream s;
+        cc2.SerializeBTKey(s);
+        auto cc3 = CirBTSContext();
+        cc3.GenerateCirBTSContext(std::get<0>(config), std::get<1>(config), std::get<2>(config));
+        cc3.DeserializeBTKey(s);
+        EXPECT_EQ(*cc3.GetRefreshKey(), *cc1.GetRefreshKey()) << msg << "raw copy of the mapped refresh key mismatch";
+        EXPECT_THROW((*cc2.GetSchemeSwitchingKey())[0], OpenFHEException) << msg << "a view gave access to its rows";
+    }
+
+    // the shapes of the mapped keys are checked before the views are created
+    auto cc1 = CirBTSContext();
+    cc1.GenerateCirBTSContext(STD128_CircuitBootstrap_CMUX_1, GINX);
+    cc1.CirBTKeyGen(cc1.KeyGen(), cc1.RLWEKeyGen());
+    std::string filename = TempFileName("cirbts-key-map-cmux1.bin");
+    ASSERT_TRUE(cc1.SerializeBTKeyToMappableFile(filename)) << "could not write " << filename;
+    auto cc2 = CirBTSContext();
+    cc2.GenerateCirBTSContext(STD128_CircuitBootstrap_CMUX_2, GINX);
+    EXPECT_THROW(cc2.MapBTKeyFromFile(filename), OpenFHEException);
+    std::remove(filename.c_str());
+}
+
+TEST(UnitTestCirBTS, SeededKeys) {
+    auto cc = CirBTSContext();
+    cc.GenerateCirBTSContext(STD128_CircuitBootstrap_CMUX_2, GINX);
+    cc.CirBTKeyGen(cc.KeyGen(), cc.RLWEKeyGen());
+
+    // every row has its own seed and the uniform column is its expansion
+    size_t numPolys{0};
+    auto check = [&numPolys](ConstRingGSWEvalKey& ek, const std::string& name) {
+        const auto& elements = ek->GetElements();
+        const auto& seeds    = ek->GetSeeds();
+        ASSERT_EQ(seeds.size(), elements.size()) << name;
+        for (size_t i = 0; i < seeds.size(); ++i) {
+            EXPECT_EQ(elements[i][0], SeededUniformGenerator::Expand(elements[i][0].GetParams(), seeds[i])) << name << " row " << i;
+            if (i > 0)
+                EXPECT_NE(elements[i][0], elements[i - 1][0]) << name << " rows " << i - 1 << " and " << i << " share the same a";
+        }
+        numPolys += 2 * elements.size();
+    };
+    check((*cc.GetRefreshKey())[0][0][0], "refresh key");
+    check((*cc.GetHomTraceKey())[0][0][0], "homtrace key");
+    check(cc.GetSchemeSwitchingKey(), "scheme switching key");
+
+    // the raw format stores the seeds instead of the uniform polynomials
+    const auto& rf = (*cc.GetRefreshKey())[0];
+    numPolys += 2 * rf[0][0]->GetElements().size() * (rf.size() * rf[0].size() - 1);
+    numPolys += 2 * (*cc.GetHomTraceKey())[0][0][0]->GetElements().size() * ((*cc.GetHomTraceKey())[0][0].size() - 1);
+    std::stringstream s;
+    cc.SerializeBTKey(s);
+    size_t polyBytes = cc.GetParams()->GetRLWEParams()->GetN() * sizeof(uint64_t);
+    EXPECT_LT(s.str().size(), numPolys * polyBytes * 51 / 100) << "the seeded key is not compressed";
+}
+
+TEST(UnitTestCirBTS, DeterministicKeyGen) {
+    for (auto method : {GINX, LMKCDEY}) {
+        auto cc = CirBTSContext();
+        cc.GenerateCirBTSContext(method == GINX ? STD128_CircuitBootstrap_CMUX_2 : STD128_CircuitBootstrap_AUTO, method);
+        auto sk   = cc.KeyGen();
+        auto sk2  = cc.RLWEKeyGen();
+        auto seed = SeededUniformGenerator::GenerateSeed();
+        std::string msg = "key generation with method " + std::to_string(method);
+
+        int numThreads = OpenFHEParallelControls.GetThreadLimit(std::numeric_limits<int>::max());
+        OpenFHEParallelControls.SetNumThreads(1);
+        cc.CirBTKeyGen(sk, sk2, seed);
+        auto key1 = cc.GetCirBTSKey();
+        OpenFHEParallelControls.SetNumThreads(4);
+        cc.CirBTKeyGen(sk, sk2, seed);
+        const auto& key2 = cc.GetCirBTSKey();
+        OpenFHEParallelControls.SetNumThreads(numThreads);
+        EXPECT_EQ(*key1.RFkey, *key2.RFkey) << msg << " is not reproducible: refresh key";
+        EXPECT_EQ(*key1.HTkey, *key2.HTkey) << msg << " is not reproducible: homtrace key";
+        EXPECT_EQ(*key1.SSkey, *key2.SSkey) << msg << " is not reproducible: scheme switching key";
+        if (method == LMKCDEY)
+            EXPECT_EQ(*key1.RTOkey, *key2.RTOkey) << msg << " is not reproducible: round-to-odd key";
+
+        seed[0] ^= 1;
+        cc.CirBTKeyGen(sk, sk2, seed);
+        EXPECT_NE(*key1.RFkey, *cc.GetRefreshKey()) << msg << " ignores the seed";
+        CheckRGSW(cc, sk2, cc.CircuitBootstrapping(cc.Encrypt(sk, 1)), 1, msg + " failed");
+    }
+}
+
+TEST(UnitTestCirBTS, EvalMonomials) {
+    auto cc = CirBTSContext();
+    cc.GenerateCirBTSContext(STD128_CircuitBootstrap_CMUX_2, GINX);
+    auto polyParams = cc.GetParams()->GetRingGSWParams1()->GetPolyParams();
+    uint32_t N      = polyParams->GetRingDimension();
+    auto Q          = polyParams->GetModulus();
+    const auto& monomials = cc.GetParams()->GetMonomials();
+
+    DiscreteUniformGeneratorImpl<NativeVector> dug;
+    NativePoly a(dug, polyParams, EVALUATION);
+    for (uint32_t k : {0u, 1u, 7u, N - 1, N, N + 3, 2 * N - 1, 2 * N}) {
+        // X^k = -X^{k - N} for k >= N
+        NativePoly expected(polyParams, COEFFICIENT, true);
+        if ((k % (2 * N)) < N)
+            expected[k % N] = 1;
+        else
+            expected[k % N] = Q - 1;
+        expected.SetFormat(EVALUATION);
+        EXPECT_EQ(monomials.GetMonomial(k), expected) << "GetMonomial failed for k = " << k;
+
+        NativePoly expectedMinusOne(expected);
+        expectedMinusOne.SetFormat(COEFFICIENT);
+        expectedMinusOne[0].ModSubFastEq(1, Q);
+        expectedMinusOne.SetFormat(EVALUATION);
+        EXPECT_EQ(monomials.GetMonomialMinusOne(k), expectedMinusOne) << "GetMonomialMinusOne failed for k = " << k;
+
+        NativePoly res(a);
+        monomials.MultiplyByMonomial(res, k);
+        EXPECT_EQ(res, a * expected) << "MultiplyByMonomial failed for k = " << k;
+    }
+}
+
+TEST(UnitTestCirBTS, DecomposeSignedDigits) {
+    constexpr uint32_t N = 1024;
+    auto Q          = LastPrime<NativeInteger>(54, 2 * N);
+    auto polyParams = std::make_shared<ILNativeParams>(2 * N, Q);
+    int64_t Qint    = Q.ConvertToInt<int64_t>();
+
+    DiscreteUniformGeneratorImpl<NativeVector> dug;
+    NativePoly input(dug, polyParams, COEFFICIENT);
+    // (gBits, ignoreBits, digits): exact, approximate and first-digit-dropped decompositions
+    const std::vector<std::array<uint32_t, 3>> configs{{9, 0, 6}, {7, 12, 6}, {10, 10, 5}, {17, 20, 2}};
+    for (const auto& c : configs) {
+        uint32_t gBits = c[0], ignoreBits = c[1], digits = c[2];
+        std::vector<NativePoly> output(2 * digits, NativePoly(polyParams, EVALUATION, true));
+        DecomposeSignedDigits(input, Q, gBits, ignoreBits, digits, output, 1, 2);
+        for (uint32_t k = 0; k < N; ++k) {
+            int64_t x = input[k].ConvertToInt<int64_t>();
+            x         = x < Qint / 2 ? x : x - Qint;
+            __int128 sum{0};
+            for (uint32_t d = 0; d < digits; ++d) {
+                int64_t r = output[1 + 2 * d][k].ConvertToInt<int64_t>();
+                r         = r < Qint / 2 ? r : r - Qint;
+                ASSERT_LE(std::abs(r), int64_t(1) << (gBits - 1)) << "digit out of range";
+                sum += static_cast<__int128>(r) << (ignoreBits + d * gBits);
+            }
+            // x = sum + r_low + 2^{ignoreBits + digits * gBits} * top with |r_low| <= 2^{ignoreBits - 1}
+            __int128 topB = static_cast<__int128>(1) << (ignoreBits + digits * gBits);
+            __int128 low  = (static_cast<__int128>(1) << ignoreBits) / 2;
+            __int128 err  = ((static_cast<__int128>(x) - sum) % topB + topB) % topB;
+            ASSERT_TRUE(err <= low || err >= topB - low)
+                << "decomposition does not reconstruct coefficient " << k;
+        }
+        EXPECT_EQ(output[0].GetFormat(), EVALUATION) << "untouched output polynomial was modified";
+        EXPECT_EQ(output[1].GetFormat(), COEFFICIENT);
+
+        // the fused variant returns the same digits after the forward NTT
+        std::vector<NativePoly> outputNTT(digits, NativePoly(polyParams, COEFFICIENT, true));
+        DecomposeSignedDigits(input, Q, gBits, ignoreBits, digits, outputNTT, 0, 1, EVALUATION);
+        for (uint32_t d = 0; d < digits; ++d) {
+            output[1 + 2 * d].SetFormat(EVALUATION);
+            EXPECT_EQ(outputNTT[d], output[1 + 2 * d]) << "fused decomposition and NTT differ for digit " << d;
+        }
+    }
+}
+
+TEST(UnitTestCirBTS, ModulusBitLength) {
+    // the gadgets keep the top digits of any bit length of Q
+    auto params       = CirBTSContext::GetParamSet(STD128_CircuitBootstrap_CMUX_2);
+    params.numberBits  = 50;
+    auto [cc, sk, sk2] = GenerateCirBTSTestContext(params, GINX);
+    const auto& RGSWParams1 = cc.GetParams()->GetRingGSWParams1();
+    const auto& RLWEParams  = cc.GetParams()->GetRLWEParams();
+    ASSERT_EQ(RLWEParams->GetQ().GetMSB(), 50u);
+    EXPECT_EQ(RGSWParams1->GetIgnoreBitsGA(), 50u - 2 * 17);
+    EXPECT_EQ(RLWEParams->GetIgnoreBitsHT(), 50u - 3 * 13);
+    EXPECT_EQ(RLWEParams->GetIgnoreBitsSS(), 50u - 2 * 19);
+    EXPECT_EQ(RGSWParams1->GetAGPower()[0], NativeInteger(1) << (50 - 2 * 17));
+
+    for (LWEPlaintext bit : {0, 1})
+        CheckRGSW(cc, sk2, cc.CircuitBootstrapping(cc.Encrypt(sk, bit)), bit, "50-bit Q, bit " + std::to_string(bit));
+
+    // a gadget longer than Q is rejected
+    params.numberBits = 36;
+    EXPECT_THROW(CirBTSContext().GenerateCirBTSContext(params, GINX), config_error);
+}
+
+TEST(UnitTestCirBTS, WorkspaceReuse) {
+    // two gadgets of the external product, so the shape of the workspace alternates
+    auto params     = CirBTSContext::GetParamSet(STD128_CircuitBootstrap_CMUX_2);
+    params.BaseCC   = 1 << 6;
+    params.DigitsCC = 3;
+    std::vector<CirBTSTestContext> ctx{GenerateCirBTSTestContext(STD128_CircuitBootstrap_CMUX_2, GINX),
+                                       GenerateCirBTSTestContext(params, GINX)};
+
+    RLWEEncryptionScheme rlwe;
+    std::vector<RGSWCiphertext> sel;
+    std::vector<RLWECiphertext> ct;
+    std::vector<RLWECiphertext> expected;
+    for (auto& [c, sk, sk2] : ctx) {
+        auto& rlweParams = c.GetParams()->GetRLWEParams();
+        auto polyParams  = rlweParams->GetPolyParams();
+        BinaryUniformGeneratorImpl<NativeVector> bug;
+        NativePoly m(bug, polyParams, COEFFICIENT);
+        sel.push_back(c.CircuitBootstrapping(c.Encrypt(sk, 1)));
+        ct.push_back(rlwe.Encrypt(rlweParams, sk2, m, 2, polyParams->GetModulus()));
+        expected.push_back(ExternalProduct(c, sel.back(), ct.back()));
+    }
+
+    BlindRotationWorkspace ws;
+    CirBTSPerf::Enable(true);
+    for (uint32_t round = 0; round < 3; ++round) {
+        // the buffers of both shapes are allocated in the first round only
+        if (round == 1)
+            CirBTSPerf::Reset();
+        for (size_t i = 0; i < ctx.size(); ++i) {
+            auto res = std::make_shared<RLWECiphertextImpl>(*ct[i]);
+            ctx[i].cc.EvalExternalProductInPlace(sel[i], res, ws);
+            EXPECT_EQ(*res, *expected[i]) << "round " << round << ": external product with gadget " << i;
+        }
+    }
+    EXPECT_EQ(CirBTSPerf::Collect().numAllocations, 0u) << "the workspace reallocated when the gadget alternated";
+    CirBTSPerf::Enable(false);
+    CirBTSPerf::Reset();
+}
+
+TEST(UnitTestCirBTS, AutomorphismPlan) {
+    auto cc = CirBTSContext();
+    cc.GenerateCirBTSContext(STD128_CircuitBootstrap_AUTO, LMKCDEY);
+    auto polyParams = cc.GetParams()->GetRLWEParams()->GetPolyParams();
+    auto N          = polyParams->GetRingDimension();
+
+    DiscreteUniformGeneratorImpl<NativeVector> dug;
+    dug.SetModulus(polyParams->GetModulus());
+    std::mt19937 prng(7);
+    std::vector<uint32_t> indices{1, 3, 5, 2 * N - 1, N + 1, N - 1};
+    for (uint32_t i = 0; i < 4; ++i)
+        indices.push_back(2 * std::uniform_int_distribution<uint32_t>(0, N - 1)(prng) + 1);
+
+    for (auto k : indices) {
+        AutomorphismPlan plan(N, k);
+        NativePoly poly(dug, polyParams, EVALUATION);
+        auto expected = poly.AutomorphismTransform(k);
+        plan.Apply(poly);
+        EXPECT_EQ(poly, expected) << "automorphism " << k << " differs in the evaluation format";
+
+        // the permutation of the evaluations is X -> X^k on the coefficients
+        NativePoly coef(dug, polyParams, COEFFICIENT);
+        auto coefExpected = coef.AutomorphismTransform(k);
+        coef.SetFormat(EVALUATION);
+        plan.Apply(coef);
+        coef.SetFormat(COEFFICIENT);
+        EXPECT_EQ(coef, coefExpected) << "automorphism " << k << " differs in the coefficient format";
+    }
+
+    NativePoly coef(dug, polyParams, COEFFICIENT);
+    EXPECT_THROW(AutomorphismPlan(N, 5).Apply(coef), OpenFHEException);
+    EXPECT_THROW(AutomorphismPlan(N, 4), OpenFHEException);
+}
+
+TEST(UnitTestCirBTS, PerfCounters) {
+    auto [cc, sk, sk2] = GenerateCirBTSTestContext(STD128_CircuitBootstrap_CMUX_2, GINX);
+    std::vector<LWECiphertext> ct{cc.Encrypt(sk, 1), cc.Encrypt(sk, 0)};
+
+    cc.EnablePerfCounters();
+    cc.ResetPerfCounters();
+    auto ctGSW = cc.CircuitBootstrapBatch(ct);
+    auto rlwe  = std::make_shared<RLWECiphertextImpl>(ctGSW[0]->GetElements()[1]);
+    cc.EvalCMux(ctGSW[1], rlwe, rlwe);
+    auto stats = cc.GetPerfCounters();
+    auto json  = cc.GetPerfCountersJSON();
+    cc.EnablePerfCounters(false);
+
+    uint32_t numAuto = GetMSB(cc.GetParams()->GetRLWEParams()->GetN()) - 1;
+    // a batch records one sample per ciphertext
+    EXPECT_EQ(stats[STAGE_CIRCUIT_BOOTSTRAP].count, ct.size());
+    EXPECT_EQ(stats[STAGE_MODSWITCH].count, ct.size());
+    EXPECT_EQ(stats[STAGE_BLIND_ROTATION].count, ct.size());
+    EXPECT_EQ(stats[STAGE_BLIND_ROTATION].minNs, stats[STAGE_BLIND_ROTATION].maxNs);
+    EXPECT_EQ(stats[STAGE_HOMTRACE].count, 1u);
+    EXPECT_EQ(stats[STAGE_HOMTRACE_LEVEL].count, numAuto);
+    EXPECT_EQ(stats[STAGE_SCHEME_SWITCH].count, ct.size());
+    EXPECT_EQ(stats[STAGE_CMUX].count, 1u);
+    EXPECT_EQ(stats[STAGE_ROUND_TO_ODD].count, 0u) << "GINX has no round-to-odd correction";
+    for (uint32_t s = 0; s < NUM_CIRBTS_STAGES; ++s) {
+        const auto& st = stats.stages[s];
+        uint64_t samples{0};
+        for (auto h : st.histogram)
+            samples += h;
+        EXPECT_EQ(samples, st.count) << CirBTSPerf::GetStageName(static_cast<CIRBTS_STAGE>(s));
+        EXPECT_LE(st.minNs, st.maxNs);
+        EXPECT_LE(st.maxNs, st.totalNs);
+    }
+    // the stages nest
+    EXPECT_LE(stats[STAGE_BLIND_ROTATION].totalNs, stats[STAGE_CIRCUIT_BOOTSTRAP].totalNs);
+    EXPECT_GT(stats.numTransforms, 0u);
+    EXPECT_GT(stats.numAllocations, 0u);
+    EXPECT_NE(json.find("\"circuit_bootstrap\":{\"count\":2,"), std::string::npos) << json;
+
+    // nothing is recorded when the counters are off
+    cc.EvalCMux(ctGSW[1], rlwe, rlwe);
+    EXPECT_EQ(cc.GetPerfCounters()[STAGE_CMUX].count, 1u);
+    cc.ResetPerfCounters();
+    EXPECT_EQ(cc.GetPerfCounters()[STAGE_CMUX].count, 0u);
+    EXPECT_EQ(cc.GetPerfCounters().numTransforms, 0u);
+
+    // resets during the bootstrapping never leave counts that disagree with the histograms
+    cc.EnablePerfCounters();
+    std::atomic<bool> done{false};
+    std::thread resetter([&done]() {
+        while (!done.load()) {
+            CirBTSPerf::Reset();
+            std::this_thread::yield();
+        }
+    });
+    for (uint32_t i = 0; i < 3; ++i)
+        cc.CircuitBootstrapBatch(ct);
+    done.store(true);
+    resetter.join();
+    cc.CircuitBootstrapBatch(ct);
+    stats = cc.GetPerfCounters();
+    cc.EnablePerfCounters(false);
+    for (uint32_t s = 0; s < NUM_CIRBTS_STAGES; ++s) {
+        const auto& st = stats.stages[s];
+        uint64_t samples{0};
+        for (auto h : st.histogram)
+            samples += h;
+        EXPECT_EQ(samples, st.count) << "after concurrent resets: " << CirBTSPerf::GetStageName(static_cast<CIRBTS_STAGE>(s));
+        EXPECT_LE(st.minNs, st.maxNs);
+    }
+    EXPECT_GE(stats[STAGE_CIRCUIT_BOOTSTRAP].count, ct.size());
+    cc.ResetPerfCounters();
+}
+
+TEST(UnitTestCirBTS, NoiseMeasurement) {
+    for (auto method : {GINX, LMKCDEY}) {
+        auto [cc, sk, sk2] = GenerateCirBTSTestContext(method == GINX ? STD128_CircuitBootstrap_CMUX_2 : STD128_CircuitBootstrap_AUTO, method);
+
+        const uint32_t numRuns = 4;
+        auto stats             = cc.MeasureNoise(sk, sk2, numRuns);
+        auto json              = stats.ToJSON();
+        auto N                 = cc.GetParams()->GetRLWEParams()->GetN();
+        uint32_t numLUT        = cc.GetParams()->GetDigitsCC();
+        EXPECT_EQ(stats.numRuns, numRuns);
+        EXPECT_EQ(stats.mvfbs.count, numRuns * N);
+        EXPECT_EQ(stats.homtrace.count, numRuns * numLUT * N);
+        EXPECT_EQ(stats.schemeSwitch.count, numRuns * numLUT * N);
+        EXPECT_EQ(stats.externalProduct.count, numRuns * N);
+        ASSERT_EQ(stats.homtraceLevels.size(), GetMSB(N) - 1);
+
+        // a wrong reference would leave errors spread over Z_Q, with log2(Q) - 1.8 bits of deviation
+        double bound = stats.logQ - 8;
+        EXPECT_LT(stats.mvfbs.GetStdDevBits(), bound) << json;
+        for (const auto& level : stats.homtraceLevels)
+            EXPECT_LT(level.GetStdDevBits(), bound) << json;
+        EXPECT_LT(stats.homtrace.GetStdDevBits(), bound) << json;
+        EXPECT_LT(stats.schemeSwitch.GetStdDevBits(), bound) << json;
+        EXPECT_LT(stats.externalProduct.GetStdDevBits(), bound) << json;
+        // the products decrypt correctly
+        EXPECT_LT(stats.externalProduct.maxAbs, std::ldexp(1.0, stats.logQ - 3)) << json;
+        EXPECT_NE(json.find("\"runs\":4,"), std::string::npos) << json;
+
+        auto empty = cc.MeasureNoise(sk, sk2, 0);
+        EXPECT_EQ(empty.numRuns, 0u);
+        EXPECT_EQ(empty.mvfbs.count, 0u);
+    }
+}
+
+TEST(UnitTestCirBTS, ParamsTuner) {
+    // the error model of parameters_gen.py reproduces the bases of STD128_CircuitBootstrap_CMUX_2
+    auto base = CirBTSContext::GetParamSet(STD128_CircuitBootstrap_CMUX_2);
+    CirBTSErrorModel model(base, GINX);
+    double sigmaIn2 = model.GetSigmaIn2(-32);
+    EXPECT_NEAR(model.GetLog2FailureRate(sigmaIn2), -32, 1e-6);
+    EXPECT_EQ(model.OptimizeBaseBR(2), 17u);
+    EXPECT_EQ(model.OptimizeBaseTrace(3), 13u);
+    EXPECT_EQ(model.OptimizeBaseSS(2), 19u);
+    auto estimate = model.Evaluate(base, sigmaIn2);
+    EXPECT_EQ(model.OptimizeBaseNoise(estimate.errSS, 4), 4u);
+    EXPECT_NEAR(std::log2(estimate.noise), 87.602, 1e-3);
+    EXPECT_NEAR(estimate.maxDepth, 2118.27, 0.1);
+
+    CirBTSTunerOptions options;
+    options.targetDepth   = 2000;
+    options.numCandidates = 2;
+    options.numSamples    = 1;
+    CirBTSParamsTuner tuner(GINX, options);
+    auto candidates = tuner.GetCandidates();
+    ASSERT_FALSE(candidates.empty());
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        EXPECT_GE(candidates[i].estimate.maxDepth, options.targetDepth);
+        if (i > 0)
+            EXPECT_LE(candidates[i - 1].estimate.numNTTs, candidates[i].estimate.numNTTs);
+    }
+
+    // the tuned parameters go through the custom entry point
+    auto tuned = tuner.Tune();
+    EXPECT_GT(tuned.latencyMs, 0.0);
+    auto [cc, sk, sk2] = GenerateCirBTSTestContext(tuned.params, GINX);
+    for (LWEPlaintext bit : {0, 1})
+        CheckRGSW(cc, sk2, cc.CircuitBootstrapping(cc.Encrypt(sk, bit)), bit, "tuned parameters failed for bit " + std::to_string(bit));
+
+    options.targetDepth = 1e30;
+    EXPECT_THROW(CirBTSParamsTuner(GINX, options).Tune(), config_error);
+    base.BaseCC = 12;
+    EXPECT_THROW(cc.GenerateCirBTSContext(base, GINX), config_error);
+    base.BaseCC   = 1 << 16;
+    base.DigitsCC = 4;
+    EXPECT_THROW(cc.GenerateCirBTSContext(base, GINX), config_error);
+}
+
+TEST(UnitTestCirBTS, Tracing) {
+    auto ctx = GenerateCirBTSTestContext(STD128_CircuitBootstrap_CMUX_2, GINX);
+    auto& cc = ctx.cc;
+    std::vector<LWECiphertext> ct{cc.Encrypt(ctx.sk, 1), cc.Encrypt(ctx.sk, 0)};
+
+    auto countSpans = [&cc](const std::string& name) {
+        std::stringstream ss;
+        cc.WriteTrace(ss);
+        auto trace = ss.str();
+        EXPECT_EQ(trace.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u);
+        size_t count{0};
+        for (auto pos = trace.find("{\"name\":\"" + name + "\""); pos != std::string::npos;
+             pos       = trace.find("{\"name\":\"" + name + "\"", pos + 1))
+            ++count;
+        return count;
+    };
+
+    cc.EnableTracing();
+    EXPECT_EQ(countSpans("circuit_bootstrap"), 0u);
+    auto ctGSW = cc.CircuitBootstrapBatch(ct);
+    cc.EnableTracing(false);
+
+    uint32_t numAuto = GetMSB(cc.GetParams()->GetRLWEParams()->GetN()) - 1;
+    uint32_t numLUT  = cc.GetParams()->GetDigitsCC();
+    EXPECT_EQ(countSpans("circuit_bootstrap"), 1u);
+    EXPECT_EQ(countSpans("modswitch"), ct.size());
+    EXPECT_EQ(countSpans("scheme_switch"), ct.size());
+    EXPECT_EQ(countSpans("EvalSS"), ct.size() * numLUT);
+    EXPECT_EQ(countSpans("HomTrace.Automorphism"), ct.size() * numLUT * numAuto);
+    EXPECT_GT(countSpans("AddToAccCGGI"), 0u);
+
+    // the spans stop with the tracing and are kept until the next session
+    cc.CircuitBootstrapping(ct[0]);
+    EXPECT_EQ(countSpans("circuit_bootstrap"), 1u);
+    cc.EnableTracing();
+    EXPECT_EQ(countSpans("circuit_bootstrap"), 0u);
+    cc.EnableTracing(false);
+}
+
+TEST(UnitTestCirBTS, CircuitManyGates) {
+    auto [cc, sk, sk2] = GenerateCirBTSTestContext(STD128_CircuitBootstrap_CMUX_2, GINX);
+    auto& rlweParams = cc.GetParams()->GetRLWEParams();
+    auto polyParams  = rlweParams->GetPolyParams();
+
+    // one wire selects between two inputs in many independent gates, which run concurrently
+    const uint32_t numGates{16};
+    CirBTSCircuit circuit;
+    auto a  = circuit.AddLWEInput();
+    auto r0 = circuit.AddRLWEInput();
+    auto r1 = circuit.AddRLWEInput();
+    for (uint32_t i = 0; i < numGates; ++i)
+        circuit.MarkOutput(i % 2 ? circuit.AddCMux(a, r0, r1) : circuit.AddCMux(a, r1, r0));
+
+    RLWEEncryptionScheme rlwe;
+    BinaryUniformGeneratorImpl<NativeVector> bug;
+    NativePoly m0(bug, polyParams, COEFFICIENT);
+    NativePoly m1(bug, polyParams, COEFFICIENT);
+    std::vector<RLWECiphertext> cts{rlwe.Encrypt(rlweParams, sk2, m0, 2, polyParams->GetModulus()),
+                                    rlwe.Encrypt(rlweParams, sk2, m1, 2, polyParams->GetModulus())};
+    cc.EnableTracing();
+    auto res = circuit.Evaluate(cc, {cc.Encrypt(sk, 1)}, cts);
+    cc.EnableTracing(false);
+    ASSERT_EQ(res.size(), numGates);
+    NativePoly result(polyParams, COEFFICIENT, true);
+    for (uint32_t i = 0; i < numGates; ++i) {
+        rlwe.Decrypt(rlweParams, sk2, res[i], &result, 2);
+        EXPECT_EQ(result, i % 2 ? m1 : m0) << "output " << i;
+    }
+
+    // the gates are spread over the threads, not limited by the single wire
+    std::stringstream ss;
+    cc.WriteTrace(ss);
+    auto trace = ss.str();
+    std::set<std::string> tids;
+    const std::string span{"{\"name\":\"cmux\""};
+    for (auto pos = trace.find(span); pos != std::string::npos; pos = trace.find(span, pos + 1)) {
+        auto tid = trace.find("\"tid\":", pos) + 6;
+        tids.insert(trace.substr(tid, trace.find('}', tid) - tid));
+    }
+    if (OpenFHEParallelControls.GetThreadLimit(2) > 1)
+        EXPECT_GT(tids.size(), 1u) << "the gates of a circuit with one wire ran on one thread";
+}
+
+TEST(UnitTestCirBTS, AutomorphismAccumulator) {
+    auto [cc, sk, sk2] = GenerateCirBTSTestContext(STD128_CircuitBootstrap_AUTO, LMKCDEY);
+    const auto& RGSWParams1 = cc.GetParams()->GetRingGSWParams1();
+    auto& rlweParams        = cc.GetParams()->GetRLWEParams();
+    auto polyParams         = rlweParams->GetPolyParams();
+    uint32_t n              = cc.GetParams()->GetLWEParams()->Getn();
+
+    // an accumulator with a nonzero first component is key switched from the first automorphism:
+    // it gives the same plaintext as the trivial accumulator of its phase
+    RLWEEncryptionScheme rlwe;
+    BinaryUniformGeneratorImpl<NativeVector> bug;
+    NativePoly m(bug, polyParams, COEFFICIENT);
+    auto acc = rlwe.Encrypt(rlweParams, sk2, m, 2, polyParams->GetModulus());
+    std::vector<NativePoly> phase{NativePoly(polyParams, EVALUATION, true),
+                                  acc->GetElements()[1] - acc->GetElements()[0] * sk2->GetElement()};
+    auto trivial = std::make_shared<RLWECiphertextImpl>(phase);
+
+    DiscreteUniformGeneratorImpl<NativeVector> dug;
+    dug.SetModulus(RGSWParams1->Getq());
+    auto a = dug.GenerateVector(n);
+    RingGSWAccumulatorLMKCDEY accScheme;
+    accScheme.EvalAcc(RGSWParams1, cc.GetRefreshKey(), acc, a);
+    accScheme.EvalAcc(RGSWParams1, cc.GetRefreshKey(), trivial, a);
+
+    NativePoly result(polyParams, COEFFICIENT, true);
+    NativePoly expected(polyParams, COEFFICIENT, true);
+    rlwe.Decrypt(rlweParams, sk2, acc, &result, 2);
+    rlwe.Decrypt(rlweParams, sk2, trivial, &expected, 2);
+    EXPECT_EQ(result, expected) << "the accumulator with a nonzero first component was not key switched";
+}
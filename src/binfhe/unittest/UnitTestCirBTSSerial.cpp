@@ -0,0 +1,104 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/*
+  This code runs unit tests for the serialization of the circuit bootstrapping methods of the OpenFHE lattice encryption library
+ */
+
+#include "gtest/gtest.h"
+
+// these header files are needed for serialization
+#include "cirbtscontext-ser.h"
+#include "UnitTestCirBTSUtils.h"
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+using namespace lbcrypto;
+
+template <typename ST>
+void UnitTestCirBTSSerial(const ST& sertype, CirBTS_PARAMSET set, BINFHE_METHOD method, const std::string& errMsg) {
+    auto [cc1, sk, sk2] = GenerateCirBTSTestContext(set, method);
+
+    CirBTSContext cc2;
+    {
+        std::stringstream s;
+        Serial::Serialize(cc1, s, sertype);
+        Serial::Deserialize(cc2, s, sertype);
+
+        EXPECT_EQ(*cc2.GetParams()->GetRingGSWParams1(), *cc1.GetParams()->GetRingGSWParams1())
+            << errMsg << " Context mismatch";
+    }
+
+    RingGSWCirBTKey key;
+    {
+        std::stringstream s;
+        Serial::Serialize(cc1.GetCirBTSKey(), s, sertype);
+        Serial::Deserialize(key, s, sertype);
+    }
+    cc2.BTKeyLoad(key);
+
+    EXPECT_EQ(*cc2.GetRefreshKey(), *cc1.GetRefreshKey()) << errMsg << " Circuit bootstrapping key mismatch: refresh key";
+    EXPECT_EQ(*cc2.GetHomTraceKey(), *cc1.GetHomTraceKey()) << errMsg << " Circuit bootstrapping key mismatch: homtrace key";
+    EXPECT_EQ(*cc2.GetSchemeSwitchingKey(), *cc1.GetSchemeSwitchingKey())
+        << errMsg << " Circuit bootstrapping key mismatch: scheme switching key";
+
+    // the lookup table of the MV-FBS is recomputed on load
+    EXPECT_EQ(cc2.GetParams()->GetLUT(), cc1.GetParams()->GetLUT()) << errMsg << " LUT mismatch";
+
+    // the deserialized keys bootstrap the ciphertexts of the original context
+    for (LWEPlaintext bit : {0, 1})
+        CheckRGSW(cc2, sk2, cc2.CircuitBootstrapping(cc1.Encrypt(sk, bit)), bit,
+                  errMsg + " Circuit bootstrapping with the deserialized keys failed for bit " + std::to_string(bit));
+
+    // the raw key format is loaded into the deserialized context
+    std::string filename = TempFileName("cirbts-key-" + std::to_string(method) + ".bin");
+    ASSERT_TRUE(cc1.SerializeBTKeyToFile(filename)) << errMsg << " could not write " << filename;
+    cc2.ClearBTKeys();
+    ASSERT_TRUE(cc2.DeserializeBTKeyFromFile(filename)) << errMsg << " could not read " << filename;
+    std::remove(filename.c_str());
+    EXPECT_EQ(*cc2.GetRefreshKey(), *cc1.GetRefreshKey()) << errMsg << " Raw key mismatch: refresh key";
+
+    auto ctGSW = cc2.CircuitBootstrapBatch({cc2.Encrypt(sk, 1), cc2.Encrypt(sk, 0)});
+    EXPECT_EQ(ctGSW.size(), 2u) << errMsg;
+}
+
+// ---------------  TESTING SERIALIZATION METHODS OF CIRCUIT BOOTSTRAPPING ---------------
+TEST(UnitTestCirBTSSerialGINX, BINARY) {
+    std::string msg = "UnitTestCirBTSSerialGINX.BINARY serialization test failed: ";
+    UnitTestCirBTSSerial(SerType::BINARY, STD128_CircuitBootstrap_CMUX_2, GINX, msg);
+}
+
+TEST(UnitTestCirBTSSerialLMKCDEY, BINARY) {
+    std::string msg = "UnitTestCirBTSSerialLMKCDEY.BINARY serialization test failed: ";
+    UnitTestCirBTSSerial(SerType::BINARY, STD128_CircuitBootstrap_AUTO, LMKCDEY, msg);
+}
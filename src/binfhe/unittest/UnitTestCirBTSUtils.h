@@ -0,0 +1,115 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+  Helper functions for the circuit bootstrapping unittests
+ */
+
+#ifndef _UNIT_TEST_CIRBTS_UTILS_H_
+#define _UNIT_TEST_CIRBTS_UTILS_H_
+
+#include "cirbtscontext.h"
+#include "rlwe-ske.h"
+
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace lbcrypto {
+
+// a path in the temporary directory for the key files written by the tests
+inline std::string TempFileName(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// a context with its secret keys and its circuit bootstrapping keys
+struct CirBTSTestContext {
+    CirBTSContext cc;
+    LWEPrivateKey sk;
+    RLWEPrivateKey sk2;
+};
+
+// generates a context from a parameter set or from custom parameters, its secret keys and its keys
+template <typename ParamsType>
+inline CirBTSTestContext GenerateCirBTSTestContext(const ParamsType& params, BINFHE_METHOD method = GINX,
+                                                   EXTPROD_BACKEND backend = NTT_BACKEND) {
+    CirBTSTestContext ctx;
+    ctx.cc.GenerateCirBTSContext(params, method, backend);
+    ctx.sk  = ctx.cc.KeyGen();
+    ctx.sk2 = ctx.cc.RLWEKeyGen();
+    ctx.cc.CirBTKeyGen(ctx.sk, ctx.sk2);
+    return ctx;
+}
+
+// RGSW x RLWE external product; returns an RLWE encryption of the product of both plaintexts
+inline RLWECiphertext ExternalProduct(CirBTSContext& cc, ConstRGSWCiphertext& ctGSW, ConstRLWECiphertext& ct) {
+    auto& rlweParams = cc.GetParams()->GetRLWEParams();
+    auto polyParams  = rlweParams->GetPolyParams();
+    auto baseCC      = cc.GetParams()->GetRingGSWParams2()->GetBaseG();
+    auto digitsCC    = cc.GetParams()->GetDigitsCC();
+
+    auto ctCoef = std::make_shared<RLWECiphertextImpl>(*ct);
+    ctCoef->SetFormat(COEFFICIENT);
+    std::vector<NativePoly> dct(2 * digitsCC, NativePoly(polyParams, COEFFICIENT, true));
+    RLWEEncryptionScheme().SignedDigitDecompose(rlweParams, ctCoef, baseCC, digitsCC, dct);
+
+    std::vector<NativePoly> res(2, NativePoly(polyParams, EVALUATION, true));
+    for (uint32_t i = 0; i < 2 * digitsCC; ++i) {
+        dct[i].SetFormat(EVALUATION);
+        res[0] += dct[i] * ctGSW->GetElements()[i][0];
+        res[1] += dct[i] * ctGSW->GetElements()[i][1];
+    }
+    return std::make_shared<RLWECiphertextImpl>(res);
+}
+
+// checks that ctGSW encrypts bit by multiplying it with an RLWE encryption of a random binary polynomial
+inline void CheckRGSW(CirBTSContext& cc, ConstRLWEPrivateKey& sk2, ConstRGSWCiphertext& ctGSW, LWEPlaintext bit,
+                      const std::string& errMsg) {
+    auto& rlweParams = cc.GetParams()->GetRLWEParams();
+    auto polyParams  = rlweParams->GetPolyParams();
+    auto N           = polyParams->GetRingDimension();
+
+    RLWEEncryptionScheme rlwe;
+    BinaryUniformGeneratorImpl<NativeVector> bug;
+    NativePoly m(bug, polyParams, COEFFICIENT);
+    auto ct = rlwe.Encrypt(rlweParams, sk2, m, 2, polyParams->GetModulus());
+
+    NativePoly result(polyParams, COEFFICIENT, true);
+    rlwe.Decrypt(rlweParams, sk2, ExternalProduct(cc, ctGSW, ct), &result, 2);
+    for (uint32_t i = 0; i < N; ++i)
+        ASSERT_EQ(result[i].ConvertToInt(), bit * m[i].ConvertToInt()) << errMsg << " coefficient " << i;
+}
+
+}  // namespace lbcrypto
+
+#endif
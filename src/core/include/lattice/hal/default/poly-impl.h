@@ -408,6 +408,7 @@ void PolyImpl<VecType>::SwitchModulus(const Integer& modulus, const Integer& roo
 
 template <typename VecType>
 void PolyImpl<VecType>::SwitchFormat() {
+    TransformCounter::Count();
     const auto& co{m_params->GetCyclotomicOrder()};
     const auto& rd{m_params->GetRingDimension()};
     const auto& ru{m_params->GetRootOfUnity()};
@@ -177,6 +177,17 @@ public:
         return *m_prng;
     }
 
+    /**
+   * @brief Replaces the PRNG engine of the calling thread, e.g., by an engine with a known seed
+   * to draw reproducible samples, and returns the previous engine so that it can be restored.
+   * Not thread-safe with FIXED_SEED, where all threads share one engine
+   */
+    static std::shared_ptr<PRNG> ExchangePRNG(std::shared_ptr<PRNG> prng) {
+        GetPRNG();
+        m_prng.swap(prng);
+        return prng;
+    }
+
 private:
     // shared pointer to a thread-specific PRNG engine
     static std::shared_ptr<PRNG> m_prng;
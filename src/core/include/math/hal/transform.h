@@ -38,6 +38,7 @@
 
 #include "utils/inttypes.h"
 
+#include <atomic>
 #include <complex>
 #include <map>
 #include <utility>
@@ -53,6 +54,39 @@
  */
 namespace lbcrypto {
 
+/**
+ * @brief Process-wide count of the polynomial format switches (one NTT or inverse NTT each) for
+ * performance instrumentation. Counting is off by default; when on, every switch costs one
+ * relaxed atomic increment
+ */
+class TransformCounter {
+public:
+    static void Enable(bool enable) {
+        s_enabled.store(enable, std::memory_order_relaxed);
+    }
+
+    static bool IsEnabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    static void Count() {
+        if (s_enabled.load(std::memory_order_relaxed))
+            s_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static uint64_t Get() {
+        return s_count.load(std::memory_order_relaxed);
+    }
+
+    static void Reset() {
+        s_count.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    inline static std::atomic<bool> s_enabled{false};
+    inline static std::atomic<uint64_t> s_count{0};
+};
+
 /**
  * @brief Golden Chinese Remainder Transform FFT implementation.
  */
@@ -108,10 +108,12 @@ public:
 #endif
     }
 
-    // @Brief returns min of int n and machineThreads
+    // @Brief returns min of int n and the number of threads set by SetNumThreads (at most machineThreads)
     int GetThreadLimit(int n) const {
 #ifdef PARALLEL
-        return n > machineThreads ? machineThreads : n;
+        int limit = omp_get_max_threads();
+        limit     = limit > machineThreads ? machineThreads : limit;
+        return n > limit ? limit : n;
 #else
         return 1;
 #endif